@@ -0,0 +1,205 @@
+// Micro-benchmark of the framebuffer primitives in src/epaper/epaper.c.
+// Every primitive is timed for each scale (1-5) and orientation with the
+// host wall clock; the SPI/panel side is not involved (see epaper_emu for that).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "epaper.h"
+#include "dither.h"
+#include "esp_log.h"
+#include "sim.h"
+
+#define BENCH_TEXT       "EPaper42"
+#define BENCH_GLYPHS     8
+#define BENCH_RECT_SIDE  24  // Times the scale, also the circle diameter and line run
+
+typedef enum { OUT_TABLE, OUT_CSV, OUT_JSON } output_t;
+
+typedef enum { PRIM_RECT, PRIM_TEXT, PRIM_LINE, PRIM_CIRCLE, PRIM_DITHER } prim_kind_t;
+
+typedef struct {
+    const char *name;
+    prim_kind_t kind;
+    const font_t *font;      // Text only
+} primitive_t;
+
+typedef struct {
+    const primitive_t *prim;
+    uint8_t scale;
+} bench_arg_t;
+
+static const primitive_t primitives[] = {
+    { "rect",      PRIM_RECT,   NULL },
+    { "text_5x8",  PRIM_TEXT,   &font_5x8 },
+    { "text_6x12", PRIM_TEXT,   &font_6x12 },
+    { "text_8x16", PRIM_TEXT,   &font_8x16 },
+    { "line",      PRIM_LINE,   NULL },  // Diagonal, thickness = scale
+    { "circle",    PRIM_CIRCLE, NULL },  // Filled
+    { "dither_fs", PRIM_DITHER, NULL },  // Gray ramp, Floyd-Steinberg
+};
+
+static const char *orientation_names[] = {
+    "ORIENTATION_0", "ORIENTATION_90", "ORIENTATION_180", "ORIENTATION_270"
+};
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Gray ramp along the rows, fed a row at a time
+static void dither_square(uint16_t side) {
+    uint8_t row[DITHER_MAX_WIDTH];
+    dither_t d = { .w = side, .h = side, .format = DITHER_GRAY8, .method = DITHER_FLOYD_STEINBERG,
+                   .threshold = 128 };
+    if (dither_begin(&d) != ESP_OK) {
+        return;
+    }
+    for (uint16_t y = 0; y < side; y++) {
+        memset(row, y * 255 / side, side);
+        dither_write(&d, row, side);
+    }
+    dither_end(&d);
+}
+
+// Alternate colors so every call really writes the framebuffer
+static void run_once(const bench_arg_t *arg, uint32_t i) {
+    uint8_t color = (i & 1) ? COLOR_BLACK : COLOR_RED;
+    uint16_t side = BENCH_RECT_SIDE * arg->scale;
+    switch (arg->prim->kind) {
+        case PRIM_RECT:
+            epaper_rect(0, 0, side, side, color);
+            break;
+        case PRIM_TEXT:
+            epaper_draw_text_font(0, 0, BENCH_TEXT, arg->prim->font, color, arg->scale);
+            break;
+        case PRIM_LINE:
+            epaper_line(0, 0, side, side / 2, arg->scale, color);
+            break;
+        case PRIM_CIRCLE:
+            epaper_circle(side / 2, side / 2, side / 2, 0, color);
+            break;
+        case PRIM_DITHER:
+            dither_square(side);
+            break;
+    }
+}
+
+// Pixels a call covers (glyph cells for text, bounding box for circles and
+// run times thickness for lines, clipping included)
+static uint64_t pixels_per_call(const bench_arg_t *arg) {
+    uint64_t s = arg->scale;
+    const font_t *font = arg->prim->font;
+    switch (arg->prim->kind) {
+        case PRIM_TEXT:
+            return (uint64_t)font->width * s * font->height * s * BENCH_GLYPHS;
+        case PRIM_LINE:
+            return (uint64_t)BENCH_RECT_SIDE * s * s;
+        case PRIM_CIRCLE:
+            return (uint64_t)(BENCH_RECT_SIDE * s + 1) * (BENCH_RECT_SIDE * s + 1);
+        default:
+            return (uint64_t)BENCH_RECT_SIDE * s * BENCH_RECT_SIDE * s;
+    }
+}
+
+// Repeat until min_ms of wall time has passed, return ns per call
+static double measure(const bench_arg_t *arg, uint32_t min_ms, uint32_t *calls) {
+    uint64_t budget = (uint64_t)min_ms * 1000000u;
+    uint32_t n = 1;
+
+    run_once(arg, 0); // Warm up
+    while (1) {
+        uint64_t start = wall_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            run_once(arg, i);
+        }
+        uint64_t elapsed = wall_ns() - start;
+        if (elapsed >= budget || n >= (1u << 30)) {
+            *calls = n;
+            return (double)elapsed / n;
+        }
+        n = (elapsed < budget / 16) ? n * 16 : n * 2;
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-f table|csv|json] [-t min_ms] [-p primitive] [-n 0|1]\n"
+            "  -f  output format (default table)\n"
+            "  -t  minimum measuring time per case (default 50 ms)\n"
+            "  -n  framebuffer in the 90/270 orientation (1, default) or always in panel order (0)\n"
+            "  -p  only run one primitive (rect, text_5x8, text_6x12, text_8x16, line, circle, dither_fs)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    output_t out = OUT_TABLE;
+    uint32_t min_ms = 50;
+    const char *only = NULL;
+    uint8_t native = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:t:p:n:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                out = strcmp(optarg, "json") == 0 ? OUT_JSON : strcmp(optarg, "csv") == 0 ? OUT_CSV : OUT_TABLE;
+                break;
+            case 't': min_ms = (uint32_t)atoi(optarg); break;
+            case 'p': only = optarg; break;
+            case 'n': native = (uint8_t)atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    sim_init();
+    sim_log_level = ESP_LOG_NONE;
+    epaper_set_native_orientation(native);
+    epaper_display_clear(); // Allocates the framebuffers
+
+    if (out == OUT_TABLE) {
+        printf("%-10s %-16s %5s %12s %14s %14s\n", "primitive", "orientation", "scale", "ns/call", "Mpixels/s", "glyphs/s");
+    } else if (out == OUT_CSV) {
+        printf("primitive,orientation,scale,calls,ns_per_call,pixels_per_s,glyphs_per_s\n");
+    } else {
+        printf("[\n");
+    }
+
+    bool first = true;
+    for (size_t p = 0; p < sizeof(primitives) / sizeof(primitives[0]); p++) {
+        if (only != NULL && strcmp(only, primitives[p].name) != 0) {
+            continue;
+        }
+        for (uint8_t o = ORIENTATION_0; o <= ORIENTATION_270; o++) {
+            epaper_set_orientation(o);
+            for (uint8_t scale = 1; scale <= 5; scale++) {
+                bench_arg_t arg = { &primitives[p], scale };
+                uint32_t calls;
+                double ns = measure(&arg, min_ms, &calls);
+                double pixels_s = pixels_per_call(&arg) * 1e9 / ns;
+                double glyphs_s = primitives[p].font != NULL ? BENCH_GLYPHS * 1e9 / ns : 0;
+
+                if (out == OUT_TABLE) {
+                    printf("%-10s %-16s %5u %12.1f %14.2f %14.0f\n", primitives[p].name,
+                           orientation_names[o], scale, ns, pixels_s / 1e6, glyphs_s);
+                } else if (out == OUT_CSV) {
+                    printf("%s,%s,%u,%u,%.1f,%.0f,%.0f\n", primitives[p].name, orientation_names[o],
+                           scale, calls, ns, pixels_s, glyphs_s);
+                } else {
+                    printf("%s  {\"primitive\": \"%s\", \"orientation\": \"%s\", \"scale\": %u, \"calls\": %u, "
+                           "\"ns_per_call\": %.1f, \"pixels_per_s\": %.0f, \"glyphs_per_s\": %.0f}",
+                           first ? "" : ",\n", primitives[p].name, orientation_names[o], scale, calls,
+                           ns, pixels_s, glyphs_s);
+                }
+                first = false;
+            }
+        }
+    }
+    if (out == OUT_JSON) {
+        printf("\n]\n");
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Decodes a display list (src/display/display_list.h), e.g. one saved from
+// GET /api/dlist, and prints its records. With -o it is also replayed through
+// the real driver onto the emulated panel and the result written as an image.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "epaper.h"
+#include "esp_log.h"
+#include "image.h"
+#include "sim.h"
+#include "display/display_list.h"
+
+static const char *const op_names[] = {
+    "text", "rect", "text_box", "line", "round_rect", "circle", "arc", "polygon", "widgets",
+};
+
+static void print_item(const display_list_item_t *item) {
+    const display_op_t *op = &item->op;
+    if (item->opcode == DISPLAY_LIST_JOB) {
+        printf("job clear=%d refresh=%d orientation=%d layer=%d\n", item->job.clear, item->job.refresh,
+               item->job.orientation, item->job.layer);
+        return;
+    }
+    printf("  %-10s color=%d", op_names[op->type], op->color);
+    switch (op->type) {
+        case DISPLAY_OP_TEXT:
+            printf(" (%d,%d) font=%s scale=%d \"%s\"", op->x, op->y, op->font->name, op->scale, op->text);
+            break;
+        case DISPLAY_OP_TEXT_BOX:
+            printf(" (%d,%d) %dx%d font=%s scale=%d align=%d/%d wrap=%d fit=%d \"%s\"", op->box.x, op->box.y,
+                   op->box.w, op->box.h, op->font->name, op->box.scale, op->box.align, op->box.valign,
+                   op->box.wrap, op->box.fit, op->text);
+            break;
+        case DISPLAY_OP_RECT:
+            printf(" (%d,%d) %dx%d", op->x, op->y, op->w, op->h);
+            break;
+        case DISPLAY_OP_LINE:
+            printf(" (%d,%d)-(%d,%d) thickness=%d", op->x, op->y, op->x1, op->y1, op->thickness);
+            break;
+        case DISPLAY_OP_ROUND_RECT:
+            printf(" (%d,%d) %dx%d r=%d thickness=%d", op->x, op->y, op->w, op->h, op->r, op->thickness);
+            break;
+        case DISPLAY_OP_CIRCLE:
+            printf(" (%d,%d) r=%d thickness=%d", op->x, op->y, op->r, op->thickness);
+            break;
+        case DISPLAY_OP_ARC:
+            printf(" (%d,%d) r=%d %d-%d deg thickness=%d", op->x, op->y, op->r, op->start, op->end, op->thickness);
+            break;
+        case DISPLAY_OP_POLYGON:
+            for (uint16_t i = 0; i < op->point_count; i++) {
+                printf(" (%d,%d)", op->points[2 * i], op->points[2 * i + 1]);
+            }
+            break;
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    const char *image = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:h")) != -1) {
+        switch (opt) {
+            case 'o': image = optarg; break;
+            default:
+                fprintf(stderr, "usage: %s [-o image.png|image.pbm] list.epdl\n", argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-o image.png|image.pbm] list.epdl\n", argv[0]);
+        return 2;
+    }
+
+    FILE *f = fopen(argv[optind], "rb");
+    if (f == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    static uint8_t data[1 << 20];
+    size_t len = fread(data, 1, sizeof(data), f);
+    fclose(f);
+
+    display_list_reader_t reader;
+    display_list_item_t item;
+    if (!display_list_open(&reader, data, len)) {
+        fprintf(stderr, "%s: not a version %d display list\n", argv[optind], DISPLAY_LIST_VERSION);
+        return 1;
+    }
+    printf("%u bytes, hash %08x\n", (unsigned)len, (unsigned)display_list_hash(data, len));
+    int ret;
+    while ((ret = display_list_next(&reader, &item)) > 0) {
+        print_item(&item);
+    }
+    if (ret < 0) {
+        fprintf(stderr, "corrupt record at byte %u\n", (unsigned)(reader.pos - data));
+        return 1;
+    }
+
+    if (image != NULL) {
+        sim_init();
+        epaper_init();
+        epaper_set_bw_mode(0);
+        display_list_draw(data, len);
+        epaper_display_update();
+        if (!image_write(sim_controller(), image)) {
+            fprintf(stderr, "Failed to write %s\n", image);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+// Runs the real src/epaper driver against the UC81xx emulator and reports,
+// per step, what the panel would have cost: SPI traffic, BUSY time, refreshes.
+// The steps follow what the firmware does at boot and for each API request
+// (drawing, then epaper_display_refresh_begin() + epaper_display_flush()).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "epaper.h"
+#include "esp_log.h"
+#include "image.h"
+#include "sim.h"
+#include "text_layout.h"
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} step_t;
+
+// Same as the display task does after rendering a job
+static void refresh(void) {
+    if (epaper_display_refresh_begin()) {
+        epaper_display_flush();
+    }
+}
+
+static void step_init(void) {
+    epaper_init();
+    epaper_set_bw_mode(0);
+}
+
+static void step_boot_screen(void) {
+    // Welcome screen from app_main()
+    epaper_display_clear();
+    epaper_draw_text(10, 10, "E-Paper API", COLOR_BLACK, 2);
+    epaper_draw_text(10, 35, "Ready!", COLOR_RED, 2);
+    epaper_draw_text(10, 60, "IP:", COLOR_BLACK, 1);
+    epaper_draw_text(30, 60, "192.168.1.42", COLOR_BLACK, 1);
+    epaper_draw_text(10, 75, "Port: 80", COLOR_BLACK, 1);
+    epaper_display_update();
+}
+
+static void step_text(void) {
+    epaper_display_clear();
+    epaper_draw_text(10, 10, "Hello World", COLOR_BLACK, 2);
+    refresh();
+}
+
+static void step_rect(void) {
+    epaper_rect(100, 200, 30, 40, COLOR_RED);
+    refresh();
+}
+
+static void step_multi(void) {
+    epaper_set_orientation(ORIENTATION_90);
+    epaper_display_clear();
+    epaper_draw_text(5, 5, "Small", COLOR_BLACK, 1);
+    epaper_draw_text_6x12(5, 30, "Medium", COLOR_RED, 2);
+    epaper_draw_text_8x16(5, 70, "Large", COLOR_BLACK, 2);
+    refresh();
+}
+
+static void step_text_no_clear(void) {
+    epaper_draw_text_8x16(150, 100, "42", COLOR_RED, 2);
+    refresh();
+}
+
+// Lays out a text box in every orientation and checks that the text shows up
+// on the panel inside the lines the layout placed, at the same logical
+// position each time (layout and drawing share one coordinate model)
+static unsigned layout_failures;
+
+static void step_layout(void) {
+    static const char *const text = "Hello";
+    const font_t *font = font_get(FONT_ID_8X16);
+    const text_box_t box = { .x = 20, .y = 20, .w = 120, .h = 40, .align = TEXT_ALIGN_CENTER,
+                             .valign = TEXT_VALIGN_MIDDLE, .scale = 2, .line_gap = TEXT_LAYOUT_LINE_GAP };
+    int ref[4] = {0};
+
+    for (uint8_t o = ORIENTATION_0; o <= ORIENTATION_270; o++) {
+        text_layout_t layout;
+        epaper_set_orientation(o);
+        epaper_display_clear();
+        if (!text_layout(text, font, &box, &layout) || layout.line_count != 1) {
+            fprintf(stderr, "layout %d deg: no layout\n", o * 90);
+            layout_failures++;
+            continue;
+        }
+        text_layout_draw(text, font, &layout, COLOR_BLACK);
+        refresh();
+
+        // Bounds of the inked pixels, panel coordinates mapped back to logical ones
+        int min_x = INT32_MAX, min_y = INT32_MAX, max_x = -1, max_y = -1;
+        for (int py = 0; py < UC81XX_HEIGHT; py++) {
+            for (int px = 0; px < UC81XX_WIDTH; px++) {
+                if (uc81xx_pixel(sim_controller(), px, py) == 0) {
+                    continue;
+                }
+                int x = px, y = py;
+                switch (o) {
+                    case ORIENTATION_90:  x = py; y = UC81XX_WIDTH - 1 - px; break;
+                    case ORIENTATION_180: x = UC81XX_WIDTH - 1 - px; y = UC81XX_HEIGHT - 1 - py; break;
+                    case ORIENTATION_270: x = UC81XX_HEIGHT - 1 - py; y = px; break;
+                }
+                min_x = x < min_x ? x : min_x;
+                min_y = y < min_y ? y : min_y;
+                max_x = x > max_x ? x : max_x;
+                max_y = y > max_y ? y : max_y;
+            }
+        }
+
+        const text_line_t *line = &layout.lines[0];
+        bool inside = max_x >= 0 && min_x >= line->x && max_x < line->x + line->width &&
+                      min_y >= line->y && max_y < line->y + layout.height &&
+                      line->x >= box.x && line->x + line->width <= box.x + box.w &&
+                      line->y >= box.y && line->y + layout.height <= box.y + box.h;
+        bool same = o == ORIENTATION_0 || (min_x == ref[0] && min_y == ref[1] && max_x == ref[2] && max_y == ref[3]);
+        if (o == ORIENTATION_0) {
+            ref[0] = min_x, ref[1] = min_y, ref[2] = max_x, ref[3] = max_y;
+        }
+        if (!inside || !same) {
+            fprintf(stderr, "layout %d deg: text drawn at (%d,%d)-(%d,%d), laid out at (%d,%d) %dx%d\n",
+                    o * 90, min_x, min_y, max_x, max_y, line->x, line->y, line->width, layout.height);
+            layout_failures++;
+        }
+    }
+}
+
+static void step_orientation(void) {
+    epaper_set_orientation(ORIENTATION_0);
+}
+
+static void step_clear(void) {
+    epaper_display_clear();
+    refresh();
+}
+
+static void step_update_async(void) {
+    epaper_rect(20, 20, 50, 50, COLOR_BLACK);
+    if (epaper_display_update_async() == ESP_OK) {
+        epaper_display_update_wait(0);
+    }
+}
+
+static const step_t steps[] = {
+    { "init",                   step_init },
+    { "boot screen",            step_boot_screen },
+    { "POST /api/text",         step_text },
+    { "POST /api/rect",         step_rect },
+    { "POST /api/rect (same)",  step_rect },
+    { "POST /api/multi",        step_multi },
+    { "POST /api/text (small)", step_text_no_clear },
+    { "text box layout",        step_layout },
+    { "POST /api/orientation",  step_orientation },
+    { "POST /api/clear",        step_clear },
+    { "async full update",      step_update_async },
+};
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-o image.png|image.pbm] [-c] [-v] [-f full_ms] [-p partial_ms]\n"
+            "  -o  write the final panel image (PNG keeps red, PBM is 1-bit)\n"
+            "  -c  CSV output\n"
+            "  -v  show driver log (INFO), -vv for DEBUG\n"
+            "  -f  simulated full refresh time (default 15000 ms)\n"
+            "  -p  simulated partial refresh time (default 2500 ms)\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *image = NULL;
+    bool csv = false;
+    int full_ms = -1, partial_ms = -1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:cvf:p:h")) != -1) {
+        switch (opt) {
+            case 'o': image = optarg; break;
+            case 'c': csv = true; break;
+            case 'v': sim_log_level = sim_log_level < ESP_LOG_INFO ? ESP_LOG_INFO : ESP_LOG_DEBUG; break;
+            case 'f': full_ms = atoi(optarg); break;
+            case 'p': partial_ms = atoi(optarg); break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    sim_init();
+    uc81xx_t *emu = sim_controller();
+    if (full_ms >= 0) {
+        emu->timing.full_refresh_us = (uint32_t)full_ms * 1000;
+    }
+    if (partial_ms >= 0) {
+        emu->timing.partial_refresh_us = (uint32_t)partial_ms * 1000;
+    }
+
+    if (csv) {
+        printf("step,time_us,spi_transactions,spi_bytes,bus_us,busy_us,full_refreshes,partial_refreshes,errors\n");
+    } else {
+        printf("%-24s %10s %8s %9s %9s %10s %5s %5s %4s\n",
+               "step", "time_ms", "spi_txn", "spi_bytes", "bus_ms", "busy_ms", "full", "part", "err");
+    }
+
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        sim_spi_stats_t spi0, spi1;
+        uc81xx_stats_t st0 = emu->stats;
+        int64_t t0 = sim_now_us();
+        sim_get_spi_stats(&spi0);
+
+        steps[i].run();
+
+        sim_get_spi_stats(&spi1);
+        const uc81xx_stats_t *st1 = &emu->stats;
+        long long time_us = sim_now_us() - t0;
+        unsigned txn = spi1.transactions - spi0.transactions;
+        unsigned bytes = spi1.bytes - spi0.bytes;
+        long long bus_us = (long long)(spi1.bus_us - spi0.bus_us);
+        long long busy_us = (long long)(st1->busy_us - st0.busy_us);
+        unsigned full = st1->full_refreshes - st0.full_refreshes;
+        unsigned part = st1->partial_refreshes - st0.partial_refreshes;
+        unsigned err = st1->errors - st0.errors;
+
+        if (csv) {
+            printf("%s,%lld,%u,%u,%lld,%lld,%u,%u,%u\n",
+                   steps[i].name, time_us, txn, bytes, bus_us, busy_us, full, part, err);
+        } else {
+            printf("%-24s %10.1f %8u %9u %9.2f %10.1f %5u %5u %4u\n",
+                   steps[i].name, time_us / 1000.0, txn, bytes, bus_us / 1000.0, busy_us / 1000.0,
+                   full, part, err);
+        }
+    }
+
+    if (image != NULL && !image_write(emu, image)) {
+        fprintf(stderr, "Failed to write %s\n", image);
+        return 1;
+    }
+    return emu->stats.errors > 0 || layout_failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#include "image.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool write_pbm(const uc81xx_t *emu, FILE *f) {
+    fprintf(f, "P4\n%d %d\n", UC81XX_WIDTH, UC81XX_HEIGHT);
+    for (int y = 0; y < UC81XX_HEIGHT; y++) {
+        uint8_t row[UC81XX_ROW_BYTES] = {0};
+        for (int x = 0; x < UC81XX_WIDTH; x++) {
+            if (uc81xx_pixel(emu, x, y) != 0) {
+                row[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    return !ferror(f);
+}
+
+// ========== Minimal PNG: palette image in stored (uncompressed) deflate blocks ==========
+
+static uint32_t crc_table[256];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    if (crc_table[1] == 0) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            crc_table[n] = c;
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static void write_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t hdr[8];
+    put_u32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    if (len > 0) {
+        fwrite(data, 1, len, f);
+    }
+
+    uint32_t crc = crc32_update(0xffffffffu, (const uint8_t *)type, 4);
+    crc = crc32_update(crc, data, len) ^ 0xffffffffu;
+    uint8_t tail[4];
+    put_u32(tail, crc);
+    fwrite(tail, 1, 4, f);
+}
+
+static bool write_png(const uc81xx_t *emu, FILE *f) {
+    // Scanlines: filter byte 0, then one palette index per pixel
+    enum { LINE = UC81XX_WIDTH + 1, RAW = LINE * UC81XX_HEIGHT };
+    static uint8_t raw[RAW];
+    for (int y = 0; y < UC81XX_HEIGHT; y++) {
+        raw[y * LINE] = 0;
+        for (int x = 0; x < UC81XX_WIDTH; x++) {
+            raw[y * LINE + 1 + x] = uc81xx_pixel(emu, x, y);
+        }
+    }
+
+    // zlib stream of stored blocks (max 65535 bytes each) plus Adler-32
+    enum { BLOCKS = (RAW + 65534) / 65535 };
+    static uint8_t z[2 + RAW + BLOCKS * 5 + 4];
+    size_t zlen = 0;
+    z[zlen++] = 0x78;
+    z[zlen++] = 0x01;
+    for (size_t off = 0; off < RAW; ) {
+        size_t n = RAW - off > 65535 ? 65535 : RAW - off;
+        z[zlen++] = (off + n == RAW) ? 1 : 0;
+        z[zlen++] = n & 0xff;
+        z[zlen++] = n >> 8;
+        z[zlen++] = ~n & 0xff;
+        z[zlen++] = (~n >> 8) & 0xff;
+        memcpy(z + zlen, raw + off, n);
+        zlen += n;
+        off += n;
+    }
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < RAW; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32(z + zlen, (b << 16) | a);
+    zlen += 4;
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    uint8_t ihdr[13];
+    put_u32(ihdr, UC81XX_WIDTH);
+    put_u32(ihdr + 4, UC81XX_HEIGHT);
+    ihdr[8] = 8;   // Bit depth
+    ihdr[9] = 3;   // Palette
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    static const uint8_t palette[9] = {0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0xd0, 0x10, 0x10};
+
+    fwrite(signature, 1, sizeof(signature), f);
+    write_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    write_chunk(f, "PLTE", palette, sizeof(palette));
+    write_chunk(f, "IDAT", z, zlen);
+    write_chunk(f, "IEND", NULL, 0);
+    return !ferror(f);
+}
+
+bool image_write(const uc81xx_t *emu, const char *path) {
+    size_t len = strlen(path);
+    bool png = len > 4 && strcmp(path + len - 4, ".png") == 0;
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = png ? write_png(emu, f) : write_pbm(emu, f);
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,11 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdbool.h>
+#include "uc81xx.h"
+
+// Write what the panel shows: .png keeps the three colors, .pbm is 1-bit
+// (red printed as black)
+bool image_write(const uc81xx_t *emu, const char *path);
+
+#endif // IMAGE_H
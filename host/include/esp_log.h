@@ -0,0 +1,22 @@
+// Host build: ESP_LOGx print to stderr, filtered by sim_log_level
+#pragma once
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+extern esp_log_level_t sim_log_level;
+void sim_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...) sim_log(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) sim_log(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) sim_log(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) sim_log(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) sim_log(ESP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
@@ -0,0 +1,5 @@
+// Host build: advances the simulated clock
+#pragma once
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
@@ -0,0 +1,5 @@
+// Host build: returns the simulated clock, not wall time
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
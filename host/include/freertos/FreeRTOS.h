@@ -0,0 +1,19 @@
+// Host build: single-threaded FreeRTOS subset on the simulated clock
+#pragma once
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define configTICK_RATE_HZ 100  // ESP-IDF default
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY      0xffffffffu
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portYIELD_FROM_ISR(woken) (void)(woken)
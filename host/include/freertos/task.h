@@ -0,0 +1,5 @@
+#pragma once
+#include "FreeRTOS.h"
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""Build a font pack (.epf) for the firmware from a BDF or TrueType font.
+
+The pack format is described in src/epaper/font_pack.h. Each glyph is stored
+either as plain bits or as run lengths, whichever is smaller.
+
+  mkfontpack.py font.bdf -o data/terminus16.epf
+  mkfontpack.py DejaVuSans.ttf --size 24 -o data/sans24.epf   (needs Pillow)
+
+Copy the pack to data/ and upload it with `pio run --target uploadfs`; the
+font is then available under its file name, e.g. "font": "sans24".
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"EPFP"
+VERSION = 1
+MAX_SIZE = 64
+BITS, RUNS = 0, 1
+
+# Same set as the built-in fonts
+DEFAULT_CHARS = "".join(chr(c) for c in range(0x20, 0x7F)) + "°«»€àâäçéèêëîïôöùûüÿßœÀÂÄÇÈÉÊËÎÏÔÖÙÛÜŒ"
+
+
+class Glyph:
+    def __init__(self, code, width, advance, pixels):
+        self.code = code
+        self.width = width        # Bitmap width, trailing blank columns cut
+        self.advance = advance
+        self.pixels = pixels      # height rows of width booleans
+
+
+def trim(rows):
+    """Cut blank columns on the right, the left edge stays at the pen position."""
+    width = 0
+    for row in rows:
+        for x, on in enumerate(row):
+            if on:
+                width = max(width, x + 1)
+    return [row[:width] for row in rows], width
+
+
+def load_bdf(path, chars):
+    wanted = {ord(c) for c in chars} if chars else None
+    ascent = descent = None
+    glyphs = []
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONT_ASCENT":
+            ascent = int(words[1])
+        elif words[0] == "FONT_DESCENT":
+            descent = int(words[1])
+        elif words[0] == "FONTBOUNDINGBOX" and ascent is None:
+            h, yoff = int(words[2]), int(words[4])
+            ascent, descent = h + yoff, -yoff
+        elif words[0] == "STARTCHAR":
+            code, advance, bbx, bitmap = None, 0, (0, 0, 0, 0), []
+            for line in lines:
+                words = line.split()
+                if not words:
+                    continue
+                if words[0] == "ENCODING":
+                    code = int(words[1])
+                elif words[0] == "DWIDTH":
+                    advance = int(words[1])
+                elif words[0] == "BBX":
+                    bbx = tuple(int(w) for w in words[1:5])
+                elif words[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        hexdigits = line.strip()
+                        bitmap.append((int(hexdigits, 16), len(hexdigits) * 4))
+                    break
+            if code is None or code < 0 or (wanted is not None and code not in wanted):
+                continue
+            glyphs.append((code, advance, bbx, bitmap))
+
+    if ascent is None or descent is None:
+        sys.exit("%s: no FONT_ASCENT/FONT_DESCENT or FONTBOUNDINGBOX" % path)
+    height = ascent + descent
+
+    result = []
+    for code, advance, (w, h, xoff, yoff), bitmap in glyphs:
+        rows = [[False] * max(advance, xoff + w, 0) for _ in range(height)]
+        top = ascent - (yoff + h)
+        for r, (value, bits) in enumerate(bitmap[:h]):
+            for c in range(min(w, bits)):
+                x, y = xoff + c, top + r
+                if value & (1 << (bits - 1 - c)) and 0 <= x < len(rows[0]) and 0 <= y < height:
+                    rows[y][x] = True
+        rows, width = trim(rows)
+        result.append(Glyph(code, width, advance, rows))
+    return height, result
+
+
+def load_ttf(path, size, chars):
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        sys.exit("TrueType fonts need Pillow (pip install pillow), or convert the font to BDF")
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+
+    result = []
+    for ch in chars:
+        advance = int(round(font.getlength(ch)))
+        box = font.getbbox(ch)
+        canvas = max(advance, box[2], 1)
+        image = Image.new("1", (canvas, height), 0)
+        ImageDraw.Draw(image).text((0, 0), ch, font=font, fill=1)
+        rows = [[image.getpixel((x, y)) != 0 for x in range(canvas)] for y in range(height)]
+        rows, width = trim(rows)
+        result.append(Glyph(ord(ch), width, advance, rows))
+    return height, result
+
+
+def encode_bits(pixels):
+    out = bytearray()
+    acc = n = 0
+    for row in pixels:
+        for on in row:
+            acc = (acc << 1) | (1 if on else 0)
+            n += 1
+            if n == 8:
+                out.append(acc)
+                acc = n = 0
+    if n:
+        out.append(acc << (8 - n))
+    return bytes(out)
+
+
+def encode_runs(pixels):
+    out = bytearray()
+    color, run = False, 0
+    for row in pixels:
+        for on in row:
+            if on != color:
+                out.append(run)
+                color, run = on, 0
+            run += 1
+            if run == 255:
+                out += bytes((255, 0))
+                run = 0
+    if color and run:
+        out.append(run)  # Trailing white needs no run
+    return bytes(out)
+
+
+def build(height, glyphs):
+    glyphs = sorted(glyphs, key=lambda g: g.code)
+    index = bytearray()
+    store = bytearray()
+    raw_total = 0
+    for g in glyphs:
+        if g.width > MAX_SIZE or g.advance > 255:
+            sys.exit("U+%04X is %d px wide, the firmware takes %d" % (g.code, g.width, MAX_SIZE))
+        bits = encode_bits(g.pixels)
+        runs = encode_runs(g.pixels)
+        encoding, data = (RUNS, runs) if len(runs) < len(bits) else (BITS, bits)
+        index += struct.pack("<IIBBBB", g.code, len(store), g.width, g.advance, encoding, 0)
+        store += data
+        raw_total += ((g.width + 7) // 8) * height
+
+    header_size = 16
+    header = struct.pack("<4sBBHII", MAGIC, VERSION, height, len(glyphs), header_size + len(index), 0)
+    return header + bytes(index) + bytes(store), raw_total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("font", help="BDF or TrueType/OpenType font")
+    parser.add_argument("-o", "--output", required=True, help="pack file to write (.epf)")
+    parser.add_argument("-s", "--size", type=int, default=16, help="pixel size for TrueType fonts (default 16)")
+    parser.add_argument("-c", "--chars", default=DEFAULT_CHARS,
+                        help="characters to include (default printable ASCII and the built-in fonts' Latin letters)")
+    args = parser.parse_args()
+
+    if args.font.lower().endswith(".bdf"):
+        height, glyphs = load_bdf(args.font, args.chars)
+    else:
+        height, glyphs = load_ttf(args.font, args.size, args.chars)
+    if not glyphs:
+        sys.exit("No glyphs found")
+    if height > MAX_SIZE:
+        sys.exit("Line height %d px, the firmware takes %d" % (height, MAX_SIZE))
+
+    pack, raw_total = build(height, glyphs)
+    with open(args.output, "wb") as f:
+        f.write(pack)
+    print("%s: %d glyphs, %d px high, %d bytes (%d bytes as plain bitmaps)"
+          % (args.output, len(glyphs), height, len(pack), raw_total))
+
+
+if __name__ == "__main__":
+    main()
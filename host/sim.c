@@ -0,0 +1,387 @@
+#include "sim.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define SIM_MAX_EVENTS   64
+#define SIM_MAX_DONE     16
+#define SIM_TICK_US      (1000000 / configTICK_RATE_HZ)
+#define SIM_FOREVER      INT64_MAX
+
+esp_log_level_t sim_log_level = ESP_LOG_WARN;
+
+typedef void (*sim_event_fn)(void *arg, uint32_t gen);
+
+typedef struct {
+    int64_t at;
+    sim_event_fn fn;
+    void *arg;
+    uint32_t gen;
+} sim_event_t;
+
+struct sim_semaphore {
+    int count;
+    int max;
+};
+
+struct spi_device_t {
+    spi_device_interface_config_t cfg;
+    spi_transaction_t *done[SIM_MAX_DONE];  // Finished, not yet reaped
+    int done_count;
+    int inflight;                           // Queued, not yet reaped
+};
+
+static int64_t now_us;
+static sim_event_t events[SIM_MAX_EVENTS];
+static int event_count;
+
+static uc81xx_t controller;
+static uint8_t pin_level[64];
+static bool busy_level;
+static uint32_t busy_gen;  // Invalidates a pending BUSY release when a new period starts
+static gpio_isr_t busy_isr;
+static void *busy_isr_arg;
+
+static struct spi_device_t spi_dev;
+static int64_t bus_free_us;
+static sim_spi_stats_t spi_stats;
+
+// ========== Clock and events ==========
+
+static void schedule(int64_t at, sim_event_fn fn, void *arg, uint32_t gen) {
+    if (event_count >= SIM_MAX_EVENTS) {
+        fprintf(stderr, "sim: event queue overflow\n");
+        abort();
+    }
+    events[event_count++] = (sim_event_t) { at, fn, arg, gen };
+}
+
+static int next_event(void) {
+    int best = -1;
+    for (int i = 0; i < event_count; i++) {
+        if (best < 0 || events[i].at < events[best].at) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Move the clock to 'until', running every event due on the way in time order
+static void advance_to(int64_t until) {
+    while (1) {
+        int i = next_event();
+        if (i < 0 || events[i].at > until) {
+            break;
+        }
+        sim_event_t ev = events[i];
+        events[i] = events[--event_count];
+        if (ev.at > now_us) {
+            now_us = ev.at;
+        }
+        ev.fn(ev.arg, ev.gen);
+    }
+    if (until > now_us) {
+        now_us = until;
+    }
+}
+
+// Run events until ready() holds or the deadline passes
+static bool wait_until(bool (*ready)(void *), void *arg, int64_t deadline) {
+    advance_to(now_us);
+    while (!ready(arg)) {
+        int i = next_event();
+        if (i < 0 || events[i].at > deadline) {
+            if (deadline == SIM_FOREVER) {
+                fprintf(stderr, "sim: deadlock, waiting forever with nothing scheduled\n");
+                abort();
+            }
+            advance_to(deadline);
+            return ready(arg);
+        }
+        advance_to(events[i].at);
+    }
+    return true;
+}
+
+static int64_t ticks_deadline(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? SIM_FOREVER : now_us + (int64_t)ticks * SIM_TICK_US;
+}
+
+// ========== Controller wiring ==========
+
+static void busy_release(void *arg, uint32_t gen) {
+    if (gen != busy_gen || !busy_level) {
+        return;
+    }
+    busy_level = false;
+    if (busy_isr != NULL) {
+        busy_isr(busy_isr_arg); // Negative edge
+    }
+}
+
+static void busy_start(uint32_t duration_us) {
+    if (duration_us == 0) {
+        return;
+    }
+    busy_level = true;
+    schedule(now_us + duration_us, busy_release, NULL, ++busy_gen);
+}
+
+static void controller_feed(const spi_transaction_t *t) {
+    const uint8_t *bytes = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data : t->tx_buffer;
+    busy_start(uc81xx_write(&controller, pin_level[SIM_PIN_DC], bytes, t->length / 8, busy_level));
+}
+
+void sim_init(void) {
+    now_us = 0;
+    event_count = 0;
+    memset(pin_level, 0, sizeof(pin_level));
+    busy_level = false;
+    busy_gen = 0;
+    busy_isr = NULL;
+    memset(&spi_dev, 0, sizeof(spi_dev));
+    bus_free_us = 0;
+    memset(&spi_stats, 0, sizeof(spi_stats));
+    uc81xx_init(&controller);
+}
+
+int64_t sim_now_us(void) {
+    return now_us;
+}
+
+uc81xx_t *sim_controller(void) {
+    return &controller;
+}
+
+void sim_get_spi_stats(sim_spi_stats_t *stats) {
+    *stats = spi_stats;
+}
+
+// ========== esp_log / esp_err / esp_timer / heap ==========
+
+void sim_log(esp_log_level_t level, const char *tag, const char *fmt, ...) {
+    static const char letters[] = "NEWIDV";
+    if (level > sim_log_level) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(now_us / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "ESP_FAIL";
+    }
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    advance_to(now_us + us);
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+// ========== GPIO ==========
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= (int)sizeof(pin_level)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bool rising = !pin_level[gpio_num] && level;
+    pin_level[gpio_num] = level ? 1 : 0;
+
+    if (gpio_num == SIM_PIN_RST && rising) {
+        busy_start(uc81xx_reset(&controller));
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    // A pin read costs time, otherwise polling loops would never see a deadline
+    advance_to(now_us + 1);
+    if (gpio_num == SIM_PIN_BUSY) {
+        return busy_level ? 1 : 0;
+    }
+    return (gpio_num >= 0 && gpio_num < (int)sizeof(pin_level)) ? pin_level[gpio_num] : 0;
+}
+
+esp_err_t gpio_install_isr_service(int flags) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t handler, void *arg) {
+    if (gpio_num == SIM_PIN_BUSY) {
+        busy_isr = handler;
+        busy_isr_arg = arg;
+    }
+    return ESP_OK;
+}
+
+// ========== FreeRTOS ==========
+
+void vTaskDelay(TickType_t ticks) {
+    advance_to(now_us + (int64_t)ticks * SIM_TICK_US);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / SIM_TICK_US);
+}
+
+static SemaphoreHandle_t semaphore_create(int count, int max) {
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem != NULL) {
+        sem->count = count;
+        sem->max = max;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(1, 1);
+}
+
+static bool semaphore_ready(void *arg) {
+    return ((SemaphoreHandle_t)arg)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (!wait_until(semaphore_ready, sem, ticks_deadline(ticks))) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (sem->count >= sem->max) {
+        return pdFALSE;
+    }
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdTRUE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+// ========== SPI ==========
+
+static int64_t transfer_us(const spi_transaction_t *t) {
+    int hz = spi_dev.cfg.clock_speed_hz > 0 ? spi_dev.cfg.clock_speed_hz : 1000000;
+    return SIM_SPI_TXN_OVERHEAD_US + ((int64_t)t->length * 1000000 + hz - 1) / hz;
+}
+
+static void count_transfer(const spi_transaction_t *t, int64_t duration_us) {
+    spi_stats.transactions++;
+    spi_stats.bytes += t->length / 8;
+    spi_stats.bus_us += duration_us;
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dma_chan) {
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                             spi_device_handle_t *handle) {
+    spi_dev.cfg = *config;
+    *handle = &spi_dev;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans) {
+    if (handle->inflight > 0) {
+        ESP_LOGE("sim", "Polling transmit with queued transactions pending");
+        return ESP_ERR_INVALID_STATE;
+    }
+    // The CPU spins for the whole transfer; DC is sampled from the pin
+    int64_t duration = transfer_us(trans);
+    advance_to((bus_free_us > now_us ? bus_free_us : now_us) + duration);
+    bus_free_us = now_us;
+    count_transfer(trans, duration);
+    controller_feed(trans);
+    return ESP_OK;
+}
+
+static void queued_done(void *arg, uint32_t gen) {
+    spi_transaction_t *t = arg;
+    if (spi_dev.cfg.pre_cb != NULL) {
+        spi_dev.cfg.pre_cb(t);
+    }
+    controller_feed(t);
+    if (spi_dev.cfg.post_cb != NULL) {
+        spi_dev.cfg.post_cb(t);
+    }
+    spi_dev.done[spi_dev.done_count++] = t;
+}
+
+static bool queue_has_room(void *arg) {
+    return spi_dev.inflight < spi_dev.cfg.queue_size && spi_dev.inflight < SIM_MAX_DONE;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t ticks) {
+    if (!wait_until(queue_has_room, NULL, ticks_deadline(ticks))) {
+        return ESP_ERR_TIMEOUT;
+    }
+    // Transactions run back to back in the background, the caller continues
+    int64_t duration = transfer_us(trans);
+    int64_t start = bus_free_us > now_us ? bus_free_us : now_us;
+    bus_free_us = start + duration;
+    count_transfer(trans, duration);
+    handle->inflight++;
+    schedule(bus_free_us, queued_done, trans, 0);
+    return ESP_OK;
+}
+
+static bool result_ready(void *arg) {
+    return spi_dev.done_count > 0;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t ticks) {
+    if (!wait_until(result_ready, NULL, ticks_deadline(ticks))) {
+        return ESP_ERR_TIMEOUT;
+    }
+    *trans = handle->done[0];
+    memmove(handle->done, handle->done + 1, --handle->done_count * sizeof(handle->done[0]));
+    handle->inflight--;
+    return ESP_OK;
+}
@@ -0,0 +1,35 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include "uc81xx.h"
+
+// Host HAL: implements the gpio/spi_master/FreeRTOS/esp_timer calls the driver
+// makes on a simulated microsecond clock and routes them to a uc81xx_t.
+// Time only moves when the driver waits (delays, semaphores, SPI transfers,
+// BUSY polling), so results are deterministic.
+
+// Must match the wiring in src/epaper/epaper.c
+#define SIM_PIN_DC    0
+#define SIM_PIN_RST   1
+#define SIM_PIN_BUSY  2
+
+// Bus cost per transaction on top of the bits themselves (setup, CS, DMA start)
+#define SIM_SPI_TXN_OVERHEAD_US 10
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t bus_us;    // Time the bus spent clocking
+} sim_spi_stats_t;
+
+// Reset clock, pins and controller
+void sim_init(void);
+
+int64_t sim_now_us(void);
+
+uc81xx_t *sim_controller(void);
+
+void sim_get_spi_stats(sim_spi_stats_t *stats);
+
+#endif // SIM_H
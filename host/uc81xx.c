@@ -0,0 +1,205 @@
+#include "uc81xx.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "uc81xx";
+
+void uc81xx_init(uc81xx_t *emu) {
+    memset(emu, 0, sizeof(*emu));
+    emu->timing = (uc81xx_timing_t) {
+        .reset_us = 2000,
+        .power_on_us = 40000,
+        .power_off_us = 20000,
+        .full_refresh_us = 15000000,  // Tri-color waveform
+        .partial_refresh_us = 2500000,
+    };
+    uc81xx_reset(emu);
+}
+
+static void window_full(uc81xx_t *emu) {
+    emu->win_xb0 = 0;
+    emu->win_xb1 = UC81XX_ROW_BYTES - 1;
+    emu->win_y0 = 0;
+    emu->win_y1 = UC81XX_HEIGHT - 1;
+}
+
+uint32_t uc81xx_reset(uc81xx_t *emu) {
+    emu->cmd = 0;
+    emu->param = 0;
+    emu->powered = false;
+    emu->partial_mode = false;
+    emu->write_plane = NULL;
+    window_full(emu);
+    emu->stats.busy_us += emu->timing.reset_us;
+    return emu->timing.reset_us;
+}
+
+static void error(uc81xx_t *emu, const char *what) {
+    emu->stats.errors++;
+    ESP_LOGW(TAG, "%s (command 0x%02x)", what, emu->cmd);
+}
+
+// Copy RAM to the panel, window only in partial mode
+static uint32_t refresh(uc81xx_t *emu) {
+    if (!emu->powered) {
+        error(emu, "Refresh with DC/DC off ignored");
+        return 0;
+    }
+
+    uint16_t xb0 = 0, xb1 = UC81XX_ROW_BYTES - 1, y0 = 0, y1 = UC81XX_HEIGHT - 1;
+    if (emu->partial_mode) {
+        xb0 = emu->win_xb0; xb1 = emu->win_xb1;
+        y0 = emu->win_y0; y1 = emu->win_y1;
+    }
+    for (uint16_t y = y0; y <= y1; y++) {
+        size_t off = (size_t)y * UC81XX_ROW_BYTES + xb0;
+        memcpy(emu->panel_bw + off, emu->ram_bw + off, xb1 - xb0 + 1);
+        memcpy(emu->panel_red + off, emu->ram_red + off, xb1 - xb0 + 1);
+    }
+
+    uint32_t pixels = (uint32_t)(xb1 - xb0 + 1) * 8 * (y1 - y0 + 1);
+    emu->stats.refreshed_pixels += pixels;
+    if (emu->partial_mode) {
+        emu->stats.partial_refreshes++;
+        return emu->timing.partial_refresh_us;
+    }
+    emu->stats.full_refreshes++;
+    return emu->timing.full_refresh_us;
+}
+
+static uint32_t command(uc81xx_t *emu, uint8_t cmd) {
+    emu->cmd = cmd;
+    emu->param = 0;
+    emu->stats.commands++;
+
+    switch (cmd) {
+        case 0x00: // PSR, also a soft reset
+            return 0;
+        case 0x02: // POF
+            emu->powered = false;
+            return emu->timing.power_off_us;
+        case 0x04: // PON
+            emu->powered = true;
+            return emu->timing.power_on_us;
+        case 0x10: // DTM1
+            emu->write_plane = emu->ram_bw;
+            emu->write_pos = 0;
+            return 0;
+        case 0x13: // DTM2
+            emu->write_plane = emu->ram_red;
+            emu->write_pos = 0;
+            return 0;
+        case 0x12: // DRF
+            return refresh(emu);
+        case 0x90: // PTL, window follows
+            return 0;
+        case 0x91: // PTIN
+            emu->partial_mode = true;
+            return 0;
+        case 0x92: // PTOUT
+            emu->partial_mode = false;
+            return 0;
+        case 0xe0: // CCSET
+        case 0xe5: // TSSET
+            return 0;
+        default:
+            error(emu, "Unknown command");
+            return 0;
+    }
+}
+
+static void window_param(uc81xx_t *emu, uint8_t b) {
+    emu->window_raw[emu->param] = b;
+    if (emu->param < 6) {
+        return;
+    }
+    // Same layout as epaper_set_partial_window(): x, xe, y MSB/LSB, ye MSB/LSB, control
+    const uint8_t *p = emu->window_raw;
+    uint16_t x = p[0], xe = p[1];
+    uint16_t y = (p[2] << 8) | p[3], ye = (p[4] << 8) | p[5];
+    if (xe < x || ye < y || xe >= UC81XX_WIDTH || ye >= UC81XX_HEIGHT) {
+        error(emu, "Invalid partial window");
+        window_full(emu);
+        return;
+    }
+    emu->win_xb0 = x / 8;
+    emu->win_xb1 = xe / 8;
+    emu->win_y0 = y;
+    emu->win_y1 = ye;
+}
+
+static void plane_data(uc81xx_t *emu, uint8_t b) {
+    // Full screen writes cover all RAM, partial mode writes fill the window row by row
+    uint16_t xb0 = 0, row_bytes = UC81XX_ROW_BYTES, y0 = 0, rows = UC81XX_HEIGHT;
+    if (emu->partial_mode) {
+        xb0 = emu->win_xb0;
+        row_bytes = emu->win_xb1 - emu->win_xb0 + 1;
+        y0 = emu->win_y0;
+        rows = emu->win_y1 - emu->win_y0 + 1;
+    }
+    if (emu->write_pos >= (uint32_t)row_bytes * rows) {
+        if (emu->write_pos++ == (uint32_t)row_bytes * rows) {
+            error(emu, "Plane data past end of window");
+        }
+        return;
+    }
+    uint32_t row = emu->write_pos / row_bytes;
+    uint32_t col = emu->write_pos % row_bytes;
+    emu->write_plane[(y0 + row) * UC81XX_ROW_BYTES + xb0 + col] = b;
+    emu->write_pos++;
+    emu->stats.plane_bytes++;
+}
+
+static void data(uc81xx_t *emu, uint8_t b) {
+    switch (emu->cmd) {
+        case 0x00:
+            if (emu->param < sizeof(emu->psr)) {
+                emu->psr[emu->param] = b;
+            }
+            break;
+        case 0x10:
+        case 0x13:
+            plane_data(emu, b);
+            break;
+        case 0x90:
+            if (emu->param < sizeof(emu->window_raw)) {
+                window_param(emu, b);
+            }
+            break;
+        default:
+            break;
+    }
+    emu->param++;
+}
+
+uint32_t uc81xx_write(uc81xx_t *emu, bool dc_data, const uint8_t *bytes, size_t len, bool busy) {
+    uint32_t busy_us = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        if (busy && !dc_data) {
+            // Parameters may trail a busy command (the driver sends one after PON)
+            error(emu, "Command sent while BUSY");
+            busy = false; // Report once per transfer
+        }
+        if (dc_data) {
+            emu->stats.data_bytes++;
+            data(emu, bytes[i]);
+        } else {
+            uint32_t t = command(emu, bytes[i]);
+            if (t > 0) {
+                busy_us = t;
+            }
+        }
+    }
+    emu->stats.busy_us += busy_us;
+    return busy_us;
+}
+
+uint8_t uc81xx_pixel(const uc81xx_t *emu, int x, int y) {
+    size_t idx = (size_t)y * UC81XX_ROW_BYTES + x / 8;
+    uint8_t mask = 0x80 >> (x % 8);
+    if (emu->panel_red[idx] & mask) {
+        return 2;
+    }
+    return (emu->panel_bw[idx] & mask) ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#ifndef UC81XX_H
+#define UC81XX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Register-level model of the UC81xx commands used by src/epaper/epaper.c.
+// Bytes arrive with the DC level they were sent with; commands that keep the
+// controller busy return how long BUSY stays high.
+
+#define UC81XX_WIDTH      152
+#define UC81XX_HEIGHT     296
+#define UC81XX_ROW_BYTES  (UC81XX_WIDTH / 8)
+#define UC81XX_RAM_SIZE   (UC81XX_ROW_BYTES * UC81XX_HEIGHT)
+
+// BUSY durations (microseconds)
+typedef struct {
+    uint32_t reset_us;
+    uint32_t power_on_us;
+    uint32_t power_off_us;
+    uint32_t full_refresh_us;
+    uint32_t partial_refresh_us;
+} uc81xx_timing_t;
+
+typedef struct {
+    uint32_t commands;
+    uint32_t data_bytes;
+    uint32_t plane_bytes;       // Written to 0x10/0x13 RAM
+    uint32_t full_refreshes;
+    uint32_t partial_refreshes;
+    uint32_t refreshed_pixels;
+    uint64_t busy_us;           // Sum of all BUSY periods
+    uint32_t errors;            // Protocol misuse, see uc81xx.c
+} uc81xx_stats_t;
+
+typedef struct {
+    uc81xx_timing_t timing;
+    uc81xx_stats_t stats;
+
+    uint8_t cmd;                // Command owning the following data bytes
+    uint32_t param;             // Data bytes received for it
+    uint8_t psr[2];
+    uint8_t window_raw[7];
+    bool powered;
+    bool partial_mode;
+    uint16_t win_xb0, win_xb1;  // Window, byte columns
+    uint16_t win_y0, win_y1;
+    uint8_t *write_plane;
+    uint32_t write_pos;         // Bytes written into the window
+
+    // 0x10: bit set = black, 0x13: bit set = red (red wins)
+    uint8_t ram_bw[UC81XX_RAM_SIZE];
+    uint8_t ram_red[UC81XX_RAM_SIZE];
+    uint8_t panel_bw[UC81XX_RAM_SIZE];   // What the glass shows
+    uint8_t panel_red[UC81XX_RAM_SIZE];
+} uc81xx_t;
+
+void uc81xx_init(uc81xx_t *emu);
+
+// Hardware reset (RST released)
+uint32_t uc81xx_reset(uc81xx_t *emu);
+
+// Bytes clocked in with DC low (commands) or high (data); returns BUSY time started, 0 if none
+uint32_t uc81xx_write(uc81xx_t *emu, bool dc_data, const uint8_t *bytes, size_t len, bool busy);
+
+// Displayed pixel: 0 = white, 1 = black, 2 = red
+uint8_t uc81xx_pixel(const uc81xx_t *emu, int x, int y);
+
+#endif // UC81XX_H
@@ -6,7 +6,10 @@
 #include "esp_spiffs.h"
 
 static const char *TAG = "config";
-static config_t g_config = {0};
+static config_t g_config = {
+    .display_debounce_ms = -1,
+    .display_max_latency_ms = -1,
+};
 static bool g_initialized = false;
 
 // Trim whitespace from both ends of a string
@@ -72,6 +75,12 @@ static void parse_env_line(const char *line) {
         strncpy(g_config.wifi_password, value, CONFIG_WIFI_PASSWORD_MAX_LEN - 1);
         g_config.wifi_password[CONFIG_WIFI_PASSWORD_MAX_LEN - 1] = '\0';
         ESP_LOGI(TAG, "Loaded WIFI_PASSWORD: ********");
+    } else if (strcmp(key, "DISPLAY_DEBOUNCE_MS") == 0) {
+        g_config.display_debounce_ms = atoi(value);
+        ESP_LOGI(TAG, "Loaded DISPLAY_DEBOUNCE_MS: %d", g_config.display_debounce_ms);
+    } else if (strcmp(key, "DISPLAY_MAX_LATENCY_MS") == 0) {
+        g_config.display_max_latency_ms = atoi(value);
+        ESP_LOGI(TAG, "Loaded DISPLAY_MAX_LATENCY_MS: %d", g_config.display_max_latency_ms);
     }
 }
 
@@ -114,7 +123,6 @@ bool config_init(void) {
     if (f == NULL) {
         ESP_LOGE(TAG, "Failed to open /spiffs/.env file");
         ESP_LOGW(TAG, "Using default configuration");
-        esp_vfs_spiffs_unregister(NULL);
         g_initialized = true;
         return false;
     }
@@ -126,7 +134,7 @@ bool config_init(void) {
     }
 
     fclose(f);
-    esp_vfs_spiffs_unregister(NULL);
+    // SPIFFS stays mounted, font packs are read from it on demand
 
     // Validate configuration
     if (strlen(g_config.wifi_ssid) == 0) {
@@ -155,3 +163,11 @@ const char* config_get_wifi_ssid(void) {
 const char* config_get_wifi_password(void) {
     return g_config.wifi_password;
 }
+
+int config_get_display_debounce_ms(void) {
+    return g_config.display_debounce_ms;
+}
+
+int config_get_display_max_latency_ms(void) {
+    return g_config.display_max_latency_ms;
+}
@@ -11,9 +11,11 @@
 typedef struct {
     char wifi_ssid[CONFIG_WIFI_SSID_MAX_LEN];
     char wifi_password[CONFIG_WIFI_PASSWORD_MAX_LEN];
+    int display_debounce_ms;     // -1 if not set
+    int display_max_latency_ms;  // -1 if not set
 } config_t;
 
-// Initialize configuration (reads from .env file in SPIFFS)
+// Initialize configuration (mounts SPIFFS at /spiffs and reads the .env file)
 bool config_init(void);
 
 // Get the global configuration
@@ -22,5 +24,7 @@ const config_t* config_get(void);
 // Get individual values
 const char* config_get_wifi_ssid(void);
 const char* config_get_wifi_password(void);
+int config_get_display_debounce_ms(void);
+int config_get_display_max_latency_ms(void);
 
 #endif // CONFIG_H
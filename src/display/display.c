@@ -0,0 +1,730 @@
+#include "display.h"
+#include "display_list.h"
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "epaper/epaper.h"
+#include "widgets/widgets.h"
+
+static const char *TAG = "display";
+
+#define DISPLAY_QUEUE_LENGTH 16
+#define DISPLAY_BATCH_MAX    DISPLAY_QUEUE_LENGTH
+#define DISPLAY_TASK_STACK   4096
+#define DISPLAY_TASK_PRIO    5
+
+#define DISPLAY_DEFAULT_DEBOUNCE_MS    300
+#define DISPLAY_DEFAULT_MAX_LATENCY_MS 2000
+#define DISPLAY_LATENCY_SAMPLES        64
+
+struct display_job {
+    int64_t submitted_us;
+    bool clear;
+    bool refresh;
+    uint8_t orientation;   // DISPLAY_KEEP_ORIENTATION = unchanged
+    uint8_t layer;         // EPAPER_LAYER_NONE = the framebuffer itself
+    uint16_t op_count;
+    uint16_t op_capacity;
+    size_t text_used;
+    size_t text_capacity;
+    display_op_t *ops;     // Both arrays live in the same allocation as the job
+    char *text;
+};
+
+static QueueHandle_t job_queue = NULL;
+static SemaphoreHandle_t fb_mutex = NULL;
+static volatile bool busy = false;
+
+// Coalescing schedule
+static volatile uint32_t debounce_ms = DISPLAY_DEFAULT_DEBOUNCE_MS;
+static volatile uint32_t max_latency_ms = DISPLAY_DEFAULT_MAX_LATENCY_MS;
+
+// Jobs collected for the next refresh (display task only)
+static display_job_t *batch[DISPLAY_BATCH_MAX];
+static int batch_count = 0;
+static bool batch_refresh = false;
+static uint32_t batch_refresh_jobs = 0;  // Including superseded ones
+static int64_t batch_oldest_us = 0;
+static int64_t batch_last_us = 0;
+
+// Statistics, shared with readers through stats_mutex
+static SemaphoreHandle_t stats_mutex = NULL;
+static display_stats_t stats = {0};
+static uint32_t latency_ring[DISPLAY_LATENCY_SAMPLES];
+static uint32_t latency_next = 0;
+
+// Display list of the jobs drawn since the framebuffer was last cleared, valid
+// while everything on screen came from recordable jobs (fb_mutex)
+static uint8_t *recording_buf = NULL;
+static display_list_t recording;
+static bool recording_valid = false;
+
+display_job_t *display_job_create(uint16_t max_ops, size_t text_bytes) {
+    size_t size = sizeof(display_job_t) + max_ops * sizeof(display_op_t) + text_bytes;
+    display_job_t *job = calloc(1, size);
+    if (job == NULL) {
+        return NULL;
+    }
+    job->refresh = true;
+    job->orientation = DISPLAY_KEEP_ORIENTATION;
+    job->layer = EPAPER_LAYER_NONE;
+    job->op_capacity = max_ops;
+    job->text_capacity = text_bytes;
+    job->ops = (display_op_t *)(job + 1);
+    job->text = (char *)(job->ops + max_ops);
+    return job;
+}
+
+void display_job_free(display_job_t *job) {
+    free(job);
+}
+
+void display_job_set_clear(display_job_t *job, bool clear) {
+    job->clear = clear;
+}
+
+void display_job_set_orientation(display_job_t *job, uint8_t orientation) {
+    job->orientation = orientation;
+}
+
+void display_job_set_refresh(display_job_t *job, bool refresh) {
+    job->refresh = refresh;
+}
+
+void display_job_set_layer(display_job_t *job, uint8_t layer) {
+    job->layer = layer;
+}
+
+static display_op_t *job_add_op(display_job_t *job, uint8_t type) {
+    if (job->op_count >= job->op_capacity) {
+        return NULL;
+    }
+    display_op_t *op = &job->ops[job->op_count++];
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    return op;
+}
+
+// Copy len bytes into the job's data area, aligned to align bytes
+static void *job_copy_data(display_job_t *job, const void *data, size_t len, size_t align) {
+    size_t offset = (job->text_used + align - 1) & ~(align - 1);
+    if (offset + len > job->text_capacity) {
+        return NULL;
+    }
+    void *copy = job->text + offset;
+    memcpy(copy, data, len);
+    job->text_used = offset + len;
+    return copy;
+}
+
+// Copy text into the job and add an op for it
+static display_op_t *job_add_text_op(display_job_t *job, uint8_t type, const char *text, uint8_t font) {
+    size_t len = strlen(text) + 1;
+    if (job->text_used + len > job->text_capacity || job->op_count >= job->op_capacity) {
+        return NULL;
+    }
+    display_op_t *op = job_add_op(job, type);
+    char *copy = job_copy_data(job, text, len, 1);
+
+    op->text = copy;
+    op->font = font_get(font);
+    if (op->font == NULL) {
+        op->font = &font_8x16;
+    }
+    return op;
+}
+
+esp_err_t display_job_add_text(display_job_t *job, uint16_t x, uint16_t y, const char *text,
+                               uint8_t font, uint8_t color, uint8_t scale) {
+    display_op_t *op = job_add_text_op(job, DISPLAY_OP_TEXT, text, font);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = x;
+    op->y = y;
+    op->color = color;
+    op->scale = scale;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_text_box(display_job_t *job, const text_box_t *box, const char *text,
+                                   uint8_t font, uint8_t color) {
+    display_op_t *op = job_add_text_op(job, DISPLAY_OP_TEXT_BOX, text, font);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->box = *box;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_rect(display_job_t *job, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                               uint8_t color) {
+    display_op_t *op = job_add_op(job, DISPLAY_OP_RECT);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = x;
+    op->y = y;
+    op->w = w;
+    op->h = h;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_line(display_job_t *job, int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                               uint8_t thickness, uint8_t color) {
+    display_op_t *op = job_add_op(job, DISPLAY_OP_LINE);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = x0;
+    op->y = y0;
+    op->x1 = x1;
+    op->y1 = y1;
+    op->thickness = thickness;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_round_rect(display_job_t *job, int16_t x, int16_t y, uint16_t w, uint16_t h,
+                                     uint16_t radius, uint8_t thickness, uint8_t color) {
+    display_op_t *op = job_add_op(job, DISPLAY_OP_ROUND_RECT);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = x;
+    op->y = y;
+    op->w = w;
+    op->h = h;
+    op->r = radius;
+    op->thickness = thickness;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_circle(display_job_t *job, int16_t cx, int16_t cy, uint16_t r,
+                                 uint8_t thickness, uint8_t color) {
+    display_op_t *op = job_add_op(job, DISPLAY_OP_CIRCLE);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = cx;
+    op->y = cy;
+    op->r = r;
+    op->thickness = thickness;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_arc(display_job_t *job, int16_t cx, int16_t cy, uint16_t r,
+                              uint16_t start, uint16_t end, uint8_t thickness, uint8_t color) {
+    display_op_t *op = job_add_op(job, DISPLAY_OP_ARC);
+    if (op == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    op->x = cx;
+    op->y = cy;
+    op->r = r;
+    op->start = start;
+    op->end = end;
+    op->thickness = thickness;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_polygon(display_job_t *job, const int16_t *points, uint16_t count, uint8_t color) {
+    size_t len = (size_t)count * 2 * sizeof(int16_t);
+    if (count > EPAPER_POLYGON_MAX_POINTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (job->op_count >= job->op_capacity) {
+        return ESP_ERR_NO_MEM;
+    }
+    const int16_t *copy = job_copy_data(job, points, len, sizeof(int16_t));
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    display_op_t *op = job_add_op(job, DISPLAY_OP_POLYGON);
+    op->points = copy;
+    op->point_count = count;
+    op->color = color;
+    return ESP_OK;
+}
+
+esp_err_t display_job_add_widgets(display_job_t *job) {
+    return job_add_op(job, DISPLAY_OP_WIDGETS) != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Value of the placeholder at text ("{name}", len bytes long), NULL when text
+// does not start a placeholder
+static const char *bind_field(const char *text, const display_field_t *fields, uint8_t field_count,
+                              size_t *len) {
+    size_t n = 1;
+    while (text[n] == '_' || (text[n] >= 'a' && text[n] <= 'z') || (text[n] >= 'A' && text[n] <= 'Z') ||
+           (text[n] >= '0' && text[n] <= '9')) {
+        n++;
+    }
+    if (n == 1 || text[n] != '}') {
+        return NULL;
+    }
+    *len = n + 1;
+    for (uint8_t i = 0; i < field_count; i++) {
+        if (strncmp(fields[i].name, text + 1, n - 1) == 0 && fields[i].name[n - 1] == '\0') {
+            return fields[i].value;
+        }
+    }
+    return "";
+}
+
+// Expand the placeholders of text into out (when not NULL), returns the length.
+// Without fields (NULL) the text is copied as it is.
+static size_t bind_text(const char *text, const display_field_t *fields, uint8_t field_count, char *out) {
+    size_t used = 0;
+    while (*text) {
+        size_t len;
+        const char *value = *text == '{' && fields != NULL ? bind_field(text, fields, field_count, &len) : NULL;
+        if (value != NULL) {
+            size_t value_len = strlen(value);
+            if (out != NULL) {
+                memcpy(out + used, value, value_len);
+            }
+            used += value_len;
+            text += len;
+        } else {
+            if (out != NULL) {
+                out[used] = *text;
+            }
+            used++;
+            text++;
+        }
+    }
+    if (out != NULL) {
+        out[used] = '\0';
+    }
+    return used;
+}
+
+// Bytes of the data area a copy of op takes, see job_copy_op()
+static size_t op_data_bytes(const display_op_t *op, const display_field_t *fields, uint8_t field_count) {
+    if (op->text != NULL) {
+        return bind_text(op->text, fields, field_count, NULL) + 1;
+    }
+    if (op->points != NULL) {
+        return (size_t)op->point_count * 2 * sizeof(int16_t) + 1;
+    }
+    return 0;
+}
+
+// Add a copy of op with its text (bound to fields) and points to a job sized
+// with op_data_bytes()
+static void job_copy_op(display_job_t *job, const display_op_t *src, const display_field_t *fields,
+                        uint8_t field_count) {
+    display_op_t *op = job_add_op(job, src->type);
+    *op = *src;
+    if (op->text != NULL) {
+        char *text = job->text + job->text_used;
+        job->text_used += bind_text(op->text, fields, field_count, text) + 1;
+        op->text = text;
+    } else if (op->points != NULL) {
+        op->points = job_copy_data(job, op->points, (size_t)op->point_count * 2 * sizeof(int16_t),
+                                   sizeof(int16_t));
+    }
+}
+
+display_job_t *display_job_bind(const display_job_t *job, const display_field_t *fields, uint8_t field_count) {
+    // Size the copy: texts as expanded, polygon points as they are
+    size_t data_bytes = 0;
+    for (uint16_t i = 0; i < job->op_count; i++) {
+        data_bytes += op_data_bytes(&job->ops[i], fields, field_count);
+    }
+    display_job_t *copy = display_job_create(job->op_count, data_bytes);
+    if (copy == NULL) {
+        return NULL;
+    }
+    copy->clear = job->clear;
+    copy->refresh = job->refresh;
+    copy->orientation = job->orientation;
+    copy->layer = job->layer;
+    for (uint16_t i = 0; i < job->op_count; i++) {
+        job_copy_op(copy, &job->ops[i], fields, field_count);
+    }
+    return copy;
+}
+
+// Job of the records following a job record, the reader ends up at the next one
+static display_job_t *job_from_list(display_list_reader_t *reader, const display_list_job_t *settings) {
+    // Size the job, then read the records again to fill it
+    display_list_reader_t sizing = *reader;
+    display_list_item_t item;
+    uint16_t op_count = 0;
+    size_t data_bytes = 0;
+    const uint8_t *end = sizing.pos;
+    while (display_list_next(&sizing, &item) > 0 && item.opcode != DISPLAY_LIST_JOB) {
+        op_count++;
+        data_bytes += op_data_bytes(&item.op, NULL, 0);
+        end = sizing.pos;
+    }
+
+    display_job_t *job = display_job_create(op_count, data_bytes);
+    if (job == NULL) {
+        return NULL;
+    }
+    job->clear = settings->clear;
+    job->refresh = settings->refresh;
+    job->orientation = settings->orientation;
+    job->layer = settings->layer;
+    while (reader->pos < end && display_list_next(reader, &item) > 0) {
+        job_copy_op(job, &item.op, NULL, 0);
+    }
+    return job;
+}
+
+esp_err_t display_submit_list(const uint8_t *data, size_t len) {
+    // Check all of it first, a corrupt list draws nothing
+    display_list_reader_t reader;
+    display_list_item_t item;
+    int ret;
+    if (!display_list_open(&reader, data, len)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (bool first = true; (ret = display_list_next(&reader, &item)) > 0; first = false) {
+        if (first && item.opcode != DISPLAY_LIST_JOB) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (ret < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    display_list_open(&reader, data, len);
+    while (display_list_next(&reader, &item) > 0) {
+        display_job_t *job = job_from_list(&reader, &item.job);
+        if (job == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t err = display_submit(job);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+// Append a drawn job to the recording. A clear of the framebuffer starts a
+// new one; widgets depend on state a list does not carry, so they end it.
+static void record_job(const display_job_t *job) {
+    if (recording_buf == NULL) {
+        return;
+    }
+    if (job->clear && job->layer == EPAPER_LAYER_NONE) {
+        display_list_init(&recording, recording_buf, DISPLAY_RECORD_BYTES);
+        recording_valid = true;
+    }
+    if (!recording_valid) {
+        return;
+    }
+    display_list_job_t settings = {
+        .clear = job->clear,
+        .refresh = job->refresh,
+        .orientation = epaper_get_orientation(),  // As drawn, so a replay needs no context
+        .layer = job->layer,
+    };
+    display_list_add_job(&recording, &settings);
+    for (uint16_t i = 0; i < job->op_count; i++) {
+        if (job->ops[i].type == DISPLAY_OP_WIDGETS) {
+            recording_valid = false;
+            return;
+        }
+        display_list_add_op(&recording, &job->ops[i]);
+    }
+    if (recording.overflow) {
+        ESP_LOGW(TAG, "Screen no longer fits a %d byte display list", DISPLAY_RECORD_BYTES);
+        recording_valid = false;
+    }
+}
+
+// Draw a job into the framebuffer (display task, framebuffer locked)
+static void display_render(const display_job_t *job) {
+    if (job->orientation != DISPLAY_KEEP_ORIENTATION) {
+        epaper_set_orientation(job->orientation);
+    }
+    if (epaper_layer_select(job->layer) != ESP_OK) {
+        ESP_LOGE(TAG, "Layer %d unavailable, job dropped", job->layer);
+        return;
+    }
+    if (job->clear) {
+        epaper_display_clear();
+        if (job->layer == EPAPER_LAYER_NONE) {
+            // The widgets are gone from the screen, the next widgets op redraws them
+            widgets_invalidate_all();
+        }
+    }
+
+    for (uint16_t i = 0; i < job->op_count; i++) {
+        const display_op_t *op = &job->ops[i];
+        if (op->type == DISPLAY_OP_WIDGETS) {
+            widgets_render();
+        } else {
+            display_op_draw(op);
+        }
+    }
+    record_job(job);
+
+    // Uploads outside the display task draw into the framebuffer
+    epaper_layer_select(EPAPER_LAYER_NONE);
+}
+
+// Add a received job to the pending batch
+static void batch_add(display_job_t *job) {
+    if (batch_count == 0) {
+        batch_oldest_us = job->submitted_us;
+    }
+    batch_last_us = job->submitted_us;
+    if (job->refresh) {
+        batch_refresh = true;
+        batch_refresh_jobs++;
+    }
+
+    // A clear wipes whatever the pending jobs would draw into its layer, so
+    // never draw them. Clearing the framebuffer drops every layer. The
+    // orientation of dropped jobs still applies unless the new job sets its own.
+    if (job->clear && batch_count > 0) {
+        uint8_t orientation = DISPLAY_KEEP_ORIENTATION;
+        int kept = 0, dropped = 0;
+        for (int i = 0; i < batch_count; i++) {
+            display_job_t *pending = batch[i];
+            if (pending->orientation != DISPLAY_KEEP_ORIENTATION) {
+                orientation = pending->orientation;
+            }
+            if (job->layer != EPAPER_LAYER_NONE && pending->layer != job->layer) {
+                batch[kept++] = pending;
+                continue;
+            }
+            display_job_free(pending);
+            dropped++;
+        }
+        if (job->orientation == DISPLAY_KEEP_ORIENTATION) {
+            job->orientation = orientation;
+        }
+
+        xSemaphoreTake(stats_mutex, portMAX_DELAY);
+        stats.superseded += dropped;
+        xSemaphoreGive(stats_mutex);
+        batch_count = kept;
+    }
+
+    batch[batch_count++] = job;
+}
+
+// Draw all pending jobs and show them with one refresh
+static void batch_run(void) {
+    busy = true;
+
+    // Only drawing and the snapshot need the framebuffer, not the refresh itself
+    display_lock();
+    for (int i = 0; i < batch_count; i++) {
+        display_render(batch[i]);
+    }
+    bool send = batch_refresh && epaper_display_refresh_begin();
+    display_unlock();
+
+    if (send) {
+        epaper_display_flush();
+    }
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    stats.batches++;
+    if (batch_refresh_jobs > 1) {
+        stats.refreshes_avoided += batch_refresh_jobs - 1;
+    }
+    for (int i = 0; i < batch_count; i++) {
+        latency_ring[latency_next++ % DISPLAY_LATENCY_SAMPLES] =
+            (uint32_t)((now - batch[i]->submitted_us) / 1000);
+    }
+    xSemaphoreGive(stats_mutex);
+
+    if (batch_count > 1 || batch_refresh_jobs > 1) {
+        ESP_LOGI(TAG, "Coalesced %d jobs (%lu refresh requests) into one update",
+                 batch_count, (unsigned long)batch_refresh_jobs);
+    }
+    for (int i = 0; i < batch_count; i++) {
+        display_job_free(batch[i]);
+    }
+    batch_count = 0;
+    batch_refresh = false;
+    batch_refresh_jobs = 0;
+    busy = uxQueueMessagesWaiting(job_queue) > 0;
+}
+
+static void display_task(void *arg) {
+    display_job_t *job;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+
+        if (batch_count > 0) {
+            // Pick up everything that queued up meanwhile (e.g. during a refresh)
+            while (batch_count < DISPLAY_BATCH_MAX && xQueueReceive(job_queue, &job, 0) == pdTRUE) {
+                batch_add(job);
+            }
+
+            // Due when quiet for the debounce window, or at the deadline of the oldest job
+            int64_t now = esp_timer_get_time();
+            int64_t due = batch_last_us + (int64_t)debounce_ms * 1000;
+            int64_t deadline = batch_oldest_us + (int64_t)max_latency_ms * 1000;
+            if (deadline < due) {
+                due = deadline;
+            }
+            if (due <= now || batch_count >= DISPLAY_BATCH_MAX) {
+                batch_run();
+                continue;
+            }
+            wait = pdMS_TO_TICKS((due - now + 999) / 1000);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+
+        if (xQueueReceive(job_queue, &job, wait) == pdTRUE) {
+            batch_add(job);
+        }
+    }
+}
+
+esp_err_t display_start(void) {
+    if (job_queue != NULL) {
+        ESP_LOGW(TAG, "Display service already running");
+        return ESP_OK;
+    }
+
+    fb_mutex = xSemaphoreCreateMutex();
+    stats_mutex = xSemaphoreCreateMutex();
+    job_queue = xQueueCreate(DISPLAY_QUEUE_LENGTH, sizeof(display_job_t *));
+    recording_buf = malloc(DISPLAY_RECORD_BYTES);
+    if (fb_mutex == NULL || stats_mutex == NULL || job_queue == NULL || recording_buf == NULL) {
+        ESP_LOGE(TAG, "Failed to create display queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(display_task, "display", DISPLAY_TASK_STACK, NULL, DISPLAY_TASK_PRIO, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create display task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Display service started");
+    return ESP_OK;
+}
+
+esp_err_t display_submit(display_job_t *job) {
+    if (job == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (job_queue == NULL) {
+        ESP_LOGE(TAG, "Display service not started");
+        display_job_free(job);
+        return ESP_ERR_INVALID_STATE;
+    }
+    job->submitted_us = esp_timer_get_time();
+    bool queued = xQueueSend(job_queue, &job, 0) == pdTRUE;
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    if (queued) {
+        stats.jobs++;
+    } else {
+        stats.rejected++;
+    }
+    xSemaphoreGive(stats_mutex);
+
+    if (!queued) {
+        ESP_LOGW(TAG, "Display queue full, job dropped");
+        display_job_free(job);
+        return ESP_ERR_TIMEOUT;
+    }
+    busy = true;
+    return ESP_OK;
+}
+
+void display_set_schedule(uint32_t debounce, uint32_t max_latency) {
+    debounce_ms = debounce;
+    max_latency_ms = max_latency;
+    ESP_LOGI(TAG, "Refresh schedule: debounce %lu ms, max latency %lu ms",
+             (unsigned long)debounce, (unsigned long)max_latency);
+}
+
+// Value below which pct percent of the sorted samples fall
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct) {
+    return sorted[(n - 1) * pct / 100];
+}
+
+void display_get_stats(display_stats_t *out) {
+    uint32_t samples[DISPLAY_LATENCY_SAMPLES];
+    uint32_t n = 0;
+
+    memset(out, 0, sizeof(*out));
+    if (stats_mutex != NULL) {
+        xSemaphoreTake(stats_mutex, portMAX_DELAY);
+        *out = stats;
+        n = latency_next < DISPLAY_LATENCY_SAMPLES ? latency_next : DISPLAY_LATENCY_SAMPLES;
+        memcpy(samples, latency_ring, n * sizeof(samples[0]));
+        xSemaphoreGive(stats_mutex);
+    }
+    out->debounce_ms = debounce_ms;
+    out->max_latency_ms = max_latency_ms;
+
+    // Insertion sort, the ring is small
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t v = samples[i];
+        uint32_t j = i;
+        while (j > 0 && samples[j - 1] > v) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = v;
+    }
+
+    out->latency_samples = n;
+    if (n > 0) {
+        out->latency_p50_ms = percentile(samples, n, 50);
+        out->latency_p90_ms = percentile(samples, n, 90);
+        out->latency_p99_ms = percentile(samples, n, 99);
+        out->latency_max_ms = samples[n - 1];
+    }
+}
+
+void display_lock(void) {
+    xSemaphoreTake(fb_mutex, portMAX_DELAY);
+}
+
+void display_unlock(void) {
+    xSemaphoreGive(fb_mutex);
+}
+
+void display_record_break(void) {
+    recording_valid = false;
+}
+
+esp_err_t display_get_recording(uint8_t *buf, size_t size, size_t *len) {
+    display_lock();
+    esp_err_t err = ESP_OK;
+    if (!recording_valid) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (recording.len > size) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else {
+        memcpy(buf, recording_buf, recording.len);
+        *len = recording.len;
+    }
+    display_unlock();
+    return err;
+}
+
+bool display_is_busy(void) {
+    return busy;
+}
@@ -0,0 +1,185 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "epaper/font.h"
+#include "epaper/text_layout.h"
+
+// Display service: one task owns the framebuffer and the SPI bus. Other tasks
+// describe what to draw in a job and hand it over through a queue, so they
+// never wait for a panel refresh.
+
+#define DISPLAY_KEEP_ORIENTATION 0xFF
+#define DISPLAY_RECORD_BYTES     4096  // Largest display list recorded or replayed
+
+typedef enum {
+    DISPLAY_OP_TEXT,
+    DISPLAY_OP_RECT,
+    DISPLAY_OP_TEXT_BOX,  // Text laid out in a box (text_layout.h)
+    DISPLAY_OP_LINE,
+    DISPLAY_OP_ROUND_RECT,  // Outlined or rounded rectangle
+    DISPLAY_OP_CIRCLE,
+    DISPLAY_OP_ARC,
+    DISPLAY_OP_POLYGON,
+    DISPLAY_OP_WIDGETS,  // Redraw the invalid widgets (widgets/widgets.h)
+} display_op_type_t;
+
+typedef struct {
+    uint8_t type;      // display_op_type_t
+    uint8_t color;     // COLOR_WHITE, COLOR_BLACK or COLOR_RED
+    uint8_t scale;
+    uint8_t thickness; // Shapes, 0 = filled
+    int16_t x, y;      // Circles and arcs: center
+    int16_t x1, y1;    // Lines only: end point
+    uint16_t w, h;     // Rectangles only
+    uint16_t r;        // Corner radius, circle and arc radius
+    uint16_t start, end;  // Arcs only, degrees clockwise from 3 o'clock
+    uint16_t point_count; // Polygons only
+    const int16_t *points;  // Polygons only, x/y pairs owned by the job
+    const font_t *font;  // Text only
+    const char *text;  // Text only, copy owned by the job
+    text_box_t box;    // Text boxes only, instead of x, y and scale
+} display_op_t;
+
+typedef struct display_job display_job_t;
+
+/**
+ * @brief Allocate a job with room for max_ops operations and text_bytes of data
+ *
+ * The data area holds copies of the strings (length + 1 each) and polygon
+ * points (4 bytes per point, plus 1 for alignment).
+ *
+ * New jobs refresh the panel when done, keep the screen content and the
+ * orientation, and draw into the framebuffer itself (no layer).
+ */
+display_job_t *display_job_create(uint16_t max_ops, size_t text_bytes);
+void display_job_free(display_job_t *job);
+
+void display_job_set_clear(display_job_t *job, bool clear);
+void display_job_set_orientation(display_job_t *job, uint8_t orientation);
+void display_job_set_refresh(display_job_t *job, bool refresh);
+// Draw into a layer (EPAPER_LAYER_*, see epaper.h): with clear set, only that layer is cleared
+void display_job_set_layer(display_job_t *job, uint8_t layer);
+
+// font is an API id (FONT_ID_*), unknown ids get the large font
+esp_err_t display_job_add_text(display_job_t *job, uint16_t x, uint16_t y, const char *text,
+                               uint8_t font, uint8_t color, uint8_t scale);
+// Text laid out when the job is drawn, so measuring sees the fonts the renderer uses
+esp_err_t display_job_add_text_box(display_job_t *job, const text_box_t *box, const char *text,
+                                   uint8_t font, uint8_t color);
+esp_err_t display_job_add_rect(display_job_t *job, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                               uint8_t color);
+
+// Vector shapes, see epaper.h. A thickness of 0 fills the shape.
+esp_err_t display_job_add_line(display_job_t *job, int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                               uint8_t thickness, uint8_t color);
+esp_err_t display_job_add_round_rect(display_job_t *job, int16_t x, int16_t y, uint16_t w, uint16_t h,
+                                     uint16_t radius, uint8_t thickness, uint8_t color);
+esp_err_t display_job_add_circle(display_job_t *job, int16_t cx, int16_t cy, uint16_t r,
+                                 uint8_t thickness, uint8_t color);
+esp_err_t display_job_add_arc(display_job_t *job, int16_t cx, int16_t cy, uint16_t r,
+                              uint16_t start, uint16_t end, uint8_t thickness, uint8_t color);
+// points: count x/y pairs, copied into the job
+esp_err_t display_job_add_polygon(display_job_t *job, const int16_t *points, uint16_t count, uint8_t color);
+// Draw the widgets changed since the last render, at this point of the job
+esp_err_t display_job_add_widgets(display_job_t *job);
+
+// A named value for display_job_bind()
+typedef struct {
+    const char *name;
+    const char *value;
+} display_field_t;
+
+/**
+ * @brief Copy a job, replacing "{name}" in its texts by the value of that field
+ *
+ * Lets a prepared job serve as a template: only the values change from one
+ * copy to the next. Placeholders without a field become empty, a '{' that
+ * does not start a placeholder is kept as it is.
+ *
+ * @return The new job, NULL when out of memory
+ */
+display_job_t *display_job_bind(const display_job_t *job, const display_field_t *fields, uint8_t field_count);
+
+/**
+ * @brief Queue the jobs of a display list (display_list.h) for the display task
+ *
+ * @return ESP_OK if all were queued, ESP_ERR_INVALID_ARG for a corrupt list
+ *         (nothing queued), ESP_ERR_NO_MEM or ESP_ERR_TIMEOUT (the jobs
+ *         before the failing one stay queued)
+ */
+esp_err_t display_submit_list(const uint8_t *data, size_t len);
+
+/**
+ * @brief Start the display task (call once, after epaper_init())
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t display_start(void);
+
+/**
+ * @brief Queue a job for the display task, returns immediately
+ *
+ * Ownership of the job passes to the display service, also on error.
+ *
+ * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the queue is full
+ */
+esp_err_t display_submit(display_job_t *job);
+
+typedef struct {
+    uint32_t jobs;              // Jobs accepted
+    uint32_t rejected;          // Jobs refused because the queue was full
+    uint32_t superseded;        // Jobs dropped undrawn, hidden by a later clear
+    uint32_t batches;           // Render passes, each with at most one refresh
+    uint32_t refreshes_avoided; // Jobs asking for a refresh that shared one
+    uint32_t latency_samples;   // Samples behind the percentiles below
+    uint32_t latency_p50_ms;    // Submit to panel updated, recent jobs
+    uint32_t latency_p90_ms;
+    uint32_t latency_p99_ms;
+    uint32_t latency_max_ms;
+    uint32_t debounce_ms;       // Current schedule
+    uint32_t max_latency_ms;
+} display_stats_t;
+
+/**
+ * @brief Configure refresh coalescing
+ *
+ * Jobs are collected until none arrived for debounce_ms, but the oldest one is
+ * never held longer than max_latency_ms. All collected jobs are then drawn and
+ * shown with a single refresh. A debounce of 0 refreshes after every job.
+ */
+void display_set_schedule(uint32_t debounce_ms, uint32_t max_latency_ms);
+
+/**
+ * @brief Get scheduler counters and end-to-end latency percentiles
+ */
+void display_get_stats(display_stats_t *stats);
+
+// Exclusive framebuffer access for code outside the display task
+void display_lock(void);
+void display_unlock(void);
+
+/**
+ * @brief Copy the display list of what the screen shows
+ *
+ * The display task records the jobs it draws, starting over at each clear of
+ * the framebuffer, so the list begins with that clear and replaying it draws
+ * the same frame.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_STATE when the screen has content no list
+ *         describes (uploads, widgets, too much to record), ESP_ERR_INVALID_SIZE
+ *         when size is too small
+ */
+esp_err_t display_get_recording(uint8_t *buf, size_t size, size_t *len);
+
+// Drawing outside the display service (uploads, with display_lock() held)
+// leaves the recording incomplete until the next clear
+void display_record_break(void);
+
+// True while a job is being drawn or the panel is refreshing
+bool display_is_busy(void);
+
+#endif // DISPLAY_H
@@ -0,0 +1,421 @@
+#include "display_list.h"
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "display_list";
+
+// --- Writing ---
+
+static void put_byte(display_list_t *list, size_t *pos, uint8_t b) {
+    if (*pos < list->cap) {
+        list->buf[*pos] = b;
+    }
+    (*pos)++;
+}
+
+static void put_uint(display_list_t *list, size_t *pos, uint32_t v) {
+    while (v >= 0x80) {
+        put_byte(list, pos, (v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    put_byte(list, pos, v);
+}
+
+static void put_int(display_list_t *list, size_t *pos, int32_t v) {
+    put_uint(list, pos, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+// A record is written past len and only kept when all of it fit
+static void commit(display_list_t *list, size_t pos) {
+    if (pos > list->cap) {
+        list->overflow = true;
+    } else if (!list->overflow) {
+        list->len = pos;
+    }
+}
+
+void display_list_init(display_list_t *list, uint8_t *buf, size_t cap) {
+    list->buf = buf;
+    list->cap = cap;
+    list->len = 0;
+    list->overflow = false;
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++) {
+        put_byte(list, &pos, DISPLAY_LIST_MAGIC[i]);
+    }
+    put_byte(list, &pos, DISPLAY_LIST_VERSION);
+    commit(list, pos);
+}
+
+void display_list_add_job(display_list_t *list, const display_list_job_t *job) {
+    size_t pos = list->len;
+    put_byte(list, &pos, DISPLAY_LIST_JOB);
+    put_byte(list, &pos, (job->clear ? 1 : 0) | (job->refresh ? 2 : 0));
+    put_byte(list, &pos, job->orientation);
+    put_byte(list, &pos, job->layer);
+    commit(list, pos);
+}
+
+// API id of a font, the large font (what unknown ids get) when not registered
+static uint8_t font_id_of(const font_t *font) {
+    const font_t *f;
+    for (uint8_t id = 0; (f = font_get(id)) != NULL; id++) {
+        if (f == font) {
+            return id;
+        }
+    }
+    return FONT_ID_8X16;
+}
+
+static void put_text(display_list_t *list, size_t *pos, const char *text) {
+    do {
+        put_byte(list, pos, *text);
+    } while (*text++);
+}
+
+void display_list_add_op(display_list_t *list, const display_op_t *op) {
+    size_t pos = list->len;
+    switch (op->type) {
+        case DISPLAY_OP_TEXT:
+            put_byte(list, &pos, DISPLAY_LIST_TEXT);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_byte(list, &pos, font_id_of(op->font));
+            put_byte(list, &pos, op->color);
+            put_byte(list, &pos, op->scale);
+            put_text(list, &pos, op->text);
+            break;
+        case DISPLAY_OP_TEXT_BOX:
+            put_byte(list, &pos, DISPLAY_LIST_TEXT_BOX);
+            put_int(list, &pos, op->box.x);
+            put_int(list, &pos, op->box.y);
+            put_uint(list, &pos, op->box.w);
+            put_uint(list, &pos, op->box.h);
+            put_byte(list, &pos, font_id_of(op->font));
+            put_byte(list, &pos, op->color);
+            put_byte(list, &pos, op->box.scale);
+            put_byte(list, &pos, op->box.align);
+            put_byte(list, &pos, op->box.valign);
+            put_byte(list, &pos, op->box.line_gap);
+            put_byte(list, &pos, (op->box.wrap ? 1 : 0) | (op->box.fit ? 2 : 0));
+            put_text(list, &pos, op->text);
+            break;
+        case DISPLAY_OP_RECT:
+            put_byte(list, &pos, DISPLAY_LIST_RECT);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_uint(list, &pos, op->w);
+            put_uint(list, &pos, op->h);
+            put_byte(list, &pos, op->color);
+            break;
+        case DISPLAY_OP_LINE:
+            put_byte(list, &pos, DISPLAY_LIST_LINE);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_int(list, &pos, op->x1);
+            put_int(list, &pos, op->y1);
+            put_byte(list, &pos, op->thickness);
+            put_byte(list, &pos, op->color);
+            break;
+        case DISPLAY_OP_ROUND_RECT:
+            put_byte(list, &pos, DISPLAY_LIST_ROUND_RECT);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_uint(list, &pos, op->w);
+            put_uint(list, &pos, op->h);
+            put_uint(list, &pos, op->r);
+            put_byte(list, &pos, op->thickness);
+            put_byte(list, &pos, op->color);
+            break;
+        case DISPLAY_OP_CIRCLE:
+            put_byte(list, &pos, DISPLAY_LIST_CIRCLE);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_uint(list, &pos, op->r);
+            put_byte(list, &pos, op->thickness);
+            put_byte(list, &pos, op->color);
+            break;
+        case DISPLAY_OP_ARC:
+            put_byte(list, &pos, DISPLAY_LIST_ARC);
+            put_int(list, &pos, op->x);
+            put_int(list, &pos, op->y);
+            put_uint(list, &pos, op->r);
+            put_uint(list, &pos, op->start);
+            put_uint(list, &pos, op->end);
+            put_byte(list, &pos, op->thickness);
+            put_byte(list, &pos, op->color);
+            break;
+        case DISPLAY_OP_POLYGON:
+            put_byte(list, &pos, DISPLAY_LIST_POLYGON);
+            put_uint(list, &pos, op->point_count);
+            put_byte(list, &pos, op->color);
+            for (uint16_t i = 0; i < op->point_count; i++) {
+                int32_t px = i > 0 ? op->points[2 * i - 2] : 0, py = i > 0 ? op->points[2 * i - 1] : 0;
+                put_int(list, &pos, op->points[2 * i] - px);
+                put_int(list, &pos, op->points[2 * i + 1] - py);
+            }
+            break;
+        case DISPLAY_OP_WIDGETS:
+            put_byte(list, &pos, DISPLAY_LIST_WIDGETS);
+            break;
+        default:
+            return;
+    }
+    commit(list, pos);
+}
+
+// --- Reading ---
+
+// Fields past the end of the list read as 0, next() then reports the list corrupt
+static uint8_t get_byte(display_list_reader_t *r) {
+    if (r->pos >= r->end) {
+        r->overrun = true;
+        return 0;
+    }
+    return *r->pos++;
+}
+
+static uint32_t get_uint(display_list_reader_t *r) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t b = get_byte(r);
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+    }
+    return v;
+}
+
+static int32_t get_int(display_list_reader_t *r) {
+    uint32_t v = get_uint(r);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static const font_t *get_font(display_list_reader_t *r) {
+    const font_t *font = font_get(get_byte(r));
+    return font != NULL ? font : &font_8x16;
+}
+
+// NUL terminated text in place, NULL when it runs past the end
+static const char *get_text(display_list_reader_t *r) {
+    const uint8_t *start = r->pos;
+    const uint8_t *nul = r->pos < r->end ? memchr(r->pos, 0, r->end - r->pos) : NULL;
+    if (nul == NULL) {
+        r->overrun = true;
+        return NULL;
+    }
+    r->pos = nul + 1;
+    return (const char *)start;
+}
+
+bool display_list_open(display_list_reader_t *reader, const uint8_t *data, size_t len) {
+    if (len < DISPLAY_LIST_HEADER || memcmp(data, DISPLAY_LIST_MAGIC, 4) != 0 ||
+        data[4] != DISPLAY_LIST_VERSION) {
+        return false;
+    }
+    reader->pos = data + DISPLAY_LIST_HEADER;
+    reader->end = data + len;
+    reader->overrun = false;
+    return true;
+}
+
+int display_list_next(display_list_reader_t *r, display_list_item_t *item) {
+    if (r->overrun) {
+        return -1;
+    }
+    if (r->pos == r->end) {
+        return 0;
+    }
+    display_op_t *op = &item->op;
+    memset(op, 0, sizeof(*op));
+    item->opcode = get_byte(r);
+    switch (item->opcode) {
+        case DISPLAY_LIST_JOB: {
+            uint8_t flags = get_byte(r);
+            item->job.clear = flags & 1;
+            item->job.refresh = flags & 2;
+            item->job.orientation = get_byte(r);
+            item->job.layer = get_byte(r);
+            break;
+        }
+        case DISPLAY_LIST_TEXT:
+            op->type = DISPLAY_OP_TEXT;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->font = get_font(r);
+            op->color = get_byte(r);
+            op->scale = get_byte(r);
+            op->text = get_text(r);
+            break;
+        case DISPLAY_LIST_TEXT_BOX: {
+            op->type = DISPLAY_OP_TEXT_BOX;
+            op->box.x = get_int(r);
+            op->box.y = get_int(r);
+            op->box.w = get_uint(r);
+            op->box.h = get_uint(r);
+            op->font = get_font(r);
+            op->color = get_byte(r);
+            op->box.scale = get_byte(r);
+            op->box.align = get_byte(r);
+            op->box.valign = get_byte(r);
+            op->box.line_gap = get_byte(r);
+            uint8_t flags = get_byte(r);
+            op->box.wrap = flags & 1;
+            op->box.fit = flags & 2;
+            op->text = get_text(r);
+            break;
+        }
+        case DISPLAY_LIST_RECT:
+            op->type = DISPLAY_OP_RECT;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->w = get_uint(r);
+            op->h = get_uint(r);
+            op->color = get_byte(r);
+            break;
+        case DISPLAY_LIST_LINE:
+            op->type = DISPLAY_OP_LINE;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->x1 = get_int(r);
+            op->y1 = get_int(r);
+            op->thickness = get_byte(r);
+            op->color = get_byte(r);
+            break;
+        case DISPLAY_LIST_ROUND_RECT:
+            op->type = DISPLAY_OP_ROUND_RECT;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->w = get_uint(r);
+            op->h = get_uint(r);
+            op->r = get_uint(r);
+            op->thickness = get_byte(r);
+            op->color = get_byte(r);
+            break;
+        case DISPLAY_LIST_CIRCLE:
+            op->type = DISPLAY_OP_CIRCLE;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->r = get_uint(r);
+            op->thickness = get_byte(r);
+            op->color = get_byte(r);
+            break;
+        case DISPLAY_LIST_ARC:
+            op->type = DISPLAY_OP_ARC;
+            op->x = get_int(r);
+            op->y = get_int(r);
+            op->r = get_uint(r);
+            op->start = get_uint(r);
+            op->end = get_uint(r);
+            op->thickness = get_byte(r);
+            op->color = get_byte(r);
+            break;
+        case DISPLAY_LIST_POLYGON: {
+            op->type = DISPLAY_OP_POLYGON;
+            uint32_t count = get_uint(r);
+            if (count == 0 || count > EPAPER_POLYGON_MAX_POINTS) {
+                return -1;
+            }
+            op->color = get_byte(r);
+            int32_t px = 0, py = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                px += get_int(r);
+                py += get_int(r);
+                r->points[2 * i] = px;
+                r->points[2 * i + 1] = py;
+            }
+            op->point_count = count;
+            op->points = r->points;
+            break;
+        }
+        case DISPLAY_LIST_WIDGETS:
+            op->type = DISPLAY_OP_WIDGETS;
+            break;
+        default:
+            return -1;
+    }
+    if (r->overrun ||
+        ((item->opcode == DISPLAY_LIST_TEXT || item->opcode == DISPLAY_LIST_TEXT_BOX) && op->text == NULL)) {
+        return -1;
+    }
+    return 1;
+}
+
+uint32_t display_list_hash(const uint8_t *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// --- Drawing ---
+
+static void draw_text_box(const display_op_t *op) {
+    text_layout_t layout;
+    if (text_layout(op->text, op->font, &op->box, &layout)) {
+        if (!layout.fits) {
+            ESP_LOGW(TAG, "'%s' does not fit its %dx%d box", op->text, op->box.w, op->box.h);
+        }
+        text_layout_draw(op->text, op->font, &layout, op->color);
+    }
+}
+
+void display_op_draw(const display_op_t *op) {
+    switch (op->type) {
+        case DISPLAY_OP_TEXT:
+            epaper_draw_text_font(op->x, op->y, op->text, op->font, op->color, op->scale);
+            break;
+        case DISPLAY_OP_RECT:
+            epaper_rect(op->x, op->y, op->w, op->h, op->color);
+            break;
+        case DISPLAY_OP_TEXT_BOX:
+            draw_text_box(op);
+            break;
+        case DISPLAY_OP_LINE:
+            epaper_line(op->x, op->y, op->x1, op->y1, op->thickness, op->color);
+            break;
+        case DISPLAY_OP_ROUND_RECT:
+            epaper_round_rect(op->x, op->y, op->w, op->h, op->r, op->thickness, op->color);
+            break;
+        case DISPLAY_OP_CIRCLE:
+            epaper_circle(op->x, op->y, op->r, op->thickness, op->color);
+            break;
+        case DISPLAY_OP_ARC:
+            epaper_arc(op->x, op->y, op->r, op->start, op->end, op->thickness, op->color);
+            break;
+        case DISPLAY_OP_POLYGON:
+            epaper_polygon(op->points, op->point_count, op->color);
+            break;
+    }
+}
+
+bool display_list_draw(const uint8_t *data, size_t len) {
+    display_list_reader_t reader;
+    display_list_item_t item;
+    if (!display_list_open(&reader, data, len)) {
+        return false;
+    }
+    // Like the display service: a job whose layer is unavailable is dropped
+    bool skip = false;
+    int ret;
+    while ((ret = display_list_next(&reader, &item)) > 0) {
+        if (item.opcode != DISPLAY_LIST_JOB) {
+            if (!skip && item.op.type != DISPLAY_OP_WIDGETS) {
+                display_op_draw(&item.op);
+            }
+            continue;
+        }
+        epaper_layer_select(EPAPER_LAYER_NONE);
+        if (item.job.orientation != DISPLAY_KEEP_ORIENTATION) {
+            epaper_set_orientation(item.job.orientation);
+        }
+        skip = epaper_layer_select(item.job.layer) != ESP_OK;
+        if (!skip && item.job.clear) {
+            epaper_display_clear();
+        }
+    }
+    epaper_layer_select(EPAPER_LAYER_NONE);
+    return ret == 0;
+}
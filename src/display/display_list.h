@@ -0,0 +1,102 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "display.h"
+#include "epaper/epaper.h"
+
+// Display lists: display jobs as a compact byte stream, to store, hash,
+// send over HTTP and replay later. Needs only the epaper driver, so the host
+// build decodes and draws them too (host/dlist.c).
+//
+// Format: "EPDL", version byte (1), then records. A record is an opcode
+// byte and its fields. Coordinates, sizes and angles are varints (LEB128,
+// signed values zigzag encoded), everything else is a byte.
+//   0x01 job        flags (bit 0 clear, bit 1 refresh), orientation, layer
+//                   (0xFF = keep / none); starts a job, the ops follow
+//   0x10 text       x y, font id, color, scale, text (UTF-8, NUL terminated)
+//   0x11 text box   x y w h, font id, color, scale, align, valign, line gap,
+//                   flags (bit 0 wrap, bit 1 fit), text
+//   0x12 rect       x y w h, color
+//   0x13 line       x0 y0 x1 y1, thickness, color
+//   0x14 round rect x y w h radius, thickness, color
+//   0x15 circle     cx cy r, thickness, color
+//   0x16 arc        cx cy r start end, thickness, color
+//   0x17 polygon    count, color, first point, then deltas to the previous one
+//   0x18 widgets    (redraw the invalid widgets, not replayable on its own)
+// Font ids are the API ids (FONT_ID_* and font packs in registration order).
+
+#define DISPLAY_LIST_MAGIC   "EPDL"
+#define DISPLAY_LIST_VERSION 1
+#define DISPLAY_LIST_HEADER  5
+
+typedef enum {
+    DISPLAY_LIST_JOB = 0x01,
+    DISPLAY_LIST_TEXT = 0x10,
+    DISPLAY_LIST_TEXT_BOX,
+    DISPLAY_LIST_RECT,
+    DISPLAY_LIST_LINE,
+    DISPLAY_LIST_ROUND_RECT,
+    DISPLAY_LIST_CIRCLE,
+    DISPLAY_LIST_ARC,
+    DISPLAY_LIST_POLYGON,
+    DISPLAY_LIST_WIDGETS,
+} display_list_opcode_t;
+
+// Settings of a job record
+typedef struct {
+    bool clear;
+    bool refresh;
+    uint8_t orientation;  // DISPLAY_KEEP_ORIENTATION = unchanged
+    uint8_t layer;        // EPAPER_LAYER_NONE = the framebuffer
+} display_list_job_t;
+
+// Writer into a caller's buffer. Running out of room sets overflow and keeps
+// len at the last complete record.
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    bool overflow;
+} display_list_t;
+
+// Start an empty list (header only)
+void display_list_init(display_list_t *list, uint8_t *buf, size_t cap);
+void display_list_add_job(display_list_t *list, const display_list_job_t *job);
+void display_list_add_op(display_list_t *list, const display_op_t *op);
+
+// Decoded record, valid until the next display_list_next() call
+typedef struct {
+    uint8_t opcode;          // display_list_opcode_t
+    display_list_job_t job;  // Job records
+    display_op_t op;         // Op records, text points into the list
+} display_list_item_t;
+
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool overrun;  // A field ran past the end
+    int16_t points[2 * EPAPER_POLYGON_MAX_POINTS];  // Polygon of the current item
+} display_list_reader_t;
+
+// Check the header, false when data is not a display list of this version
+bool display_list_open(display_list_reader_t *reader, const uint8_t *data, size_t len);
+
+// Next record: 1 when one was read, 0 at the end, -1 when the list is corrupt
+int display_list_next(display_list_reader_t *reader, display_list_item_t *item);
+
+// FNV-1a of the whole list, equal lists draw the same
+uint32_t display_list_hash(const uint8_t *data, size_t len);
+
+// Draw one op (anything but widgets) into the framebuffer, in the current
+// orientation and layer and within the clip (epaper_set_clip())
+void display_op_draw(const display_op_t *op);
+
+// Replay a list into the framebuffer: orientation, layer and clear of its
+// jobs apply, refreshing is up to the caller. Widgets ops are skipped.
+// Returns false when the list is corrupt (what came before is drawn).
+bool display_list_draw(const uint8_t *data, size_t len);
+
+#endif // DISPLAY_LIST_H
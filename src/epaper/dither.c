@@ -0,0 +1,180 @@
+#include "dither.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "dither";
+
+// Pixels are handled as luminance Y and red chroma C (how much red stands out
+// from green and blue). The palette in that plane:
+#define WHITE_Y 255
+#define RED_Y   76   // Luminance of pure red, (77 * 255) >> 8
+#define RED_C   255
+
+static const uint8_t bayer8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+esp_err_t dither_begin(dither_t *d) {
+    if (d->w == 0 || d->w > DITHER_MAX_WIDTH || d->h == 0 || d->format > DITHER_RGB888 ||
+        d->method > DITHER_FLOYD_STEINBERG) {
+        ESP_LOGE(TAG, "Invalid image %dx%d (format %d, method %d)", d->w, d->h, d->format, d->method);
+        return ESP_ERR_INVALID_ARG;
+    }
+    d->col = d->row = 0;
+    d->partial_len = 0;
+    d->channels = (d->format == DITHER_RGB888 && d->red) ? 2 : 1;
+    d->err_cur = d->err_next = NULL;
+    memset(d->bw, 0, sizeof(d->bw));
+    memset(d->red_bits, 0, sizeof(d->red_bits));
+
+    if (d->method == DITHER_FLOYD_STEINBERG) {
+        // One extra column each side, so neighbours never need a bounds check
+        size_t row_len = (size_t)d->channels * (d->w + 2);
+        d->err_cur = calloc(2 * row_len, sizeof(int16_t));
+        if (d->err_cur == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        d->err_next = d->err_cur + row_len;
+    }
+    return ESP_OK;
+}
+
+size_t dither_size(const dither_t *d) {
+    return (size_t)d->w * d->h * (d->format == DITHER_RGB888 ? 3 : 1);
+}
+
+bool dither_done(const dither_t *d) {
+    return d->row >= d->h;
+}
+
+void dither_end(dither_t *d) {
+    // Both rows share one allocation, the rows swap places every line
+    free(d->err_cur < d->err_next ? d->err_cur : d->err_next);
+    d->err_cur = d->err_next = NULL;
+}
+
+static int16_t clamp_level(int32_t v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+// Nearest palette color of (y, c), white, black or red
+static uint8_t nearest(int32_t y, int32_t c, bool red) {
+    int32_t dw = (y - WHITE_Y) * (y - WHITE_Y) + c * c;
+    int32_t db = y * y + c * c;
+    uint8_t color = dw < db ? COLOR_WHITE : COLOR_BLACK;
+    if (red) {
+        int32_t dr = (y - RED_Y) * (y - RED_Y) + (c - RED_C) * (c - RED_C);
+        if (dr < (dw < db ? dw : db)) {
+            color = COLOR_RED;
+        }
+    }
+    return color;
+}
+
+// Spread err over the right neighbour and the three pixels below (7, 3, 5, 1 sixteenths)
+static void diffuse(int16_t *cur, int16_t *next, uint16_t i, int32_t err) {
+    int32_t e7 = err * 7 / 16, e3 = err * 3 / 16, e5 = err * 5 / 16;
+    cur[i + 1] += e7;
+    next[i - 1] += e3;
+    next[i] += e5;
+    next[i + 1] += err - e7 - e3 - e5;
+}
+
+static uint8_t quantize(dither_t *d, uint8_t y, uint8_t c) {
+    uint16_t x = d->col;
+    switch (d->method) {
+        case DITHER_BAYER: {
+            // Matrix cell as a level 2..254, the threshold shifts all of them
+            int32_t level = bayer8[d->row & 7][x & 7] * 4 + 2;
+            if (d->red && c > level) {
+                return COLOR_RED;
+            }
+            return y > level + (d->threshold - 128) ? COLOR_WHITE : COLOR_BLACK;
+        }
+        case DITHER_FLOYD_STEINBERG: {
+            size_t stride = d->w + 2;
+            uint16_t i = x + 1;
+            int32_t yv = clamp_level(y + d->err_cur[i] + 128 - d->threshold);
+            int32_t cv = d->channels > 1 ? clamp_level(c + d->err_cur[stride + i]) : 0;
+            uint8_t color = nearest(yv, cv, d->channels > 1);
+            int32_t qy = color == COLOR_WHITE ? WHITE_Y : (color == COLOR_RED ? RED_Y : 0);
+            diffuse(d->err_cur, d->err_next, i, yv - qy);
+            if (d->channels > 1) {
+                diffuse(d->err_cur + stride, d->err_next + stride, i, cv - (color == COLOR_RED ? RED_C : 0));
+            }
+            return color;
+        }
+        default:
+            if (d->red && c >= 128) {
+                return COLOR_RED;
+            }
+            return y >= d->threshold ? COLOR_WHITE : COLOR_BLACK;
+    }
+}
+
+// Draw the finished row and start the next one
+static void end_row(dither_t *d) {
+    int32_t y = d->bottom_up ? d->y + d->h - 1 - d->row : d->y + d->row;
+    epaper_draw_row(d->x, y, d->w, d->bw, d->red_bits);
+    memset(d->bw, 0, sizeof(d->bw));
+    memset(d->red_bits, 0, sizeof(d->red_bits));
+    if (d->err_cur != NULL) {
+        int16_t *t = d->err_cur;
+        d->err_cur = d->err_next;
+        d->err_next = t;
+        memset(d->err_next, 0, (size_t)d->channels * (d->w + 2) * sizeof(int16_t));
+    }
+    d->col = 0;
+    d->row++;
+}
+
+static void put_pixel(dither_t *d, const uint8_t *p) {
+    uint8_t y, c = 0;
+    if (d->format == DITHER_RGB888) {
+        uint8_t gb = p[1] > p[2] ? p[1] : p[2];
+        y = (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+        c = p[0] > gb ? p[0] - gb : 0;
+    } else {
+        y = p[0];
+    }
+
+    uint8_t color = quantize(d, y, c);
+    uint8_t bit = 0x80 >> (d->col % 8);
+    if (color == COLOR_BLACK) {
+        d->bw[d->col / 8] |= bit;
+    } else if (color == COLOR_RED) {
+        d->red_bits[d->col / 8] |= bit;
+    }
+    if (++d->col == d->w) {
+        end_row(d);
+    }
+}
+
+void dither_write(dither_t *d, const uint8_t *data, size_t len) {
+    uint8_t bpp = d->format == DITHER_RGB888 ? 3 : 1;
+
+    // Finish a pixel split by the previous write
+    while (d->partial_len > 0 && len > 0 && !dither_done(d)) {
+        d->partial[d->partial_len++] = *data++;
+        len--;
+        if (d->partial_len == bpp) {
+            put_pixel(d, d->partial);
+            d->partial_len = 0;
+        }
+    }
+    for (; len >= bpp && !dither_done(d); data += bpp, len -= bpp) {
+        put_pixel(d, data);
+    }
+    if (len > 0 && !dither_done(d)) {
+        memcpy(d->partial, data, len);
+        d->partial_len = len;
+    }
+}
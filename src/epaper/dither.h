@@ -0,0 +1,63 @@
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "epaper.h"
+
+// Streaming conversion of 8-bit gray or RGB888 pixels to white, black and red.
+// Pixels are fed in row order, in chunks of any size, and every completed row
+// goes to the framebuffer with epaper_draw_row() (global orientation). Only two
+// rows of error state are kept, never the image. Callers hold display_lock().
+
+#define DITHER_MAX_WIDTH SCREEN_2_6_HEIGHT  // Longest logical row
+#define DITHER_ROW_BYTES ((DITHER_MAX_WIDTH + 7) / 8)
+
+typedef enum {
+    DITHER_GRAY8,   // 1 byte per pixel
+    DITHER_RGB888,  // 3 bytes per pixel, R first
+} dither_format_t;
+
+typedef enum {
+    DITHER_THRESHOLD,        // Hard cut at threshold
+    DITHER_BAYER,            // Ordered, 8x8 Bayer matrix
+    DITHER_FLOYD_STEINBERG,  // Error diffusion
+} dither_method_t;
+
+typedef struct {
+    // Set by the caller before dither_begin()
+    int16_t x, y;        // Logical position of the image
+    uint16_t w, h;
+    uint8_t format;      // dither_format_t
+    uint8_t method;      // dither_method_t
+    uint8_t threshold;   // Gray level from which pixels turn white (128 = middle)
+    bool red;            // Map reddish pixels to red, otherwise black and white only
+    bool bottom_up;      // Rows arrive last row first (BMP)
+
+    // Streaming state
+    uint16_t col, row;
+    uint8_t partial[3];  // Bytes of a pixel split across writes
+    uint8_t partial_len;
+    uint8_t channels;    // Error channels: luminance, plus red chroma with red
+    int16_t *err_cur, *err_next;  // Floyd-Steinberg: channels * (w + 2) each
+    uint8_t bw[DITHER_ROW_BYTES];
+    uint8_t red_bits[DITHER_ROW_BYTES];
+} dither_t;
+
+// Check the settings and allocate the error rows (Floyd-Steinberg only)
+esp_err_t dither_begin(dither_t *d);
+
+// Bytes of pixel data the whole image takes
+size_t dither_size(const dither_t *d);
+
+// Feed the next len bytes of pixel data, bytes past the image are ignored
+void dither_write(dither_t *d, const uint8_t *data, size_t len);
+
+bool dither_done(const dither_t *d);
+
+// Free the error rows. Rows not completed are not drawn.
+void dither_end(dither_t *d);
+
+#endif // DITHER_H
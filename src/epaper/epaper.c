@@ -4,9 +4,15 @@
 #include "driver/spi_master.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <string.h>
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
 #include "epaper_utils.h"
+#include "font_pack.h"
 
 // GPIO pin definitions - adjust these according to your wiring
 #define PIN_NUM_MOSI    18          // Violet
@@ -22,8 +28,81 @@
 
 const uint8_t register_data[] = {0x00, 0x0e, 0x19, 0x02, 0xcf, 0x8d};
 
+// Largest single DMA transaction; big enough to push a whole plane at once
+#define MAX_SPI_CHUNK 8192
+
 static spi_device_handle_t spi_device = NULL;
 
+// Bulk (DMA) plane transfer is used by default, per-byte path kept for comparison
+static uint8_t bulk_transfer = 1;
+
+// Running SPI counters, snapshotted around each frame transfer
+static uint32_t spi_transactions = 0;
+static uint32_t spi_bytes = 0;
+static epaper_transfer_stats_t frame_stats = {0};
+static epaper_transfer_stats_t fill_stats = {0};
+
+// Counter snapshot taken at the start of a measured transfer
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+    int64_t start_us;
+} stats_mark_t;
+
+// BUSY handling: the falling edge of BUSY gives busy_sem from the GPIO ISR
+#define BUSY_ASSERT_US 2000         // Time allowed for BUSY to rise after a command
+#define BUSY_SPIN_US   100          // Polled part of it, the task sleeps for the rest
+#define BUSY_POLL_US   10
+#define BUSY_SLOT_OTHER 3           // Histogram slot for commands not listed below
+static SemaphoreHandle_t busy_sem = NULL;
+static uint32_t busy_timeout_ms = 20000; // Tri-color full refresh takes ~15 s
+static uint8_t busy_cmd = 0;             // Last command sent, owner of the next BUSY period
+static epaper_busy_stats_t busy_stats[BUSY_SLOT_OTHER + 1];
+
+// Any write to controller RAM outside the framebuffer flush invalidates the shadow frame
+static void shadow_invalidate(void);
+
+// Solid fills stream from a small DMA buffer holding the repeated byte
+#define FILL_CHUNK 1024
+static uint8_t *fill_buffer = NULL;
+static int16_t fill_pattern = -1; // Byte currently in fill_buffer, -1 = none
+
+// Queued (asynchronous) transport: one sequence in flight at a time, at most
+// EPAPER_SPI_QUEUE_SIZE transactions per sequence
+#define EPAPER_SPI_QUEUE_SIZE 10
+
+// spi_transaction_t.user flags, interpreted by the pre/post transfer callbacks.
+// Polling transactions leave user NULL and drive DC themselves.
+#define EPAPER_TXN_DC_SET   0x01  // Callback drives DC before the transfer
+#define EPAPER_TXN_DC_DATA  0x02  // DC level: set = data, clear = command
+#define EPAPER_TXN_LAST     0x04  // Last transaction of a sequence
+
+static spi_transaction_t async_txn[EPAPER_SPI_QUEUE_SIZE];
+static uint8_t async_count = 0;     // Transactions built for the next submit
+static uint8_t async_inflight = 0;  // Transactions queued and not yet reaped
+static SemaphoreHandle_t async_done = NULL;
+static stats_mark_t async_mark;
+
+// Snapshot of the framebuffers being transferred, so drawing can continue meanwhile
+static uint8_t *tx_bw = NULL;
+static uint8_t *tx_red = NULL;
+
+static void IRAM_ATTR epaper_spi_pre_transfer(spi_transaction_t *t) {
+    uintptr_t flags = (uintptr_t)t->user;
+    if (flags & EPAPER_TXN_DC_SET) {
+        gpio_set_level(PIN_NUM_DC, (flags & EPAPER_TXN_DC_DATA) ? 1 : 0);
+    }
+}
+
+static void IRAM_ATTR epaper_spi_post_transfer(spi_transaction_t *t) {
+    uintptr_t flags = (uintptr_t)t->user;
+    if (flags & EPAPER_TXN_LAST) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(async_done, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
 // Minimal SPI setup (call once before using epaper functions)
 void epaper_spi_init(void) {
     spi_bus_config_t buscfg = {
@@ -32,25 +111,51 @@ void epaper_spi_init(void) {
         .sclk_io_num = PIN_NUM_CLK,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
-        .max_transfer_sz = 4096,
+        .max_transfer_sz = MAX_SPI_CHUNK,
     };
     spi_device_interface_config_t devcfg = {
         .clock_speed_hz = 4 * 1000 * 1000,
         .mode = 0,
         .spics_io_num = PIN_NUM_CS,
-        .queue_size = 1,
+        .queue_size = EPAPER_SPI_QUEUE_SIZE,
+        .pre_cb = epaper_spi_pre_transfer,
+        .post_cb = epaper_spi_post_transfer,
     };
+    async_done = xSemaphoreCreateBinary();
     spi_bus_initialize(SPI2_HOST, &buscfg, SPI_DMA_CH_AUTO);
     spi_bus_add_device(SPI2_HOST, &devcfg, &spi_device);
 }
 
+// Single point every SPI transaction goes through (keeps the counters honest)
+static esp_err_t epaper_spi_transmit(spi_transaction_t *t) {
+    // Polling and queued transactions cannot be mixed on one device
+    if (async_inflight > 0) {
+        epaper_async_wait(0);
+    }
+    spi_transactions++;
+    spi_bytes += t->length / 8;
+    return spi_device_polling_transmit(spi_device, t);
+}
+
+static void stats_mark(stats_mark_t *mark) {
+    mark->transactions = spi_transactions;
+    mark->bytes = spi_bytes;
+    mark->start_us = esp_timer_get_time();
+}
+
+static void stats_finish(const stats_mark_t *mark, epaper_transfer_stats_t *stats) {
+    stats->duration_us = (uint32_t)(esp_timer_get_time() - mark->start_us);
+    stats->transactions = spi_transactions - mark->transactions;
+    stats->bytes = spi_bytes - mark->bytes;
+}
+
 void epaper_send_data(uint8_t data) {
     gpio_set_level(PIN_NUM_DC, 1); // Data mode
     spi_transaction_t t = {
         .length = 8,
         .tx_buffer = &data,
     };
-    spi_device_polling_transmit(spi_device, &t);
+    epaper_spi_transmit(&t);
 }
 
 void epaper_clearDisplay(void)
@@ -80,44 +185,74 @@ void epaper_DCDC_powerOff(void)
   epaper_waitBusy();
 }
 
-void epaper_send_color(uint8_t index, const uint8_t data, uint32_t len)
+// Stream 'len' copies of 'pattern' after command 'index', FILL_CHUNK bytes per transaction
+static void epaper_send_pattern(uint8_t index, uint8_t pattern, uint32_t len)
 {
+    if (fill_buffer == NULL) {
+        fill_buffer = (uint8_t*)heap_caps_malloc(FILL_CHUNK, MALLOC_CAP_DMA);
+        if (fill_buffer == NULL) {
+            ESP_LOGE("epaper", "Failed to allocate fill buffer");
+            return;
+        }
+        fill_pattern = -1;
+    }
+    if (fill_pattern != pattern) {
+        memset(fill_buffer, pattern, FILL_CHUNK);
+        fill_pattern = pattern;
+    }
+
+    shadow_invalidate();
     epaper_send_command(index);
     gpio_set_level(PIN_NUM_DC, 1); // Data mode
-    gpio_set_level(PIN_NUM_CS, 0); // Select
-    // Send the same byte 'data' for 'len' times
-    for (uint32_t i = 0; i < len / 8; i++) {
-        spi_transaction_t t = {
-            .length = 8, // 1 byte = 8 bits
-            .tx_buffer = &data,
-        };
-        spi_device_polling_transmit(spi_device, &t);
-        // Yield every 1024 bytes to avoid watchdog reset
-        if ((i % 1024) == 0) {
-            vTaskDelay(1);
-        }
+    while (len > 0) {
+        uint32_t chunk = (len > FILL_CHUNK) ? FILL_CHUNK : len;
+        epaper_send_buffer(fill_buffer, chunk);
+        len -= chunk;
     }
-    gpio_set_level(PIN_NUM_CS, 1); // Deselect
+}
+
+static void epaper_log_fill_stats(void)
+{
+    uint32_t kbps = fill_stats.duration_us ? (uint32_t)((uint64_t)fill_stats.bytes * 1000 / fill_stats.duration_us) : 0;
+    ESP_LOGI("epaper", "Fill: %lu bytes in %lu SPI transactions, %lu us (%lu KB/s)",
+             (unsigned long)fill_stats.bytes, (unsigned long)fill_stats.transactions,
+             (unsigned long)fill_stats.duration_us, (unsigned long)kbps);
+}
+
+// Send the same byte 'data' to RAM 'index' for 'len' bytes
+void epaper_send_color(uint8_t index, const uint8_t data, uint32_t len)
+{
+    stats_mark_t mark;
+    stats_mark(&mark);
+    epaper_send_pattern(index, data, len);
+    stats_finish(&mark, &fill_stats);
+    epaper_log_fill_stats();
 }
 
 void epaper_fill(uint8_t color)
 {
     uint8_t bw = epaper_color_bw(color), red = epaper_color_red(color);
+    stats_mark_t mark;
+    stats_mark(&mark);
 
     // Fill BW channel (0x13) FIRST
-    epaper_send_command(0x13);
-    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
-        epaper_send_data(bw);
-    }
+    epaper_send_pattern(0x13, bw, BUFFER_SIZE);
     // Fill RED channel (0x10) SECOND
-    epaper_send_command(0x10);
-    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
-        epaper_send_data(red);
-    }
+    epaper_send_pattern(0x10, red, BUFFER_SIZE);
+
+    stats_finish(&mark, &fill_stats);
+    epaper_log_fill_stats();
+
     // Refresh display (stub)
     epaper_send_command(0x12);
 }
 
+void epaper_get_fill_stats(epaper_transfer_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = fill_stats;
+    }
+}
+
 void epaper_set_bw_mode(uint8_t bw_only)
 {
     uint8_t psr_data[2];
@@ -132,6 +267,13 @@ void epaper_set_bw_mode(uint8_t bw_only)
     epaper_sendIndexData(0x00, psr_data, 2);
 }
 
+static void IRAM_ATTR epaper_busy_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(busy_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
 void epaper_init()
 {
     // Configure DC, RST, BUSY pins as GPIO
@@ -145,8 +287,17 @@ void epaper_init()
     gpio_config(&io_conf);
     io_conf.mode = GPIO_MODE_INPUT;
     io_conf.pin_bit_mask = (1ULL << PIN_NUM_BUSY);
+    io_conf.intr_type = GPIO_INTR_NEGEDGE; // BUSY released
     gpio_config(&io_conf);
 
+    // Wake epaper_waitBusy() from the BUSY edge instead of polling
+    busy_sem = xSemaphoreCreateBinary();
+    esp_err_t isr_ret = gpio_install_isr_service(0);
+    if (isr_ret != ESP_OK && isr_ret != ESP_ERR_INVALID_STATE) { // already installed is fine
+        ESP_LOGE("epaper", "GPIO ISR service install failed: %d", isr_ret);
+    }
+    gpio_isr_handler_add(PIN_NUM_BUSY, epaper_busy_isr, NULL);
+
     vTaskDelay(pdMS_TO_TICKS(1000)); // Wait for power to stabilize
 
     // Initialize SPI (call only once)
@@ -186,19 +337,103 @@ void epaper_reset(uint32_t ms1, uint32_t ms2, uint32_t ms3, uint32_t ms4, uint32
   vTaskDelay(pdMS_TO_TICKS(ms5));
 }
 
+static uint8_t busy_slot(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x04: return 0; // Power on
+        case 0x02: return 1; // Power off
+        case 0x12: return 2; // Display refresh
+        default:   return BUSY_SLOT_OTHER;
+    }
+}
+
+// The command did not raise BUSY in time: either it needs no wait or the
+// controller is late, and then the next command may arrive while it is busy.
+// Power and refresh commands always raise it, so for them this is worth a warning.
+static void busy_missed(uint8_t cmd)
+{
+    busy_stats[busy_slot(cmd)].missed++;
+    if (busy_slot(cmd) != BUSY_SLOT_OTHER) {
+        ESP_LOGW("epaper", "BUSY did not rise within %d us after 0x%02x", BUSY_ASSERT_US, cmd);
+    } else {
+        ESP_LOGD("epaper", "BUSY did not rise within %d us after 0x%02x", BUSY_ASSERT_US, cmd);
+    }
+}
+
+static void busy_record(uint8_t cmd, uint32_t duration_us, bool timed_out)
+{
+    epaper_busy_stats_t *st = &busy_stats[busy_slot(cmd)];
+    uint32_t ms = duration_us / 1000;
+    uint8_t bucket = 0;
+    while (ms > 0 && bucket < EPAPER_BUSY_HIST_BUCKETS - 1) {
+        ms >>= 1;
+        bucket++;
+    }
+    st->count++;
+    st->timeouts += timed_out ? 1 : 0;
+    st->last_us = duration_us;
+    st->total_us += duration_us;
+    if (duration_us > st->max_us) {
+        st->max_us = duration_us;
+    }
+    st->buckets[bucket]++;
+    ESP_LOGD("epaper", "BUSY after 0x%02x: %lu us%s", cmd, (unsigned long)duration_us, timed_out ? " (timeout)" : "");
+}
+
 void epaper_waitBusy(void)
 {
-    int timeout = 5000; // 5000 x 2ms = 10s max wait
     // NOTE: Some displays use BUSY=1 when busy, others BUSY=0. Adjust logic if needed!
-    do {
-        vTaskDelay(pdMS_TO_TICKS(2));
-        timeout--;
-        if (timeout <= 0) {
-            ESP_LOGE("epaper", "BUSY pin timeout!");
+    int64_t start_us = esp_timer_get_time();
+    int64_t deadline_us = start_us + (int64_t)busy_timeout_ms * 1000;
+    bool timed_out = false;
+
+    // BUSY rises shortly after the command; if the edge already came, it is done.
+    // Usually it is up within microseconds, a late controller is waited for asleep.
+    while (gpio_get_level(PIN_NUM_BUSY) == 0) {
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        if (elapsed_us >= BUSY_ASSERT_US) {
+            busy_missed(busy_cmd);
+            return;
+        }
+        TickType_t wait = elapsed_us < BUSY_SPIN_US ? 0 : 1;
+        if (busy_sem != NULL && xSemaphoreTake(busy_sem, wait) == pdTRUE) {
+            busy_record(busy_cmd, (uint32_t)(esp_timer_get_time() - start_us), false);
+            return;
+        }
+        if (wait == 0) {
+            esp_rom_delay_us(BUSY_POLL_US);
+        } else if (busy_sem == NULL) {
+            vTaskDelay(1);
+        }
+    }
+
+    // Sleep until the falling edge (or the timeout)
+    while (gpio_get_level(PIN_NUM_BUSY) == 1) {
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            ESP_LOGE("epaper", "BUSY pin timeout after 0x%02x!", busy_cmd);
+            timed_out = true;
             break;
         }
-    } while (gpio_get_level(PIN_NUM_BUSY) == 1);
-    vTaskDelay(pdMS_TO_TICKS(200));
+        if (busy_sem != NULL) {
+            xSemaphoreTake(busy_sem, pdMS_TO_TICKS(remaining_us / 1000) + 1);
+        } else {
+            vTaskDelay(1);
+        }
+    }
+    busy_record(busy_cmd, (uint32_t)(esp_timer_get_time() - start_us), timed_out);
+}
+
+void epaper_set_busy_timeout(uint32_t timeout_ms)
+{
+    busy_timeout_ms = timeout_ms;
+}
+
+void epaper_get_busy_stats(uint8_t cmd, epaper_busy_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = busy_stats[busy_slot(cmd)];
+    }
 }
 
 void epaper_softReset(void)
@@ -236,7 +471,7 @@ void epaper_sendIndexData(uint8_t index, const uint8_t *data, uint32_t len)
             .length = len * 8, // length in bits
             .tx_buffer = data,
         };
-        esp_err_t error = spi_device_polling_transmit(spi_device, &t);
+        esp_err_t error = epaper_spi_transmit(&t);
         if (error != ESP_OK) {
             ESP_LOGE("epaper", "SPI transmit error: %d", error);
         }
@@ -246,20 +481,24 @@ void epaper_sendIndexData(uint8_t index, const uint8_t *data, uint32_t len)
 
 void epaper_send_command(uint8_t cmd)
 {
+    // Any BUSY edge seen so far belongs to an earlier command
+    busy_cmd = cmd;
+    if (busy_sem != NULL) {
+        xSemaphoreTake(busy_sem, 0);
+    }
     gpio_set_level(PIN_NUM_DC, 0); // Command mode
     gpio_set_level(PIN_NUM_CS, 0); // Select
     spi_transaction_t t = {
         .length = 8,
         .tx_buffer = &cmd,
     };
-    esp_err_t error = spi_device_polling_transmit(spi_device, &t);
+    esp_err_t error = epaper_spi_transmit(&t);
     if (error != ESP_OK) {
         ESP_LOGE("epaper", "SPI transmit error: %d", error);
     }
   gpio_set_level(PIN_NUM_CS, 1); // Deselect
 }
 
-#define MAX_SPI_CHUNK 4096
 void epaper_send_buffer(const uint8_t *buffer, size_t length) {
     size_t offset = 0;
     while (offset < length) {
@@ -268,7 +507,7 @@ void epaper_send_buffer(const uint8_t *buffer, size_t length) {
             .length = chunk * 8, // bits
             .tx_buffer = buffer + offset,
         };
-        esp_err_t ret = spi_device_polling_transmit(spi_device, &t);
+        esp_err_t ret = epaper_spi_transmit(&t);
         if (ret != ESP_OK) {
             ESP_LOGE("epaper", "SPI transmit error: %d", ret);
             break;
@@ -282,34 +521,364 @@ void epaper_send_buffer(const uint8_t *buffer, size_t length) {
     }
 }
 
-void epaper_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t color) {
-    epaper_DCDC_powerOn();
+// Send a whole plane after its command: buffer must live in DMA-capable memory
+void epaper_send_plane(uint8_t index, const uint8_t *buffer, size_t length) {
+    shadow_invalidate();
+    epaper_send_command(index);
+    gpio_set_level(PIN_NUM_DC, 1); // Data mode
+    epaper_send_buffer(buffer, length);
+}
 
-    uint8_t bw = epaper_color_bw(color), red = epaper_color_red(color);
-    epaper_send_color(0x10, bw, BUFFER_SIZE);
-    epaper_send_color(0x13, red, BUFFER_SIZE);
+void epaper_set_bulk_transfer(uint8_t enable) {
+    bulk_transfer = enable ? 1 : 0;
+    ESP_LOGI("epaper", "Bulk plane transfer %s", bulk_transfer ? "enabled" : "disabled");
+}
 
-    epaper_send_command(0x12);
+void epaper_get_frame_stats(epaper_transfer_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = frame_stats;
+    }
+}
 
-    epaper_waitBusy();
-    epaper_DCDC_powerOff();
+// ========== Asynchronous transport ==========
+
+void epaper_async_begin(void) {
+    // Only one sequence in flight: finish the previous one first
+    epaper_async_wait(0);
+    async_count = 0;
+}
+
+static esp_err_t epaper_async_append(uintptr_t flags, const uint8_t *data, size_t len) {
+    if (async_count >= EPAPER_SPI_QUEUE_SIZE) {
+        ESP_LOGE("epaper", "Async sequence too long (max %d transactions)", EPAPER_SPI_QUEUE_SIZE);
+        return ESP_ERR_NO_MEM;
+    }
+    spi_transaction_t *t = &async_txn[async_count++];
+    memset(t, 0, sizeof(*t));
+    t->length = len * 8;
+    t->user = (void *)(flags | EPAPER_TXN_DC_SET);
+    if (len <= sizeof(t->tx_data)) {
+        // Short payloads are copied, so the caller's buffer may go away
+        t->flags = SPI_TRANS_USE_TXDATA;
+        memcpy(t->tx_data, data, len);
+    } else {
+        t->tx_buffer = data;
+    }
+    return ESP_OK;
+}
+
+esp_err_t epaper_async_command(uint8_t cmd) {
+    // Like epaper_send_command(): the next BUSY period is this command's
+    busy_cmd = cmd;
+    if (busy_sem != NULL) {
+        xSemaphoreTake(busy_sem, 0);
+    }
+    return epaper_async_append(0, &cmd, 1);
+}
+
+esp_err_t epaper_async_data(const uint8_t *data, size_t len) {
+    size_t offset = 0;
+    while (offset < len) {
+        size_t chunk = (len - offset > MAX_SPI_CHUNK) ? MAX_SPI_CHUNK : (len - offset);
+        esp_err_t ret = epaper_async_append(EPAPER_TXN_DC_DATA, data + offset, chunk);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        offset += chunk;
+    }
+    return ESP_OK;
+}
+
+esp_err_t epaper_async_submit(void) {
+    if (async_count == 0) {
+        return ESP_OK;
+    }
+
+    async_txn[async_count - 1].user =
+        (void *)((uintptr_t)async_txn[async_count - 1].user | EPAPER_TXN_LAST);
+    xSemaphoreTake(async_done, 0); // Drop any stale completion
+
+    stats_mark(&async_mark);
+
+    for (uint8_t i = 0; i < async_count; i++) {
+        esp_err_t ret = spi_device_queue_trans(spi_device, &async_txn[i], portMAX_DELAY);
+        if (ret != ESP_OK) {
+            ESP_LOGE("epaper", "SPI queue error: %d", ret);
+            // Make sure a waiter still wakes up for what did get queued
+            if (i > 0) {
+                async_txn[i - 1].user = (void *)((uintptr_t)async_txn[i - 1].user | EPAPER_TXN_LAST);
+            }
+            async_count = 0;
+            return ret;
+        }
+        async_inflight++;
+        spi_transactions++;
+        spi_bytes += async_txn[i].length / 8;
+    }
+    async_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t epaper_async_wait(uint32_t timeout_ms) {
+    if (async_inflight == 0) {
+        return ESP_OK;
+    }
+
+    TickType_t ticks = (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (xSemaphoreTake(async_done, ticks) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Reap every finished transaction so the queue slots are free again
+    while (async_inflight > 0) {
+        spi_transaction_t *done;
+        spi_device_get_trans_result(spi_device, &done, portMAX_DELAY);
+        async_inflight--;
+    }
+
+    stats_finish(&async_mark, &frame_stats);
+    return ESP_OK;
 }
 
+bool epaper_async_busy(void) {
+    return async_inflight > 0;
+}
 
 // Static framebuffers for display content
 static uint8_t *framebuffer_bw = NULL;
 static uint8_t *framebuffer_red = NULL;
 
+// Planes drawing goes to: the framebuffers, or those of the selected layer
+static uint8_t *draw_bw = NULL;
+static uint8_t *draw_red = NULL;
+
 // Global screen orientation (default: 0°)
 static uint8_t screen_orientation = ORIENTATION_0;
 
-// Forward declaration for coordinate transformation
-static inline void transform_coordinates(uint16_t x, uint16_t y, uint8_t orientation, uint16_t *out_x, uint16_t *out_y);
+// Framebuffer layout. The framebuffers hold panel rows, or with native
+// orientation (default) the logical rows of a 90°/270° screen, 296 pixels wide,
+// so drawing in those orientations stays byte-contiguous as well. They are
+// rotated into panel order once per flush, while the snapshot for the transfer
+// is taken. Drawing works in framebuffer coordinates (called panel coordinates
+// below): logical coordinates are rotated by draw_rotation, framebuffer
+// coordinates by fb_rotation on their way to the panel.
+static uint8_t native_orientation = 1;
+static uint8_t fb_rotation = ORIENTATION_0;
+static uint8_t draw_rotation = ORIENTATION_0;
+static int16_t fb_width = SCREEN_2_6_WIDTH;
+static int16_t fb_height = SCREEN_2_6_HEIGHT;
+static uint16_t fb_stride = BYTES_PER_ROW;
+
+// Changed rectangle (inclusive)
+typedef struct {
+    bool valid;
+    int16_t x0, y0, x1, y1;
+} region_t;
+
+// Region drawn since the last update, in panel coordinates
+static region_t dirty = {0};
+
+// Drawing clip (epaper_set_clip()), logical coordinates
+static region_t draw_clip = {0};
+
+// Layers (see epaper_layer_select()): planes in the framebuffer layout, one
+// allocation each. Overlay pixels with both bits set are transparent, a
+// combination no color uses. Changes since the last composite are kept in
+// framebuffer coordinates.
+typedef struct {
+    uint8_t *bw, *red;
+    region_t changed;
+} layer_t;
+
+static layer_t layers[EPAPER_LAYER_COUNT];
+static uint8_t layer_current = EPAPER_LAYER_NONE;
+
+// Copy of what the controller RAM holds, to skip or shrink refreshes that change nothing
+static uint8_t *shadow_bw = NULL;
+static uint8_t *shadow_red = NULL;
+static bool shadow_valid = false;
+static epaper_refresh_stats_t refresh_stats = {0};
+
+// Snapshot waiting in the transfer buffers (see flush_prepare())
+static bool flush_pending = false;
+static bool flush_partial = false;
+static uint16_t flush_xb0, flush_xb1;
+static int16_t flush_y0, flush_y1;
+
+// Automatic partial refresh, used while the dirty region stays below this share of the screen
+static uint8_t partial_refresh = 1;
+#define PARTIAL_MAX_PERCENT 50
+
+// Rotate a rectangle clockwise into a space of dst_w x dst_h pixels (inclusive, unclipped).
+// Logical coordinates reach the panel as: 90° px = 151 - y, py = x; 270° px = y, py = 295 - x.
+static void rotate_rect(uint8_t rotation, int32_t dst_w, int32_t dst_h, int32_t x, int32_t y, int32_t w, int32_t h,
+                        int32_t *px0, int32_t *py0, int32_t *px1, int32_t *py1) {
+    int32_t ax = x, ay = y, bx = x + w - 1, by = y + h - 1;
+    int32_t x0, y0, x1, y1;
+    switch (rotation) {
+        case ORIENTATION_90:
+            x0 = dst_w - 1 - by; x1 = dst_w - 1 - ay;
+            y0 = ax; y1 = bx;
+            break;
+        case ORIENTATION_180:
+            x0 = dst_w - 1 - bx; x1 = dst_w - 1 - ax;
+            y0 = dst_h - 1 - by; y1 = dst_h - 1 - ay;
+            break;
+        case ORIENTATION_270:
+            x0 = ay; x1 = by;
+            y0 = dst_h - 1 - bx; y1 = dst_h - 1 - ax;
+            break;
+        default:
+            x0 = ax; x1 = bx; y0 = ay; y1 = by;
+            break;
+    }
+    *px0 = x0; *py0 = y0; *px1 = x1; *py1 = y1;
+}
+
+// Map a logical rectangle to the framebuffer (inclusive, unclipped)
+static void logical_to_fb(int32_t x, int32_t y, int32_t w, int32_t h,
+                          int32_t *px0, int32_t *py0, int32_t *px1, int32_t *py1) {
+    rotate_rect(draw_rotation, fb_width, fb_height, x, y, w, h, px0, py0, px1, py1);
+}
+
+// Map a logical rectangle to the framebuffer and clip it to the screen.
+// Returns false when nothing is left on screen.
+static bool transform_rect(int32_t x, int32_t y, int32_t w, int32_t h,
+                           int16_t *px0, int16_t *py0, int16_t *px1, int16_t *py1) {
+    if (draw_clip.valid) {
+        int32_t cx1 = x + w - 1, cy1 = y + h - 1;
+        if (x < draw_clip.x0) x = draw_clip.x0;
+        if (y < draw_clip.y0) y = draw_clip.y0;
+        if (cx1 > draw_clip.x1) cx1 = draw_clip.x1;
+        if (cy1 > draw_clip.y1) cy1 = draw_clip.y1;
+        w = cx1 - x + 1;
+        h = cy1 - y + 1;
+    }
+    if (w <= 0 || h <= 0) {
+        return false;
+    }
+    int32_t x0, y0, x1, y1;
+    logical_to_fb(x, y, w, h, &x0, &y0, &x1, &y1);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > fb_width - 1) x1 = fb_width - 1;
+    if (y1 > fb_height - 1) y1 = fb_height - 1;
+    if (x0 > x1 || y0 > y1) {
+        return false;
+    }
+    *px0 = x0; *py0 = y0; *px1 = x1; *py1 = y1;
+    return true;
+}
+
+static void shadow_invalidate(void) {
+    shadow_valid = false;
+}
+
+// Record the transfer snapshot (packed rows) of panel rows y0..y1, byte columns xb0..xb1
+static void shadow_store(uint16_t xb0, uint16_t xb1, int16_t y0, int16_t y1) {
+    if (shadow_bw == NULL) {
+        shadow_bw = (uint8_t*)malloc(BUFFER_SIZE);
+        shadow_red = (uint8_t*)malloc(BUFFER_SIZE);
+        if (shadow_bw == NULL || shadow_red == NULL) {
+            ESP_LOGW("epaper", "No memory for shadow frame, refresh diffing disabled");
+            free(shadow_bw);
+            free(shadow_red);
+            shadow_bw = shadow_red = NULL;
+            return;
+        }
+    }
+    uint16_t row_bytes = xb1 - xb0 + 1;
+    for (int16_t r = 0; r <= y1 - y0; r++) {
+        size_t off = (size_t)(y0 + r) * BYTES_PER_ROW + xb0;
+        memcpy(shadow_bw + off, tx_bw + (size_t)r * row_bytes, row_bytes);
+        memcpy(shadow_red + off, tx_red + (size_t)r * row_bytes, row_bytes);
+    }
+}
+
+// Compare a frame in panel order with the shadow frame. Returns false when they
+// match, otherwise the changed area as a byte-aligned panel rectangle (inclusive).
+static bool shadow_diff(const uint8_t *frame_bw, const uint8_t *frame_red,
+                        int16_t *x0, int16_t *y0, int16_t *x1, int16_t *y1) {
+    int16_t row_min = -1, row_max = -1;
+    int16_t byte_min = BYTES_PER_ROW, byte_max = -1;
+
+    for (int16_t row = 0; row < SCREEN_2_6_HEIGHT; row++) {
+        size_t off = (size_t)row * BYTES_PER_ROW;
+        const uint8_t *bw = frame_bw + off, *red = frame_red + off;
+        const uint8_t *old_bw = shadow_bw + off, *old_red = shadow_red + off;
+        if (memcmp(bw, old_bw, BYTES_PER_ROW) == 0 && memcmp(red, old_red, BYTES_PER_ROW) == 0) {
+            continue;
+        }
+        for (int16_t i = 0; i < BYTES_PER_ROW; i++) {
+            if (bw[i] != old_bw[i] || red[i] != old_red[i]) {
+                if (i < byte_min) byte_min = i;
+                if (i > byte_max) byte_max = i;
+            }
+        }
+        if (row_min < 0) row_min = row;
+        row_max = row;
+    }
+    if (row_min < 0) {
+        return false;
+    }
+    *x0 = byte_min * 8;
+    *x1 = byte_max * 8 + 7;
+    *y0 = row_min;
+    *y1 = row_max;
+    return true;
+}
+
+static bool is_partial_size(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    uint32_t area = (uint32_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    uint32_t screen = (uint32_t)SCREEN_2_6_WIDTH * SCREEN_2_6_HEIGHT;
+    return partial_refresh && area * 100 < screen * PARTIAL_MAX_PERCENT;
+}
+
+static void region_add(region_t *r, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if (!r->valid) {
+        r->x0 = x0; r->y0 = y0; r->x1 = x1; r->y1 = y1;
+        r->valid = true;
+        return;
+    }
+    if (x0 < r->x0) r->x0 = x0;
+    if (y0 < r->y0) r->y0 = y0;
+    if (x1 > r->x1) r->x1 = x1;
+    if (y1 > r->y1) r->y1 = y1;
+}
+
+// Record a changed rectangle of the framebuffers (inclusive) for the next update
+static void frame_dirty_add(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if (fb_rotation != ORIENTATION_0) {
+        int32_t px0, py0, px1, py1;
+        rotate_rect(fb_rotation, SCREEN_2_6_WIDTH, SCREEN_2_6_HEIGHT, x0, y0, x1 - x0 + 1, y1 - y0 + 1,
+                    &px0, &py0, &px1, &py1);
+        x0 = px0; y0 = py0; x1 = px1; y1 = py1;
+    }
+    region_add(&dirty, x0, y0, x1, y1);
+}
+
+// Record a drawn rectangle (framebuffer coordinates, inclusive). In a layer it
+// reaches the framebuffers, and the update, with the next composite.
+static void dirty_add(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if (layer_current != EPAPER_LAYER_NONE) {
+        region_add(&layers[layer_current].changed, x0, y0, x1, y1);
+    } else {
+        frame_dirty_add(x0, y0, x1, y1);
+    }
+}
+
+// Mark a logical rectangle (current orientation) as changed
+static void dirty_add_logical(int32_t x, int32_t y, int32_t w, int32_t h) {
+    int16_t x0, y0, x1, y1;
+    if (transform_rect(x, y, w, h, &x0, &y0, &x1, &y1)) {
+        dirty_add(x0, y0, x1, y1);
+    }
+}
 
 // Initialize framebuffers (call once)
 static void epaper_framebuffer_init(void) {
     if (framebuffer_bw == NULL) {
-        framebuffer_bw = (uint8_t*)malloc(BUFFER_SIZE);
+        framebuffer_bw = (uint8_t*)heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DMA);
         if (framebuffer_bw == NULL) {
             ESP_LOGE("epaper", "Failed to allocate BW framebuffer");
             return;
@@ -319,7 +888,7 @@ static void epaper_framebuffer_init(void) {
     }
 
     if (framebuffer_red == NULL) {
-        framebuffer_red = (uint8_t*)malloc(BUFFER_SIZE);
+        framebuffer_red = (uint8_t*)heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DMA);
         if (framebuffer_red == NULL) {
             ESP_LOGE("epaper", "Failed to allocate RED framebuffer");
             return;
@@ -327,52 +896,220 @@ static void epaper_framebuffer_init(void) {
         memset(framebuffer_red, 0x00, BUFFER_SIZE);
         ESP_LOGI("epaper", "Allocated RED framebuffer: %d bytes", BUFFER_SIZE);
     }
+
+    if (draw_bw == NULL) {
+        draw_bw = framebuffer_bw;
+        draw_red = framebuffer_red;
+    }
+}
+
+// ========== Framebuffer layout ==========
+
+// Transpose an 8x8 bit block: row i of dst takes column i of src (MSB = column 0).
+// Rows are step bytes apart, a negative step walks the block bottom-up.
+static void transpose8(const uint8_t *src, int32_t src_step, uint8_t *dst, int32_t dst_step) {
+    uint32_t x = (uint32_t)src[0] << 24 | (uint32_t)src[src_step] << 16 |
+                 (uint32_t)src[2 * src_step] << 8 | src[3 * src_step];
+    uint32_t y = (uint32_t)src[4 * src_step] << 24 | (uint32_t)src[5 * src_step] << 16 |
+                 (uint32_t)src[6 * src_step] << 8 | src[7 * src_step];
+    uint32_t t;
+
+    // Swap the 1x1, then the 2x2 bit blocks across the diagonal of each 4x4 half,
+    // then the 4x4 blocks between the halves (Hacker's Delight, transpose8rS32)
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x ^= t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x ^= t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y ^= t ^ (t << 14);
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    dst[0] = x >> 24; dst[dst_step] = x >> 16; dst[2 * dst_step] = x >> 8; dst[3 * dst_step] = x;
+    dst[4 * dst_step] = y >> 24; dst[5 * dst_step] = y >> 16; dst[6 * dst_step] = y >> 8; dst[7 * dst_step] = y;
+}
+
+// Rotate a plane from the native layout of rotation (90° or 270°) into panel
+// order, or back. Panel rows 8a..8a+7 of byte column b are one block of native
+// byte column a (37 of them), flipped on the way by walking one side bottom-up.
+static void plane_transpose(const uint8_t *from, uint8_t *to, uint8_t rotation, bool to_panel) {
+    const int32_t native_stride = SCREEN_2_6_HEIGHT / 8;
+    for (int32_t a = 0; a < SCREEN_2_6_HEIGHT / 8; a++) {
+        for (int32_t b = 0; b < BYTES_PER_ROW; b++) {
+            size_t native, panel;
+            int32_t native_step, panel_step;
+            if (rotation == ORIENTATION_90) {
+                // px = 151 - ly, py = lx
+                native = (size_t)(SCREEN_2_6_WIDTH - 1 - 8 * b) * native_stride + a;
+                native_step = -native_stride;
+                panel = (size_t)(8 * a) * BYTES_PER_ROW + b;
+                panel_step = BYTES_PER_ROW;
+            } else {
+                // px = ly, py = 295 - lx
+                native = (size_t)(8 * b) * native_stride + (native_stride - 1 - a);
+                native_step = native_stride;
+                panel = (size_t)(8 * a + 7) * BYTES_PER_ROW + b;
+                panel_step = -BYTES_PER_ROW;
+            }
+            if (to_panel) {
+                transpose8(from + native, native_step, to + panel, panel_step);
+            } else {
+                transpose8(from + panel, panel_step, to + native, native_step);
+            }
+        }
+    }
+}
+
+// Switch the framebuffers to the layout of rotation (ORIENTATION_0 = panel
+// order), converting what they hold when keep is set. Returns false when out
+// of memory, the layout then stays as it was.
+static bool framebuffer_set_layout(uint8_t rotation, bool keep) {
+    bool ok = true;
+    if (rotation != fb_rotation && keep) {
+        uint8_t *tmp = (uint8_t*)malloc(BUFFER_SIZE);
+        if (tmp == NULL) {
+            ESP_LOGW("epaper", "No memory to change the framebuffer layout");
+            ok = false;
+        } else {
+            uint8_t *planes[2 + 2 * EPAPER_LAYER_COUNT] = { framebuffer_bw, framebuffer_red };
+            int count = 2;
+            for (int l = 0; l < EPAPER_LAYER_COUNT; l++) {
+                if (layers[l].bw != NULL) {
+                    planes[count++] = layers[l].bw;
+                    planes[count++] = layers[l].red;
+                }
+            }
+            for (int i = 0; i < count; i++) {
+                if (fb_rotation != ORIENTATION_0) {
+                    plane_transpose(planes[i], tmp, fb_rotation, true);
+                    memcpy(planes[i], tmp, BUFFER_SIZE);
+                }
+                if (rotation != ORIENTATION_0) {
+                    plane_transpose(planes[i], tmp, rotation, false);
+                    memcpy(planes[i], tmp, BUFFER_SIZE);
+                }
+            }
+            free(tmp);
+        }
+    }
+    if (ok) {
+        fb_rotation = rotation;
+        fb_width = rotation != ORIENTATION_0 ? SCREEN_2_6_HEIGHT : SCREEN_2_6_WIDTH;
+        fb_height = rotation != ORIENTATION_0 ? SCREEN_2_6_WIDTH : SCREEN_2_6_HEIGHT;
+        fb_stride = fb_width / 8;
+        // Pending layer changes are in the old coordinates: composite all of them
+        for (int l = 0; l < EPAPER_LAYER_COUNT; l++) {
+            if (layers[l].changed.valid) {
+                layers[l].changed = (region_t){ true, 0, 0, fb_width - 1, fb_height - 1 };
+            }
+        }
+    }
+    // Logical to framebuffer is whatever rotation is left after the layout's
+    draw_rotation = (screen_orientation - fb_rotation) & 3;
+    return ok;
+}
+
+// Layout for drawing in the current orientation
+static uint8_t layout_wanted(void) {
+    bool landscape = screen_orientation == ORIENTATION_90 || screen_orientation == ORIENTATION_270;
+    return native_orientation && landscape ? screen_orientation : ORIENTATION_0;
+}
+
+static void layout_sync(void) {
+    framebuffer_set_layout(layout_wanted(), framebuffer_bw != NULL && framebuffer_red != NULL);
 }
 
 // Helper function: draw a single pixel directly without orientation (for internal use)
 static inline void epaper_draw_pixel_direct(uint16_t x, uint16_t y, uint8_t color) {
     // Check bounds
-    if (x >= SCREEN_2_6_WIDTH || y >= SCREEN_2_6_HEIGHT) {
+    if (x >= fb_width || y >= fb_height) {
         return;
     }
 
     // Calculate framebuffer position
-    uint16_t byte_idx = y * BYTES_PER_ROW + (x / 8);
+    uint16_t byte_idx = y * fb_stride + (x / 8);
     uint8_t bit_mask = 0x80 >> (x % 8);
 
     uint8_t bw = epaper_color_bw(color);
     uint8_t red = epaper_color_red(color);
 
     if (bw) {
-        framebuffer_bw[byte_idx] |= bit_mask;
+        draw_bw[byte_idx] |= bit_mask;
     } else {
-        framebuffer_bw[byte_idx] &= ~bit_mask;
+        draw_bw[byte_idx] &= ~bit_mask;
     }
 
     if (red) {
-        framebuffer_red[byte_idx] |= bit_mask;
+        draw_red[byte_idx] |= bit_mask;
     } else {
-        framebuffer_red[byte_idx] &= ~bit_mask;
+        draw_red[byte_idx] &= ~bit_mask;
     }
 }
 
 // Helper function: draw a single pixel with orientation support
 static inline void epaper_draw_pixel(uint16_t x, uint16_t y, uint8_t color) {
     // Apply orientation transformation
-    uint16_t out_x, out_y;
-    transform_coordinates(x, y, screen_orientation, &out_x, &out_y);
+    int32_t out_x, out_y, unused_x, unused_y;
+    logical_to_fb(x, y, 1, 1, &out_x, &out_y, &unused_x, &unused_y);
     epaper_draw_pixel_direct(out_x, out_y, color);
 }
 
-// Draw rectangle (uses global orientation)
-void epaper_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color) {
-    epaper_framebuffer_init();
+// Fill a clipped panel rectangle (inclusive) on both planes: whole bytes per
+// row, only the edge bytes are masked
+static void fill_panel_rect(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color) {
+    uint8_t bw = epaper_color_bw(color);
+    uint8_t red = epaper_color_red(color);
+    uint16_t xb0 = x0 / 8, xb1 = x1 / 8;
+    uint8_t left = 0xFF >> (x0 % 8);
+    uint8_t right = 0xFF << (7 - x1 % 8);
+    if (xb0 == xb1) {
+        left &= right;
+    }
+    uint16_t inner = (xb1 > xb0) ? xb1 - xb0 - 1 : 0;
+
+    for (int16_t row = y0; row <= y1; row++) {
+        uint8_t *pb = draw_bw + (size_t)row * fb_stride;
+        uint8_t *pr = draw_red + (size_t)row * fb_stride;
+        pb[xb0] = (pb[xb0] & ~left) | (bw & left);
+        pr[xb0] = (pr[xb0] & ~left) | (red & left);
+        if (xb1 > xb0) {
+            memset(pb + xb0 + 1, bw, inner);
+            memset(pr + xb0 + 1, red, inner);
+            pb[xb1] = (pb[xb1] & ~right) | (bw & right);
+            pr[xb1] = (pr[xb1] & ~right) | (red & right);
+        }
+    }
+}
 
-    for (uint16_t row = 0; row < h; row++) {
-        for (uint16_t col = 0; col < w; col++) {
-            epaper_draw_pixel(x + col, y + row, color);
+static bool framebuffer_ready(void) {
+    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+        epaper_framebuffer_init();
+        if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+            return false;
         }
     }
+    // Back to the native layout after a bitmap upload
+    if (fb_rotation != layout_wanted()) {
+        layout_sync();
+    }
+    return true;
+}
+
+// Fill a logical rectangle (current orientation): clip and rotate once, then fill spans
+static void fill_logical_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t color) {
+    int16_t x0, y0, x1, y1;
+    if (!transform_rect(x, y, w, h, &x0, &y0, &x1, &y1)) {
+        return;
+    }
+    dirty_add(x0, y0, x1, y1);
+    fill_panel_rect(x0, y0, x1, y1, color);
+}
+
+// Draw rectangle (uses global orientation)
+void epaper_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    fill_logical_rect(x, y, w, h, color);
 }
 
 void test_rect() {
@@ -389,66 +1126,953 @@ void test_rect() {
     epaper_display_update();
 }
 
-// Send framebuffer to display and refresh (call after drawing operations)
-void epaper_display_update(void) {
-    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
-        ESP_LOGE("epaper", "Framebuffers not initialized");
-        return;
+// ========== Vector primitives ==========
+// Shapes are rasterized in logical coordinates (current orientation) into
+// horizontal or vertical runs, each filled as a rectangle. Every shape is
+// clipped to the logical screen once up front: lines by parameter range,
+// filled shapes by row range, so the inner loops never test bounds per pixel.
+
+#define SHAPE_NO_CLIP 0x20000  // Far outside any int16_t coordinate
+
+// A run of len pixels starting at (x, y), along x or along y when vertical
+typedef void (*shape_run_fn)(int32_t x, int32_t y, int32_t len, bool vertical, void *ctx);
+
+// The logical screen (inclusive): 296 pixels wide at 90° and 270°, within the clip
+static void logical_bounds(int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1) {
+    bool landscape = screen_orientation == ORIENTATION_90 || screen_orientation == ORIENTATION_270;
+    *x0 = 0; *x1 = (landscape ? SCREEN_2_6_HEIGHT : SCREEN_2_6_WIDTH) - 1;
+    *y0 = 0; *y1 = (landscape ? SCREEN_2_6_WIDTH : SCREEN_2_6_HEIGHT) - 1;
+    if (draw_clip.valid) {
+        if (draw_clip.x0 > *x0) *x0 = draw_clip.x0;
+        if (draw_clip.y0 > *y0) *y0 = draw_clip.y0;
+        if (draw_clip.x1 < *x1) *x1 = draw_clip.x1;
+        if (draw_clip.y1 < *y1) *y1 = draw_clip.y1;
     }
+}
 
-    ESP_LOGI("epaper", "Updating display from framebuffer...");
-
-    // Debug: print first few bytes to verify data
-    ESP_LOGI("epaper", "BW buffer first 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x",
-             framebuffer_bw[0], framebuffer_bw[1], framebuffer_bw[2], framebuffer_bw[3],
-             framebuffer_bw[4], framebuffer_bw[5], framebuffer_bw[6], framebuffer_bw[7]);
-    ESP_LOGI("epaper", "RED buffer first 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x",
-             framebuffer_red[0], framebuffer_red[1], framebuffer_red[2], framebuffer_red[3],
-             framebuffer_red[4], framebuffer_red[5], framebuffer_red[6], framebuffer_red[7]);
+void epaper_set_clip(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    draw_clip = (region_t){ true, x, y, x + w - 1, y + h - 1 };
+}
 
-    // Match epaper_fill() pattern which works
-    // Fill BW channel (0x13) FIRST
-    epaper_send_command(0x13);
-    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
-        epaper_send_data(framebuffer_red[i]);
-        // Yield every 1024 bytes to avoid watchdog
-        if ((i % 1024) == 0 && i > 0) {
-            vTaskDelay(1);
-        }
-    }
+void epaper_reset_clip(void) {
+    draw_clip.valid = false;
+}
 
-    // Fill RED channel (0x10) SECOND
-    epaper_send_command(0x10);
-    for (uint32_t i = 0; i < BUFFER_SIZE; i++) {
-        epaper_send_data(framebuffer_bw[i]);
-        // Yield every 1024 bytes to avoid watchdog
-        if ((i % 1024) == 0 && i > 0) {
-            vTaskDelay(1);
-        }
+static void draw_run(int32_t x, int32_t y, int32_t len, bool vertical, void *ctx) {
+    uint8_t color = *(const uint8_t *)ctx;
+    if (vertical) {
+        fill_logical_rect(x, y, 1, len, color);
+    } else {
+        fill_logical_rect(x, y, len, 1, color);
     }
-
-    // Refresh display - use epaper_flushDisplay() pattern (includes power management)
-    ESP_LOGI("epaper", "Refreshing display...");
-    epaper_flushDisplay();
-    ESP_LOGI("epaper", "Display update complete");
 }
 
-// Clear framebuffer to white
-void epaper_display_clear(void) {
-    epaper_framebuffer_init();
-    memset(framebuffer_bw, 0x00, BUFFER_SIZE);
-    memset(framebuffer_red, 0x00, BUFFER_SIZE);
-    ESP_LOGI("epaper", "Framebuffer cleared");
+static int64_t div_floor(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
 }
 
-// Set global screen orientation
-void epaper_set_orientation(uint8_t orientation) {
-    if (orientation <= ORIENTATION_270) {
-        screen_orientation = orientation;
-        ESP_LOGI("epaper", "Screen orientation set to %d°", orientation * 90);
-    } else {
-        ESP_LOGE("epaper", "Invalid orientation: %d", orientation);
-    }
+static int64_t div_ceil(int64_t a, int64_t b) {
+    return -div_floor(-a, b);
+}
+
+// Bresenham line from (x0, y0) to (x1, y1), clipped to bx0..bx1, by0..by1.
+// Step i along the major axis moves the minor axis by floor((2 * i * dmin + dmaj) / (2 * dmaj)),
+// so the visible part is found by solving for i, and drawing starts there with the
+// error term it would have had. Pixels of equal minor coordinate come out as one run.
+static void line_runs(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                      int32_t bx0, int32_t by0, int32_t bx1, int32_t by1,
+                      shape_run_fn fn, void *ctx) {
+    int32_t dx = x1 - x0, dy = y1 - y0;
+    bool x_major = abs(dx) >= abs(dy);
+    int32_t maj0 = x_major ? x0 : y0, min0 = x_major ? y0 : x0;
+    int32_t dmaj = x_major ? abs(dx) : abs(dy), dmin = x_major ? abs(dy) : abs(dx);
+    int32_t smaj = (x_major ? dx : dy) < 0 ? -1 : 1;
+    int32_t smin = (x_major ? dy : dx) < 0 ? -1 : 1;
+    int32_t majlo = x_major ? bx0 : by0, majhi = x_major ? bx1 : by1;
+    int32_t minlo = x_major ? by0 : bx0, minhi = x_major ? by1 : bx1;
+
+    if (dmaj == 0) {
+        if (x0 >= bx0 && x0 <= bx1 && y0 >= by0 && y0 <= by1) {
+            fn(x0, y0, 1, false, ctx);
+        }
+        return;
+    }
+
+    // Steps inside the major axis bounds
+    int64_t i0 = 0, i1 = dmaj;
+    int64_t lo = smaj > 0 ? majlo - maj0 : maj0 - majhi;
+    int64_t hi = smaj > 0 ? majhi - maj0 : maj0 - majlo;
+    if (lo > i0) i0 = lo;
+    if (hi < i1) i1 = hi;
+
+    // Steps whose minor offset m stays inside the minor axis bounds
+    int64_t mlo = smin > 0 ? minlo - min0 : min0 - minhi;
+    int64_t mhi = smin > 0 ? minhi - min0 : min0 - minlo;
+    if (mhi < 0 || mlo > dmin) {
+        return;
+    }
+    if (mlo > 0) {
+        int64_t first = div_ceil(2 * (int64_t)dmaj * mlo - dmaj, 2 * (int64_t)dmin);
+        if (first > i0) i0 = first;
+    }
+    if (mhi < dmin) {
+        int64_t last = div_floor(2 * (int64_t)dmaj * (mhi + 1) - dmaj - 1, 2 * (int64_t)dmin);
+        if (last < i1) i1 = last;
+    }
+    if (i0 > i1) {
+        return;
+    }
+
+    int64_t n = 2 * i0 * dmin + dmaj;
+    int32_t m = (int32_t)(n / (2 * dmaj));
+    int32_t err = (int32_t)(n % (2 * dmaj));
+    int32_t run_start = (int32_t)i0;
+    for (int32_t i = (int32_t)i0; i <= i1; i++) {
+        err += 2 * dmin;
+        bool step = err >= 2 * dmaj;
+        if (step || i == i1) {
+            int32_t a = maj0 + smaj * run_start, b = maj0 + smaj * i;
+            int32_t start = a < b ? a : b, len = i - run_start + 1;
+            int32_t minor = min0 + smin * m;
+            if (x_major) {
+                fn(start, minor, len, false, ctx);
+            } else {
+                fn(minor, start, len, true, ctx);
+            }
+            run_start = i + 1;
+        }
+        if (step) {
+            err -= 2 * dmaj;
+            m++;
+        }
+    }
+}
+
+// Horizontal extent of each row of a filled convex polygon, one entry per visible row
+static int32_t poly_left[SCREEN_2_6_HEIGHT];
+static int32_t poly_right[SCREEN_2_6_HEIGHT];
+static int32_t poly_row0;
+
+static void poly_edge_run(int32_t x, int32_t y, int32_t len, bool vertical, void *ctx) {
+    int32_t rows = vertical ? len : 1;
+    int32_t x_end = vertical ? x : x + len - 1;
+    for (int32_t r = 0; r < rows; r++) {
+        int32_t *left = &poly_left[y + r - poly_row0], *right = &poly_right[y + r - poly_row0];
+        if (x < *left) *left = x;
+        if (x_end > *right) *right = x_end;
+    }
+}
+
+// Fill a convex polygon given as count (x, y) pairs: the edges are walked with
+// line_runs() over the visible rows, then every row is filled between its extremes
+static void fill_polygon(const int32_t *xy, uint16_t count, uint8_t color) {
+    int32_t bx0, by0, bx1, by1;
+    logical_bounds(&bx0, &by0, &bx1, &by1);
+
+    int32_t top = xy[1], bottom = xy[1];
+    for (uint16_t i = 1; i < count; i++) {
+        if (xy[2 * i + 1] < top) top = xy[2 * i + 1];
+        if (xy[2 * i + 1] > bottom) bottom = xy[2 * i + 1];
+    }
+    if (top < by0) top = by0;
+    if (bottom > by1) bottom = by1;
+    if (top > bottom) {
+        return;
+    }
+
+    poly_row0 = top;
+    for (int32_t r = 0; r <= bottom - top; r++) {
+        poly_left[r] = SHAPE_NO_CLIP;
+        poly_right[r] = -SHAPE_NO_CLIP;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        const int32_t *a = &xy[2 * i], *b = &xy[2 * ((i + 1) % count)];
+        line_runs(a[0], a[1], b[0], b[1], -SHAPE_NO_CLIP, top, SHAPE_NO_CLIP, bottom, poly_edge_run, NULL);
+    }
+    for (int32_t r = 0; r <= bottom - top; r++) {
+        int32_t left = poly_left[r] < bx0 ? bx0 : poly_left[r];
+        int32_t right = poly_right[r] > bx1 ? bx1 : poly_right[r];
+        if (left <= right) {
+            fill_logical_rect(left, top + r, right - left + 1, 1, color);
+        }
+    }
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0, bit = 1ull << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static int32_t div_round(int64_t a, int64_t b) {
+    return (int32_t)(a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b));
+}
+
+void epaper_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t thickness, uint8_t color) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    if (thickness <= 1) {
+        int32_t bx0, by0, bx1, by1;
+        logical_bounds(&bx0, &by0, &bx1, &by1);
+        line_runs(x0, y0, x1, y1, bx0, by0, bx1, by1, draw_run, &color);
+        return;
+    }
+
+    // Thick lines are a quad: the segment moved along its normal by a1 pixels one
+    // way and a2 the other, so that a1 + a2 + 1 = thickness
+    int32_t dx = x1 - x0, dy = y1 - y0;
+    int32_t a1 = (thickness - 1) / 2, a2 = thickness - 1 - a1;
+    uint32_t len = isqrt64((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+    if (len == 0) {
+        fill_logical_rect(x0 - a1, y0 - a1, thickness, thickness, color);
+        return;
+    }
+    int32_t nx1 = div_round(-(int64_t)dy * a1, len), ny1 = div_round((int64_t)dx * a1, len);
+    int32_t nx2 = div_round((int64_t)dy * a2, len), ny2 = div_round(-(int64_t)dx * a2, len);
+    int32_t quad[8] = {
+        x0 + nx1, y0 + ny1, x1 + nx1, y1 + ny1,
+        x1 + nx2, y1 + ny2, x0 + nx2, y0 + ny2,
+    };
+    fill_polygon(quad, 4, color);
+}
+
+void epaper_polygon(const int16_t *points, uint16_t count, uint8_t color) {
+    if (count == 0 || count > EPAPER_POLYGON_MAX_POINTS || !framebuffer_ready()) {
+        return;
+    }
+    int32_t xy[2 * EPAPER_POLYGON_MAX_POINTS];
+    for (uint16_t i = 0; i < 2 * count; i++) {
+        xy[i] = points[i];
+    }
+    fill_polygon(xy, count, color);
+}
+
+// Rows of a rounded rectangle. The corners are circles of radius r, rows dy away
+// from a corner center reach hw pixels past it, the largest hw with
+// hw^2 + dy^2 <= r^2 + r (midpoint rule). hw is stepped from the previous row.
+typedef struct {
+    int32_t x0, y0, x1, y1;  // Inclusive bounds
+    int32_t r;
+    int64_t r2;              // r * r + r
+    int32_t dy, hw;
+} round_rect_t;
+
+static void round_rect_init(round_rect_t *s, int32_t x, int32_t y, int32_t w, int32_t h, int32_t r) {
+    int32_t max_r = ((w < h ? w : h) - 1) / 2;
+    if (r > max_r) r = max_r;
+    if (r < 0) r = 0;
+    s->x0 = x; s->y0 = y;
+    s->x1 = x + w - 1; s->y1 = y + h - 1;
+    s->r = r;
+    s->r2 = (int64_t)r * r + r;
+    s->dy = 0;
+    s->hw = r;
+}
+
+// Span of row y, false when the row misses the shape
+static bool round_rect_span(round_rect_t *s, int32_t y, int32_t *left, int32_t *right) {
+    if (y < s->y0 || y > s->y1) {
+        return false;
+    }
+    int32_t dy = 0;
+    if (y < s->y0 + s->r) {
+        dy = s->y0 + s->r - y;
+    } else if (y > s->y1 - s->r) {
+        dy = y - (s->y1 - s->r);
+    }
+    while (s->dy < dy) {
+        s->dy++;
+        while (s->hw > 0 && (int64_t)s->hw * s->hw + (int64_t)s->dy * s->dy > s->r2) s->hw--;
+    }
+    while (s->dy > dy) {
+        s->dy--;
+        while ((int64_t)(s->hw + 1) * (s->hw + 1) + (int64_t)s->dy * s->dy <= s->r2) s->hw++;
+    }
+    *left = s->x0 + s->r - s->hw;
+    *right = s->x1 - s->r + s->hw;
+    return true;
+}
+
+// Quarter wave of sin(degrees) * 1024, for arc end points
+static const int16_t sin_table[91] = {
+    0, 18, 36, 54, 71, 89, 107, 125, 143, 160, 178, 195,
+    213, 230, 248, 265, 282, 299, 316, 333, 350, 367, 384, 400,
+    416, 433, 449, 465, 481, 496, 512, 527, 543, 558, 573, 587,
+    602, 616, 630, 644, 658, 672, 685, 698, 711, 724, 737, 749,
+    761, 773, 784, 796, 807, 818, 828, 839, 849, 859, 868, 878,
+    887, 896, 904, 912, 920, 928, 935, 943, 949, 956, 962, 968,
+    974, 979, 984, 989, 994, 998, 1002, 1005, 1008, 1011, 1014, 1016,
+    1018, 1020, 1022, 1023, 1023, 1024, 1024,
+};
+
+static int32_t sin_deg(int32_t deg) {
+    deg %= 360;
+    if (deg < 0) deg += 360;
+    if (deg <= 90) return sin_table[deg];
+    if (deg <= 180) return sin_table[180 - deg];
+    if (deg <= 270) return -sin_table[deg - 180];
+    return -sin_table[360 - deg];
+}
+
+// Pixels of a ring (or a pie slice) kept by an arc: clockwise from start to end
+typedef struct {
+    int32_t cx, cy;
+    int32_t sx, sy, ex, ey;  // Start and end directions, * 1024
+    uint16_t sweep;          // Degrees, 360 = whole ring
+} arc_sector_t;
+
+static bool arc_contains(const arc_sector_t *a, int32_t x, int32_t y) {
+    if (a->sweep >= 360) {
+        return true;
+    }
+    int32_t px = x - a->cx, py = y - a->cy;
+    // y grows downwards, so a positive cross product turns clockwise
+    int64_t from_start = (int64_t)a->sx * py - (int64_t)a->sy * px;
+    int64_t to_end = (int64_t)px * a->ey - (int64_t)py * a->ex;
+    if (a->sweep <= 180) {
+        return from_start >= 0 && to_end >= 0;
+    }
+    int64_t from_end = (int64_t)a->ex * py - (int64_t)a->ey * px;
+    int64_t to_start = (int64_t)px * a->sy - (int64_t)py * a->sx;
+    return !(from_end > 0 && to_start > 0);
+}
+
+// Fill the pixels of row y from left to right that lie in the sector, as runs
+static void arc_row(const arc_sector_t *arc, int32_t y, int32_t left, int32_t right, uint8_t color) {
+    if (arc == NULL) {
+        fill_logical_rect(left, y, right - left + 1, 1, color);
+        return;
+    }
+    int32_t run = left;
+    for (int32_t x = left; x <= right; x++) {
+        if (!arc_contains(arc, x, y)) {
+            if (x > run) fill_logical_rect(run, y, x - run, 1, color);
+            run = x + 1;
+        }
+    }
+    if (right >= run) fill_logical_rect(run, y, right - run + 1, 1, color);
+}
+
+// Rounded rectangle filled, or outlined thickness pixels wide, optionally
+// limited to an arc. Rows are clipped up front, spans at the screen edges.
+static void draw_round_rect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint8_t thickness,
+                            const arc_sector_t *arc, uint8_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    round_rect_t outer, inner;
+    bool hollow = thickness > 0 && 2 * thickness < w && 2 * thickness < h;
+    round_rect_init(&outer, x, y, w, h, r);
+    if (hollow) {
+        round_rect_init(&inner, x + thickness, y + thickness, w - 2 * thickness, h - 2 * thickness,
+                        outer.r - thickness);
+    }
+
+    int32_t bx0, by0, bx1, by1;
+    logical_bounds(&bx0, &by0, &bx1, &by1);
+    int32_t top = y < by0 ? by0 : y;
+    int32_t bottom = y + h - 1 > by1 ? by1 : y + h - 1;
+
+    for (int32_t row = top; row <= bottom; row++) {
+        int32_t left, right, in_left, in_right;
+        round_rect_span(&outer, row, &left, &right);
+        if (hollow && round_rect_span(&inner, row, &in_left, &in_right)) {
+            // Two pieces, left and right of the hole
+            int32_t l = left < bx0 ? bx0 : left, r1 = in_left - 1 > bx1 ? bx1 : in_left - 1;
+            if (l <= r1) arc_row(arc, row, l, r1, color);
+            int32_t l2 = in_right + 1 < bx0 ? bx0 : in_right + 1, r2 = right > bx1 ? bx1 : right;
+            if (l2 <= r2) arc_row(arc, row, l2, r2, color);
+            continue;
+        }
+        if (left < bx0) left = bx0;
+        if (right > bx1) right = bx1;
+        if (left <= right) arc_row(arc, row, left, right, color);
+    }
+}
+
+// Copy n bits from src at bit sx to dst at bit dx (MSB first), a destination byte at a time
+static void copy_bits(uint8_t *dst, int32_t dx, const uint8_t *src, int32_t sx, int32_t n) {
+    while (n > 0) {
+        int32_t db = dx & 7;
+        int32_t take = 8 - db < n ? 8 - db : n;
+        uint32_t bits = (uint32_t)src[sx >> 3] << 8;
+        if ((sx & 7) + take > 8) {
+            bits |= src[(sx >> 3) + 1];
+        }
+        uint8_t v = (uint8_t)((bits << (sx & 7)) >> 8);
+        uint8_t mask = (uint8_t)(0xFF << (8 - take)) >> db;
+        dst[dx >> 3] = (dst[dx >> 3] & ~mask) | ((v >> db) & mask);
+        dx += take;
+        sx += take;
+        n -= take;
+    }
+}
+
+// One logical row from packed planes: clip once, then step through the panel
+// along the direction the row takes in the current orientation
+void epaper_draw_row(int16_t x, int16_t y, uint16_t w, const uint8_t *bw, const uint8_t *red) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    int32_t bx0, by0, bx1, by1;
+    logical_bounds(&bx0, &by0, &bx1, &by1);
+    int32_t first = x < bx0 ? bx0 - x : 0;
+    int32_t last = (int32_t)x + w - 1 > bx1 ? bx1 - x : w - 1;
+    if (y < by0 || y > by1 || first > last) {
+        return;
+    }
+    dirty_add_logical(x + first, y, last - first + 1, 1);
+
+    int32_t px, py, qx, qy, unused_x, unused_y;
+    logical_to_fb(x + first, y, 1, 1, &px, &py, &unused_x, &unused_y);
+    if (draw_rotation == ORIENTATION_0) {
+        // The row is a framebuffer row (0°, or a native layout)
+        copy_bits(draw_bw + (size_t)py * fb_stride, px, bw, first, last - first + 1);
+        copy_bits(draw_red + (size_t)py * fb_stride, px, red, first, last - first + 1);
+        return;
+    }
+    logical_to_fb(x + first + 1, y, 1, 1, &qx, &qy, &unused_x, &unused_y);
+    int32_t step_x = qx - px, step_y = qy - py;
+    for (int32_t i = first; i <= last; i++, px += step_x, py += step_y) {
+        size_t idx = (size_t)py * fb_stride + px / 8;
+        uint8_t mask = 0x80 >> (px % 8);
+        uint8_t bit = 0x80 >> (i % 8);
+        if (bw[i / 8] & bit) draw_bw[idx] |= mask; else draw_bw[idx] &= ~mask;
+        if (red[i / 8] & bit) draw_red[idx] |= mask; else draw_red[idx] &= ~mask;
+    }
+}
+
+void epaper_round_rect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t radius,
+                       uint8_t thickness, uint8_t color) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    draw_round_rect(x, y, w, h, radius, thickness, NULL, color);
+}
+
+void epaper_circle(int16_t cx, int16_t cy, uint16_t r, uint8_t thickness, uint8_t color) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    draw_round_rect(cx - r, cy - r, 2 * r + 1, 2 * r + 1, r, thickness, NULL, color);
+}
+
+void epaper_arc(int16_t cx, int16_t cy, uint16_t r, uint16_t start, uint16_t end,
+                uint8_t thickness, uint8_t color) {
+    if (!framebuffer_ready()) {
+        return;
+    }
+    int32_t sweep = ((int32_t)end - start) % 360;
+    if (sweep < 0) sweep += 360;
+    if (sweep == 0 && end != start) sweep = 360;
+    arc_sector_t arc = {
+        .cx = cx, .cy = cy,
+        .sx = sin_deg(start + 90), .sy = sin_deg(start),
+        .ex = sin_deg(end + 90), .ey = sin_deg(end),
+        .sweep = (uint16_t)sweep,
+    };
+    draw_round_rect(cx - r, cy - r, 2 * r + 1, 2 * r + 1, r, thickness, &arc, color);
+}
+
+// ========== Layers ==========
+
+static bool layers_on(void) {
+    return layers[EPAPER_LAYER_BACKGROUND].bw != NULL;
+}
+
+// Planes of a layer: the background starts as the frame, overlays transparent
+static bool layer_alloc(uint8_t layer) {
+    layer_t *l = &layers[layer];
+    if (l->bw != NULL) {
+        return true;
+    }
+    l->bw = (uint8_t*)malloc(2 * BUFFER_SIZE);
+    if (l->bw == NULL) {
+        ESP_LOGE("epaper", "No memory for layer %d", layer);
+        return false;
+    }
+    l->red = l->bw + BUFFER_SIZE;
+    if (layer == EPAPER_LAYER_BACKGROUND) {
+        memcpy(l->bw, framebuffer_bw, BUFFER_SIZE);
+        memcpy(l->red, framebuffer_red, BUFFER_SIZE);
+    } else {
+        memset(l->bw, 0xFF, 2 * BUFFER_SIZE);
+    }
+    l->changed.valid = false;
+    ESP_LOGI("epaper", "Allocated layer %d: %d bytes", layer, 2 * BUFFER_SIZE);
+    return true;
+}
+
+esp_err_t epaper_layer_select(uint8_t layer) {
+    if (layer == EPAPER_LAYER_NONE) {
+        layer_current = layer;
+        draw_bw = framebuffer_bw;
+        draw_red = framebuffer_red;
+        return ESP_OK;
+    }
+    if (layer >= EPAPER_LAYER_COUNT) {
+        ESP_LOGE("epaper", "Invalid layer %d", layer);
+        return ESP_ERR_INVALID_ARG;
+    }
+    // An overlay needs the background to composite onto
+    if (!framebuffer_ready() || !layer_alloc(EPAPER_LAYER_BACKGROUND) || !layer_alloc(layer)) {
+        return ESP_ERR_NO_MEM;
+    }
+    layer_current = layer;
+    draw_bw = layers[layer].bw;
+    draw_red = layers[layer].red;
+    return ESP_OK;
+}
+
+uint8_t epaper_layer_get(void) {
+    return layer_current;
+}
+
+void epaper_layers_free(void) {
+    epaper_layer_select(EPAPER_LAYER_NONE);
+    for (int l = 0; l < EPAPER_LAYER_COUNT; l++) {
+        free(layers[l].bw);
+        layers[l].bw = layers[l].red = NULL;
+        layers[l].changed.valid = false;
+    }
+}
+
+// Composite the layers into the framebuffers over the rows where they changed,
+// and pass those rows on to the update (the shadow diff narrows them down
+// further). Rows are done a word at a time: per overlay the opaque pixels are
+// ~(bw & red), and the frame takes their bits.
+static void layers_composite(void) {
+    region_t changed = {0};
+    const uint32_t *over_bw[EPAPER_LAYER_COUNT], *over_red[EPAPER_LAYER_COUNT];
+    int overlays = 0;
+    for (int l = 0; l < EPAPER_LAYER_COUNT; l++) {
+        if (layers[l].bw == NULL) {
+            continue;
+        }
+        if (layers[l].changed.valid) {
+            region_t *c = &layers[l].changed;
+            region_add(&changed, c->x0, c->y0, c->x1, c->y1);
+            c->valid = false;
+        }
+        if (l != EPAPER_LAYER_BACKGROUND) {
+            over_bw[overlays] = (const uint32_t*)layers[l].bw;
+            over_red[overlays++] = (const uint32_t*)layers[l].red;
+        }
+    }
+    if (!changed.valid) {
+        return;
+    }
+
+    // BUFFER_SIZE is a multiple of 4: rounding the rows out to whole words stays
+    // inside the planes
+    size_t start = ((size_t)changed.y0 * fb_stride) / 4;
+    size_t end = ((size_t)(changed.y1 + 1) * fb_stride + 3) / 4;
+    const uint32_t *bg_bw = (const uint32_t*)layers[EPAPER_LAYER_BACKGROUND].bw;
+    const uint32_t *bg_red = (const uint32_t*)layers[EPAPER_LAYER_BACKGROUND].red;
+    uint32_t *out_bw = (uint32_t*)framebuffer_bw, *out_red = (uint32_t*)framebuffer_red;
+    for (size_t i = start; i < end; i++) {
+        uint32_t bw = bg_bw[i], red = bg_red[i];
+        for (int o = 0; o < overlays; o++) {
+            uint32_t ob = over_bw[o][i], orr = over_red[o][i];
+            uint32_t opaque = ~(ob & orr);
+            bw ^= (bw ^ ob) & opaque;
+            red ^= (red ^ orr) & opaque;
+        }
+        out_bw[i] = bw;
+        out_red[i] = red;
+    }
+    // All rows touched: they may also replace what was drawn into the frame directly
+    frame_dirty_add(0, start * 4 / fb_stride, fb_width - 1, (end * 4 - 1) / fb_stride);
+}
+
+// Transfer buffers (DMA), used for snapshots and gathered partial windows
+static bool epaper_tx_buffers_alloc(void) {
+    if (tx_bw == NULL) {
+        tx_bw = (uint8_t*)heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DMA);
+    }
+    if (tx_red == NULL) {
+        tx_red = (uint8_t*)heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_DMA);
+    }
+    if (tx_bw == NULL || tx_red == NULL) {
+        ESP_LOGE("epaper", "Failed to allocate transfer buffers");
+        return false;
+    }
+    return true;
+}
+
+// The frame in panel order: the framebuffers themselves, or with a native
+// layout their rotation into the transfer buffers, which is then the snapshot
+static bool panel_frame(const uint8_t **bw, const uint8_t **red) {
+    // A queued transfer may still be reading the transfer buffers
+    epaper_async_wait(0);
+    if (!epaper_tx_buffers_alloc()) {
+        return false;
+    }
+    if (fb_rotation == ORIENTATION_0) {
+        *bw = framebuffer_bw;
+        *red = framebuffer_red;
+    } else {
+        plane_transpose(framebuffer_bw, tx_bw, fb_rotation, true);
+        plane_transpose(framebuffer_red, tx_red, fb_rotation, true);
+        *bw = tx_bw;
+        *red = tx_red;
+    }
+    return true;
+}
+
+// Snapshot panel rows y0..y1, byte columns xb0..xb1 of a panel_frame() into the
+// transfer buffers (packed rows) and record it in the shadow frame. The
+// framebuffers are free for drawing again as soon as this returns.
+static bool flush_prepare(const uint8_t *frame_bw, const uint8_t *frame_red,
+                          uint16_t xb0, uint16_t xb1, int16_t y0, int16_t y1, bool partial) {
+    uint16_t row_bytes = xb1 - xb0 + 1;
+    if (frame_bw == tx_bw) {
+        // Already rotated into the transfer buffers: pack the window in place,
+        // rows only ever move towards the start
+        if (row_bytes != BYTES_PER_ROW || y0 != 0) {
+            for (int16_t r = 0; r <= y1 - y0; r++) {
+                size_t src = (size_t)(y0 + r) * BYTES_PER_ROW + xb0;
+                memmove(tx_bw + (size_t)r * row_bytes, tx_bw + src, row_bytes);
+                memmove(tx_red + (size_t)r * row_bytes, tx_red + src, row_bytes);
+            }
+        }
+    } else if (row_bytes == BYTES_PER_ROW) {
+        memcpy(tx_bw, frame_bw + (size_t)y0 * BYTES_PER_ROW, (size_t)(y1 - y0 + 1) * BYTES_PER_ROW);
+        memcpy(tx_red, frame_red + (size_t)y0 * BYTES_PER_ROW, (size_t)(y1 - y0 + 1) * BYTES_PER_ROW);
+    } else {
+        for (int16_t r = 0; r <= y1 - y0; r++) {
+            size_t src = (size_t)(y0 + r) * BYTES_PER_ROW + xb0;
+            memcpy(tx_bw + (size_t)r * row_bytes, frame_bw + src, row_bytes);
+            memcpy(tx_red + (size_t)r * row_bytes, frame_red + src, row_bytes);
+        }
+    }
+    dirty.valid = false;
+
+    // A window leaves the rest of controller RAM untouched: a valid shadow stays valid
+    bool full = !partial && row_bytes == BYTES_PER_ROW && y0 == 0 && y1 == SCREEN_2_6_HEIGHT - 1;
+    bool keep_valid = full || shadow_valid;
+    shadow_store(xb0, xb1, y0, y1);
+    shadow_valid = keep_valid && shadow_bw != NULL;
+
+    flush_pending = true;
+    flush_partial = partial;
+    flush_xb0 = xb0; flush_xb1 = xb1;
+    flush_y0 = y0; flush_y1 = y1;
+    return true;
+}
+
+// Send the prepared snapshot and refresh the panel (full or partial window)
+static void flush_send(void) {
+    uint16_t row_bytes = flush_xb1 - flush_xb0 + 1;
+    uint16_t rows = flush_y1 - flush_y0 + 1;
+    size_t len = (size_t)row_bytes * rows;
+    flush_pending = false;
+
+    if (flush_partial) {
+        ESP_LOGI("epaper", "Partial update: x %d-%d, y %d-%d (%u bytes per plane)",
+                 flush_xb0 * 8, flush_xb1 * 8 + 7, flush_y0, flush_y1, (unsigned)len);
+        epaper_DCDC_powerOn();
+        epaper_send_command(0x91); // Enter partial mode
+        epaper_set_partial_window(flush_xb0 * 8, flush_y0, row_bytes * 8, rows);
+    } else {
+        ESP_LOGI("epaper", "Updating display from framebuffer...");
+
+        // Debug: print first few bytes to verify data
+        ESP_LOGI("epaper", "BW buffer first 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x",
+                 tx_bw[0], tx_bw[1], tx_bw[2], tx_bw[3], tx_bw[4], tx_bw[5], tx_bw[6], tx_bw[7]);
+        ESP_LOGI("epaper", "RED buffer first 8 bytes: %02x %02x %02x %02x %02x %02x %02x %02x",
+                 tx_red[0], tx_red[1], tx_red[2], tx_red[3], tx_red[4], tx_red[5], tx_red[6], tx_red[7]);
+    }
+
+    // epaper_send_plane() invalidates the shadow frame, which already holds this snapshot
+    bool shadow_was_valid = shadow_valid;
+    stats_mark_t mark;
+    stats_mark(&mark);
+
+    if (bulk_transfer || flush_partial) {
+        // One DMA transaction per plane, same order as the per-byte path below
+        epaper_send_plane(0x13, tx_red, len);
+        epaper_send_plane(0x10, tx_bw, len);
+    } else {
+        // Match epaper_fill() pattern which works
+        // Fill BW channel (0x13) FIRST
+        epaper_send_command(0x13);
+        for (uint32_t i = 0; i < len; i++) {
+            epaper_send_data(tx_red[i]);
+            // Yield every 1024 bytes to avoid watchdog
+            if ((i % 1024) == 0 && i > 0) {
+                vTaskDelay(1);
+            }
+        }
+
+        // Fill RED channel (0x10) SECOND
+        epaper_send_command(0x10);
+        for (uint32_t i = 0; i < len; i++) {
+            epaper_send_data(tx_bw[i]);
+            // Yield every 1024 bytes to avoid watchdog
+            if ((i % 1024) == 0 && i > 0) {
+                vTaskDelay(1);
+            }
+        }
+    }
+
+    stats_finish(&mark, &frame_stats);
+    shadow_valid = shadow_was_valid;
+    ESP_LOGI("epaper", "Frame transfer: %lu bytes in %lu SPI transactions, %lu us (%s)",
+             (unsigned long)frame_stats.bytes, (unsigned long)frame_stats.transactions,
+             (unsigned long)frame_stats.duration_us,
+             flush_partial ? "partial" : (bulk_transfer ? "bulk" : "per-byte"));
+
+    if (flush_partial) {
+        refresh_stats.partial++;
+        epaper_send_command(0x12);
+        epaper_waitBusy();
+        epaper_send_command(0x92); // Exit partial mode
+        epaper_DCDC_powerOff();
+    } else {
+        refresh_stats.full++;
+        // Refresh display - use epaper_flushDisplay() pattern (includes power management)
+        ESP_LOGI("epaper", "Refreshing display...");
+        epaper_flushDisplay();
+    }
+    ESP_LOGI("epaper", "Display update complete");
+}
+
+static bool flush_prepare_full(const uint8_t *frame_bw, const uint8_t *frame_red) {
+    return flush_prepare(frame_bw, frame_red, 0, BYTES_PER_ROW - 1, 0, SCREEN_2_6_HEIGHT - 1, false);
+}
+
+// Prepare a full update, compared with the shadow frame first: identical frames
+// are skipped and small changes only refresh the changed window.
+bool epaper_display_update_begin(void) {
+    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+        ESP_LOGE("epaper", "Framebuffers not initialized");
+        return false;
+    }
+    layers_composite();
+    const uint8_t *frame_bw, *frame_red;
+    if (!panel_frame(&frame_bw, &frame_red)) {
+        return false;
+    }
+
+    if (shadow_valid) {
+        int16_t x0, y0, x1, y1;
+        if (!shadow_diff(frame_bw, frame_red, &x0, &y0, &x1, &y1)) {
+            dirty.valid = false;
+            refresh_stats.skipped++;
+            ESP_LOGI("epaper", "Frame unchanged, refresh skipped");
+            return false;
+        }
+        if (is_partial_size(x0, y0, x1, y1)) {
+            refresh_stats.shrunk++;
+            return flush_prepare(frame_bw, frame_red, x0 / 8, x1 / 8, y0, y1, true);
+        }
+    }
+    return flush_prepare_full(frame_bw, frame_red);
+}
+
+// Prepare an update of what changed since the last one: a partial window for
+// small changes, a full update otherwise
+bool epaper_display_refresh_begin(void) {
+    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+        ESP_LOGE("epaper", "Framebuffers not initialized");
+        return false;
+    }
+    layers_composite();
+    if (!dirty.valid) {
+        refresh_stats.skipped++;
+        ESP_LOGI("epaper", "Nothing changed, refresh skipped");
+        return false;
+    }
+
+    // The shadow frame gives the exact change; without it rely on the dirty box
+    if (shadow_valid || !is_partial_size(dirty.x0, dirty.y0, dirty.x1, dirty.y1)) {
+        return epaper_display_update_begin();
+    }
+    const uint8_t *frame_bw, *frame_red;
+    if (!panel_frame(&frame_bw, &frame_red)) {
+        return false;
+    }
+    return flush_prepare(frame_bw, frame_red, dirty.x0 / 8, dirty.x1 / 8, dirty.y0, dirty.y1, true);
+}
+
+// Send what epaper_display_update_begin()/epaper_display_refresh_begin() prepared
+void epaper_display_flush(void) {
+    if (flush_pending) {
+        flush_send();
+    }
+}
+
+// Send framebuffer to display and refresh (call after drawing operations)
+void epaper_display_update(void) {
+    if (epaper_display_update_begin()) {
+        epaper_display_flush();
+    }
+}
+
+// Send only what changed since the last update
+void epaper_display_refresh(void) {
+    if (epaper_display_refresh_begin()) {
+        epaper_display_flush();
+    }
+}
+
+void epaper_get_refresh_stats(epaper_refresh_stats_t *stats) {
+    if (stats != NULL) {
+        *stats = refresh_stats;
+    }
+}
+
+// Queue both planes of a whole frame and return while they are sent. The
+// framebuffers are snapshotted, so the next frame can be drawn right away.
+// RAM writes need no DC/DC, powering on and refreshing is left to
+// epaper_display_update_wait(), as both wait for BUSY.
+esp_err_t epaper_display_update_async(void) {
+    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+        ESP_LOGE("epaper", "Framebuffers not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    layers_composite();
+
+    // Previous transfer must be finished (each async update is paired with
+    // epaper_display_update_wait(), which also covers the refresh)
+    const uint8_t *frame_bw, *frame_red;
+    if (!panel_frame(&frame_bw, &frame_red) || !flush_prepare_full(frame_bw, frame_red)) {
+        return ESP_ERR_NO_MEM;
+    }
+    flush_pending = false;
+    refresh_stats.full++;
+
+    epaper_async_begin();
+    epaper_async_command(0x13);
+    epaper_async_data(tx_red, BUFFER_SIZE);
+    epaper_async_command(0x10);
+    epaper_async_data(tx_bw, BUFFER_SIZE);
+    return epaper_async_submit();
+}
+
+// Wait for a frame queued by epaper_display_update_async(), then refresh the
+// panel with it (power on, refresh, power off)
+esp_err_t epaper_display_update_wait(uint32_t timeout_ms) {
+    esp_err_t ret = epaper_async_wait(timeout_ms);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_LOGI("epaper", "Frame queued transfer: %lu bytes in %lu SPI transactions, %lu us",
+             (unsigned long)frame_stats.bytes, (unsigned long)frame_stats.transactions,
+             (unsigned long)frame_stats.duration_us);
+    epaper_flushDisplay();
+    return ESP_OK;
+}
+
+void epaper_set_partial_refresh(uint8_t enable) {
+    partial_refresh = enable ? 1 : 0;
+    ESP_LOGI("epaper", "Automatic partial refresh %s", partial_refresh ? "enabled" : "disabled");
+}
+
+// Clear framebuffer to white, or the selected layer (overlays to transparent)
+void epaper_display_clear(void) {
+    epaper_framebuffer_init();
+    if (layer_current == EPAPER_LAYER_NONE) {
+        // The whole frame is redrawn from here on
+        epaper_layers_free();
+    }
+    // Nothing to keep without layers: the layout for the orientation comes for free
+    framebuffer_set_layout(layout_wanted(), layers_on());
+    uint8_t fill = layer_current == EPAPER_LAYER_NONE || layer_current == EPAPER_LAYER_BACKGROUND ? 0x00 : 0xFF;
+    memset(draw_bw, fill, BUFFER_SIZE);
+    memset(draw_red, fill, BUFFER_SIZE);
+    dirty_add(0, 0, fb_width - 1, fb_height - 1);
+    if (layer_current == EPAPER_LAYER_NONE) {
+        ESP_LOGI("epaper", "Framebuffer cleared");
+    } else {
+        ESP_LOGI("epaper", "Layer %d cleared", layer_current);
+    }
+}
+
+esp_err_t epaper_bitmap_begin(epaper_bitmap_t *bm, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                              uint8_t planes) {
+    if (w == 0 || h == 0 || x % 8 != 0 || w % 8 != 0 || x + w > SCREEN_2_6_WIDTH ||
+        y + h > SCREEN_2_6_HEIGHT || (planes & (EPAPER_PLANE_BW | EPAPER_PLANE_RED)) == 0) {
+        ESP_LOGE("epaper", "Invalid bitmap window %dx%d at (%d,%d)", w, h, x, y);
+        return ESP_ERR_INVALID_ARG;
+    }
+    // The window is written as panel rows
+    if (framebuffer_bw == NULL || framebuffer_red == NULL) {
+        epaper_framebuffer_init();
+    }
+    if (framebuffer_bw == NULL || framebuffer_red == NULL || !framebuffer_set_layout(ORIENTATION_0, true)) {
+        return ESP_ERR_NO_MEM;
+    }
+    bm->x = x; bm->y = y; bm->w = w; bm->h = h;
+    bm->planes = planes & (EPAPER_PLANE_BW | EPAPER_PLANE_RED);
+    bm->offset = 0;
+    bm->size = (size_t)(w / 8) * h * ((bm->planes & EPAPER_PLANE_BW ? 1 : 0) + (bm->planes & EPAPER_PLANE_RED ? 1 : 0));
+    if (layer_current != EPAPER_LAYER_NONE && layer_current != EPAPER_LAYER_BACKGROUND &&
+        bm->planes != (EPAPER_PLANE_BW | EPAPER_PLANE_RED)) {
+        // In an overlay the window would stay transparent where the plane left
+        // out is set: clear it, so the window is opaque
+        uint8_t *other = bm->planes & EPAPER_PLANE_BW ? draw_red : draw_bw;
+        for (uint16_t row = 0; row < h; row++) {
+            memset(other + (size_t)(y + row) * BYTES_PER_ROW + x / 8, 0x00, w / 8);
+        }
+    }
+    dirty_add(x, y, x + w - 1, y + h - 1);
+    return ESP_OK;
+}
+
+// The rest of the current row, or of the whole plane when the window spans full rows
+size_t epaper_bitmap_span(const epaper_bitmap_t *bm, uint8_t **dest) {
+    if (bm->offset >= bm->size) {
+        return 0;
+    }
+    size_t row_bytes = bm->w / 8, plane_bytes = row_bytes * bm->h;
+    size_t plane = bm->offset / plane_bytes, pos = bm->offset % plane_bytes;
+    size_t row = pos / row_bytes, col = pos % row_bytes;
+    bool red = plane > 0 || bm->planes == EPAPER_PLANE_RED;
+
+    *dest = (red ? draw_red : draw_bw) + (size_t)(bm->y + row) * BYTES_PER_ROW + bm->x / 8 + col;
+    return row_bytes == BYTES_PER_ROW ? plane_bytes - pos : row_bytes - col;
+}
+
+void epaper_bitmap_advance(epaper_bitmap_t *bm, size_t len) {
+    bm->offset += len;
+    if (bm->offset > bm->size) {
+        bm->offset = bm->size;
+    }
+}
+
+// The window stays dirty from epaper_bitmap_begin(), so the next refresh shows
+// it white instead of the rows received so far
+void epaper_bitmap_abort(const epaper_bitmap_t *bm) {
+    for (uint16_t row = 0; row < bm->h; row++) {
+        size_t offset = (size_t)(bm->y + row) * BYTES_PER_ROW + bm->x / 8;
+        memset(draw_bw + offset, 0x00, bm->w / 8);
+        memset(draw_red + offset, 0x00, bm->w / 8);
+    }
+}
+
+// Set global screen orientation
+void epaper_set_orientation(uint8_t orientation) {
+    if (orientation <= ORIENTATION_270) {
+        screen_orientation = orientation;
+        layout_sync();
+        ESP_LOGI("epaper", "Screen orientation set to %d°", orientation * 90);
+    } else {
+        ESP_LOGE("epaper", "Invalid orientation: %d", orientation);
+    }
 }
 
 // Get current screen orientation
@@ -456,6 +2080,12 @@ uint8_t epaper_get_orientation(void) {
     return screen_orientation;
 }
 
+void epaper_set_native_orientation(uint8_t enable) {
+    native_orientation = enable ? 1 : 0;
+    layout_sync();
+    ESP_LOGI("epaper", "Native orientation framebuffer %s", native_orientation ? "enabled" : "disabled");
+}
+
 // Test if partial updates work on this display
 void epaper_test_partial_update(void) {
     ESP_LOGI("epaper", "=== Testing Partial Update Support ===");
@@ -497,6 +2127,7 @@ void epaper_test_partial_update(void) {
     // Exit partial mode
     epaper_send_command(0x92);
     epaper_DCDC_powerOff();
+    shadow_invalidate();
 
     ESP_LOGI("epaper", "=== Test Results ===");
     ESP_LOGI("epaper", "If you see ONLY a black square at top-left:");
@@ -506,452 +2137,391 @@ void epaper_test_partial_update(void) {
     ESP_LOGI("epaper", "=====================");
 }
 
-// Text rendering functions
-#include "font5x7.h"
-#include "font6x12.h"
-#include "font8x16.h"
+// ========== Glyph cache and blitter ==========
+// Glyphs are cached scaled and rotated for the panel, as packed rows (MSB =
+// leftmost pixel), and written into the planes a byte at a time. Whatever
+// the font layout, a glyph is first read as an unrotated row bitmap by a
+// source picked once per string (glyph_run_init()).
+
+#define GLYPH_CACHE_SLOTS     128
+#define GLYPH_CACHE_WAYS      4     // Set associative, so a few colliding glyphs don't thrash
+#define GLYPH_CACHE_MAX_BYTES 1024  // Bigger glyphs are drawn as one block per font pixel
+#define GLYPH_CACHE_BUDGET    (16 * 1024)  // All cached bitmaps together
+#define GLYPH_SCRATCH_BYTES   512   // Row bitmap of the biggest glyph a font may have
+
+typedef struct {
+    const font_t *font;
+    uint32_t glyph;
+    uint32_t key;       // Draw rotation and scale, 0 = empty slot
+    uint32_t used;      // glyph_cache_clock at the last hit
+    uint16_t w, h;      // Panel orientation
+    uint16_t stride;    // Bytes per row
+    uint16_t capacity;
+    uint8_t *bits;
+} glyph_entry_t;
+
+static glyph_entry_t glyph_cache[GLYPH_CACHE_SLOTS];
+static uint32_t glyph_cache_clock = 0;
+static uint32_t glyph_cache_bytes = 0;
+
+// Panel rectangle (inclusive) glyph pixels may be written to
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} glyph_clip_t;
+
+// Unrotated glyph as rows of (width + 7) / 8 bytes, MSB = leftmost pixel, NULL if unavailable
+typedef const uint8_t *(*glyph_source_t)(const font_t *font, uint32_t glyph);
+
+// What stays the same for a whole string
+typedef struct {
+    const font_t *font;
+    glyph_source_t source;
+    uint8_t color;
+    uint8_t scale;
+    const glyph_clip_t *clip;
+} glyph_run_t;
+
+static uint8_t glyph_scratch[GLYPH_SCRATCH_BYTES];
+
+// FONT_LAYOUT_ROWS_MSB_LEFT: the font data already is the row bitmap
+static const uint8_t *glyph_source_rows(const font_t *font, uint32_t glyph) {
+    return font->data + (size_t)glyph * font->bytes_per_glyph;
+}
 
-// Helper function to transform coordinates based on orientation
-static inline void transform_coordinates(uint16_t x, uint16_t y, uint8_t orientation, uint16_t *out_x, uint16_t *out_y) {
-    switch (orientation) {
-        case ORIENTATION_0:   // 0° - Normal
-            *out_x = x;
-            *out_y = y;
-            break;
-        case ORIENTATION_90:  // 90° clockwise
-            *out_x = SCREEN_2_6_HEIGHT - 1 - y;
-            *out_y = x;
+// FONT_LAYOUT_COLUMNS_LSB_TOP: transpose the columns into glyph_scratch
+static const uint8_t *glyph_source_columns(const font_t *font, uint32_t glyph) {
+    const uint8_t *cols = font->data + (size_t)glyph * font->bytes_per_glyph;
+    uint8_t col_bytes = (font->height + 7) / 8;
+    uint8_t stride = (font->width + 7) / 8;
+
+    memset(glyph_scratch, 0, (size_t)stride * font->height);
+    for (uint8_t col = 0; col < font->width; col++) {
+        for (uint8_t i = 0; i < col_bytes; i++) {
+            uint8_t bits = cols[col * col_bytes + i];
+            for (uint8_t row = i * 8; bits != 0 && row < font->height; row++, bits >>= 1) {
+                if (bits & 1) {
+                    glyph_scratch[row * stride + col / 8] |= 0x80 >> (col % 8);
+                }
+            }
+        }
+    }
+    return glyph_scratch;
+}
+
+// FONT_LAYOUT_PACK: decoded by the pack's own cache
+static const uint8_t *glyph_source_pack(const font_t *font, uint32_t glyph) {
+    return font_pack_glyph(font->pack, glyph);
+}
+
+static bool glyph_run_init(glyph_run_t *run, const font_t *font, uint8_t color, uint8_t scale,
+                           const glyph_clip_t *clip) {
+    if (font == NULL || scale == 0) {
+        return false;
+    }
+    switch (font->layout) {
+        case FONT_LAYOUT_ROWS_MSB_LEFT:
+            run->source = glyph_source_rows;
             break;
-        case ORIENTATION_180: // 180°
-            *out_x = SCREEN_2_6_WIDTH - 1 - x;
-            *out_y = SCREEN_2_6_HEIGHT - 1 - y;
+        case FONT_LAYOUT_COLUMNS_LSB_TOP:
+            if ((size_t)((font->width + 7) / 8) * font->height > GLYPH_SCRATCH_BYTES) {
+                ESP_LOGE("epaper", "Font %s is too big for the glyph scratch buffer", font->name);
+                return false;
+            }
+            run->source = glyph_source_columns;
             break;
-        case ORIENTATION_270: // 270° clockwise (90° counter-clockwise)
-            *out_x = y;
-            *out_y = SCREEN_2_6_WIDTH - 1 - x;
+        case FONT_LAYOUT_PACK:
+            if (!font_pack_load(font->pack)) {
+                return false;
+            }
+            run->source = glyph_source_pack;
             break;
         default:
-            *out_x = x;
-            *out_y = y;
-            break;
+            ESP_LOGE("epaper", "Font %s has an unknown layout %d", font->name, font->layout);
+            return false;
     }
+    run->font = font;
+    run->color = color;
+    run->scale = scale;
+    run->clip = clip;
+    return true;
 }
 
-// Draw a single character to the framebuffer
-// x, y: top-left corner of character
-// c: character to draw
-// color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
-// scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_char(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
-    // Check if character is in font range
-    if (c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
-        c = '?'; // Replace unknown chars with question mark
+// Font pixel (col, row) of a row bitmap
+static inline bool glyph_pixel(const uint8_t *rows, const font_metrics_t *m, uint8_t col, uint8_t row) {
+    return rows[row * ((m->width + 7) / 8) + col / 8] & (0x80 >> (col % 8));
+}
+
+// Position of pixel (lx, ly) of a w x h logical cell within the cell's panel rectangle
+static inline void glyph_rotate(uint16_t lx, uint16_t ly, uint16_t w, uint16_t h, uint16_t *rx, uint16_t *ry) {
+    switch (draw_rotation) {
+        case ORIENTATION_90:  *rx = h - 1 - ly; *ry = lx; break;
+        case ORIENTATION_180: *rx = w - 1 - lx; *ry = h - 1 - ly; break;
+        case ORIENTATION_270: *rx = ly; *ry = w - 1 - lx; break;
+        default:              *rx = lx; *ry = ly; break;
     }
+}
 
-    // Get font data for this character
-    const uint8_t *glyph = font5x7[c - FONT_FIRST_CHAR];
+// Cached panel bitmap of a glyph, NULL when it is too big to cache
+static const glyph_entry_t *glyph_lookup(const glyph_run_t *run, uint32_t glyph, const font_metrics_t *m) {
+    const font_t *font = run->font;
+    uint8_t scale = run->scale;
+    uint16_t w = m->width * scale;
+    uint16_t h = m->height * scale;
+    uint16_t pw = w, ph = h;
+    if (draw_rotation == ORIENTATION_90 || draw_rotation == ORIENTATION_270) {
+        pw = h;
+        ph = w;
+    }
+    uint16_t stride = (pw + 7) / 8;
+    uint32_t size = (uint32_t)stride * ph;
+    if (size > GLYPH_CACHE_MAX_BYTES) {
+        return NULL;
+    }
 
-    // Draw each column of the character
-    for (uint8_t col = 0; col < FONT_WIDTH; col++) {
-        uint8_t column_data = glyph[col];
+    uint32_t key = 1u << 31 | (uint32_t)draw_rotation << 12 | scale;
+    uint32_t set = (((key ^ glyph << 11 ^ (uint32_t)(uintptr_t)font) * 2654435761u) >> 16) %
+                   (GLYPH_CACHE_SLOTS / GLYPH_CACHE_WAYS);
+    glyph_entry_t *ways = &glyph_cache[set * GLYPH_CACHE_WAYS];
+    glyph_entry_t *e = &ways[0];
+    glyph_cache_clock++;
+    for (uint8_t i = 0; i < GLYPH_CACHE_WAYS; i++) {
+        if (ways[i].key == key && ways[i].glyph == glyph && ways[i].font == font) {
+            ways[i].used = glyph_cache_clock;
+            return &ways[i];
+        }
+        if (ways[i].used < e->used) {
+            e = &ways[i]; // Least recently used way gets replaced
+        }
+    }
 
-        // Draw each row (bit) in this column
-        for (uint8_t row = 0; row < FONT_HEIGHT; row++) {
-            if (column_data & (1 << row)) {
-                // Pixel is set - draw it (scaled)
+    const uint8_t *rows = run->source(font, glyph);
+    if (rows == NULL) {
+        return NULL;
+    }
+    if (e->capacity < size) {
+        if (glyph_cache_bytes - e->capacity + size > GLYPH_CACHE_BUDGET) {
+            return NULL;
+        }
+        uint8_t *bits = (uint8_t*)realloc(e->bits, size);
+        if (bits == NULL) {
+            return NULL;
+        }
+        glyph_cache_bytes += size - e->capacity;
+        e->bits = bits;
+        e->capacity = size;
+    }
+    e->used = glyph_cache_clock;
+    e->font = font;
+    e->glyph = glyph;
+    e->key = key;
+    e->w = pw;
+    e->h = ph;
+    e->stride = stride;
+    memset(e->bits, 0, size);
+
+    for (uint8_t row = 0; row < m->height; row++) {
+        for (uint8_t col = 0; col < m->width; col++) {
+            if (!glyph_pixel(rows, m, col, row)) {
+                continue;
+            }
+            for (uint8_t sy = 0; sy < scale; sy++) {
                 for (uint8_t sx = 0; sx < scale; sx++) {
-                    for (uint8_t sy = 0; sy < scale; sy++) {
-                        uint16_t px = x + (col * scale) + sx;
-                        uint16_t py = y + (row * scale) + sy;
-
-                        // Draw single pixel using epaper_rect (1x1 rectangle)
-                        if (px < SCREEN_2_6_WIDTH && py < SCREEN_2_6_HEIGHT) {
-                            epaper_rect(px, py, 1, 1, color);
-                        }
-                    }
+                    uint16_t rx, ry;
+                    glyph_rotate(col * scale + sx, row * scale + sy, w, h, &rx, &ry);
+                    e->bits[ry * stride + rx / 8] |= 0x80 >> (rx % 8);
                 }
             }
         }
     }
+    return e;
 }
 
-// Draw a text string to the framebuffer (uses global orientation)
-// x, y: top-left corner of first character
-// text: null-terminated string
-// color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
-// scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_text(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
-    if (text == NULL) return;
-
-    uint8_t orientation = screen_orientation;
-    uint16_t char_width = (FONT_WIDTH + 1) * scale;
-
-    // For rotated text, calculate text length and adjust starting position
-    uint16_t cursor_x = x;
-    uint16_t cursor_y = y;
-    if (orientation != ORIENTATION_0) {
-        const char *temp = text;
-        uint16_t char_count = 0;
-        while (*temp) {
-            if ((unsigned char)*temp == 0xC2 || (unsigned char)*temp == 0xC3) {
-                temp += 2;
-                char_count++;
-            } else if (*temp == '\n' || *temp == '\r') {
-                temp++;
-            } else {
-                temp++;
-                char_count++;
+// OR/AND a panel bitmap with its top-left at (px, py) into both planes
+static void glyph_blit(const glyph_entry_t *g, int32_t px, int32_t py, const glyph_clip_t *clip, uint8_t color) {
+    uint8_t bw = epaper_color_bw(color);
+    uint8_t red = epaper_color_red(color);
+    int32_t xb = px >> 3;   // Floor, px may be negative
+    uint8_t shift = px & 7;
+    int32_t cb0 = clip->x0 / 8, cb1 = clip->x1 / 8;
+    uint8_t cmask0 = 0xFF >> (clip->x0 % 8);
+    uint8_t cmask1 = 0xFF << (7 - clip->x1 % 8);
+
+    // Destination bytes k0..k1 (relative to xb) are inside the clip
+    int32_t k0 = cb0 > xb ? cb0 - xb : 0;
+    int32_t k1 = cb1 < xb + g->stride ? cb1 - xb : g->stride;
+    int32_t r0 = clip->y0 > py ? clip->y0 - py : 0;
+    int32_t r1 = clip->y1 < py + g->h - 1 ? clip->y1 - py : g->h - 1;
+
+    for (int32_t r = r0; r <= r1; r++) {
+        const uint8_t *src = g->bits + r * g->stride;
+        uint8_t *pb = draw_bw + (size_t)(py + r) * fb_stride + xb;
+        uint8_t *pr = draw_red + (size_t)(py + r) * fb_stride + xb;
+
+        // Destination byte k takes the low bits of source byte k-1 and the high bits of byte k
+        for (int32_t k = k0; k <= k1; k++) {
+            uint8_t m = (k < g->stride) ? (uint8_t)(src[k] >> shift) : 0;
+            if (k > 0 && shift) {
+                m |= (uint8_t)(src[k - 1] << (8 - shift));
             }
-        }
-        switch (orientation) {
-            case ORIENTATION_90:
-                cursor_y = y + (char_count * char_width);
-                break;
-            case ORIENTATION_180:
-                cursor_x = x + (char_count * char_width);
-                break;
-            case ORIENTATION_270:
-                cursor_y = y + (char_count * char_width);
-                break;
-        }
-    }
-
-    // Calculate character advancement direction
-    int16_t dx = 0, dy = 0;
-    switch (orientation) {
-        case ORIENTATION_0:   dx = char_width; dy = 0; break;
-        case ORIENTATION_90:  dx = 0; dy = char_width; break;
-        case ORIENTATION_180: dx = -char_width; dy = 0; break;
-        case ORIENTATION_270: dx = 0; dy = -char_width; break;
-    }
-
-    while (*text) {
-        uint8_t c;
-        bool is_utf8 = false;
-
-        if ((unsigned char)*text == 0xC2 && (unsigned char)*(text + 1) == 0xB0) {
-            c = 127;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA9) {
-            c = 128;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA8) {
-            c = 129;
-            is_utf8 = true;
-        } else if (*text == '\n' || *text == '\r') {
-            text++;
-            continue;
-        } else {
-            c = *text;
-        }
-
-        if (c >= FONT_FIRST_CHAR && c <= FONT_LAST_CHAR) {
-            const uint8_t *char_data = font5x7[c - FONT_FIRST_CHAR];
-
-            for (uint8_t col = 0; col < FONT_WIDTH; col++) {
-                uint8_t actual_col = (orientation == ORIENTATION_180) ? (FONT_WIDTH - 1 - col) : col;
-                uint8_t column = char_data[actual_col];
-
-                for (uint8_t row = 0; row < FONT_HEIGHT; row++) {
-                    uint8_t actual_row = (orientation == ORIENTATION_180) ? (FONT_HEIGHT - 1 - row) : row;
-                    if (column & (1 << actual_row)) {
-                        for (uint8_t sy = 0; sy < scale; sy++) {
-                            for (uint8_t sx = 0; sx < scale; sx++) {
-                                uint16_t px = cursor_x + col * scale + sx;
-                                uint16_t py = cursor_y + row * scale + sy;
-                                uint16_t out_x, out_y;
-                                transform_coordinates(px, py, orientation, &out_x, &out_y);
-                                epaper_draw_pixel_direct(out_x, out_y, color);
-                            }
-                        }
-                    }
-                }
+            if (m == 0) {
+                continue;
             }
+            if (xb + k == cb0) m &= cmask0;
+            if (xb + k == cb1) m &= cmask1;
+            pb[k] = (pb[k] & ~m) | (bw & m);
+            pr[k] = (pr[k] & ~m) | (red & m);
         }
-
-        cursor_x += dx;
-        cursor_y += dy;
-        text += is_utf8 ? 2 : 1;
     }
 }
 
-// ========== 6x12 Font Rendering (medium size, good balance) ==========
-
-// Draw a single character using 6x12 font to the framebuffer
-// x, y: top-left corner of character
-// c: character to draw
-// color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
-// scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_char_6x12(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
-    // Check if character is in font range
-    if (c < FONT6X12_FIRST_CHAR || c > FONT6X12_LAST_CHAR) {
-        c = '?'; // Replace unknown chars with question mark
+// Draw one glyph cell at logical (x, y), clipped to the run's panel rectangle
+static void glyph_draw(const glyph_run_t *run, uint32_t glyph, const font_metrics_t *m, int32_t x, int32_t y) {
+    const glyph_clip_t *clip = run->clip;
+    uint8_t scale = run->scale;
+    if (m->width == 0) {
+        return; // Blank glyph (space)
     }
-
-    // Get font data for this character
-    const uint8_t *glyph = font6x12[c - FONT6X12_FIRST_CHAR];
-
-    // Draw each row of the character
-    for (uint8_t row = 0; row < FONT6X12_HEIGHT; row++) {
-        uint8_t row_data = glyph[row];
-
-        // Draw each column (bit) in this row
-        for (uint8_t col = 0; col < FONT6X12_WIDTH; col++) {
-            if (row_data & (0x80 >> col)) {
-                // Pixel is set - draw it (scaled)
-                for (uint8_t sx = 0; sx < scale; sx++) {
-                    for (uint8_t sy = 0; sy < scale; sy++) {
-                        uint16_t px = x + (col * scale) + sx;
-                        uint16_t py = y + (row * scale) + sy;
-
-                        // Draw single pixel using epaper_rect (1x1 rectangle)
-                        if (px < SCREEN_2_6_WIDTH && py < SCREEN_2_6_HEIGHT) {
-                            epaper_rect(px, py, 1, 1, color);
-                        }
-                    }
-                }
-            }
-        }
+    int32_t px0, py0, px1, py1;
+    logical_to_fb(x, y, m->width * scale, m->height * scale, &px0, &py0, &px1, &py1);
+    if (px1 < clip->x0 || px0 > clip->x1 || py1 < clip->y0 || py0 > clip->y1) {
+        return;
     }
-}
 
-// Draw a text string using 6x12 font to the framebuffer (uses global orientation)
-// x, y: top-left corner of first character
-// text: null-terminated string
-// color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
-// scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_text_6x12(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
-    if (text == NULL) return;
+    const glyph_entry_t *g = glyph_lookup(run, glyph, m);
+    if (g != NULL) {
+        glyph_blit(g, px0, py0, clip, run->color);
+        return;
+    }
 
-    uint8_t orientation = screen_orientation;
-    uint16_t char_width = (FONT6X12_WIDTH + 1) * scale;
-
-    // For rotated text, calculate text length and adjust starting position
-    uint16_t cursor_x = x;
-    uint16_t cursor_y = y;
-    if (orientation != ORIENTATION_0) {
-        const char *temp = text;
-        uint16_t char_count = 0;
-        while (*temp) {
-            if ((unsigned char)*temp == 0xC2 || (unsigned char)*temp == 0xC3) {
-                temp += 2;
-                char_count++;
-            } else if (*temp == '\n' || *temp == '\r') {
-                temp++;
-            } else {
-                temp++;
-                char_count++;
+    // Too big for the cache: every font pixel is a scale x scale block
+    const uint8_t *rows = run->source(run->font, glyph);
+    if (rows == NULL) {
+        return;
+    }
+    for (uint8_t row = 0; row < m->height; row++) {
+        for (uint8_t col = 0; col < m->width; col++) {
+            if (!glyph_pixel(rows, m, col, row)) {
+                continue;
             }
-        }
-        switch (orientation) {
-            case ORIENTATION_90:
-                cursor_y = y + (char_count * char_width);
-                break;
-            case ORIENTATION_180:
-                cursor_x = x + (char_count * char_width);
-                break;
-            case ORIENTATION_270:
-                cursor_y = y + (char_count * char_width);
-                break;
-        }
-    }
-
-    // Calculate character advancement direction
-    int16_t dx = 0, dy = 0;
-    switch (orientation) {
-        case ORIENTATION_0:   dx = char_width; dy = 0; break;
-        case ORIENTATION_90:  dx = 0; dy = char_width; break;
-        case ORIENTATION_180: dx = -char_width; dy = 0; break;
-        case ORIENTATION_270: dx = 0; dy = -char_width; break;
-    }
-
-    while (*text) {
-        uint8_t c;
-        bool is_utf8 = false;
-
-        if ((unsigned char)*text == 0xC2 && (unsigned char)*(text + 1) == 0xB0) {
-            c = 127;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA9) {
-            c = 128;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA8) {
-            c = 129;
-            is_utf8 = true;
-        } else if (*text == '\n' || *text == '\r') {
-            text++;
-            continue;
-        } else {
-            c = *text;
-        }
-
-        if (c >= FONT6X12_FIRST_CHAR && c <= FONT6X12_LAST_CHAR) {
-            const uint8_t *char_data = font6x12[c - FONT6X12_FIRST_CHAR];
-
-            for (uint8_t row = 0; row < FONT6X12_HEIGHT; row++) {
-                uint8_t actual_row = (orientation == ORIENTATION_180) ? (FONT6X12_HEIGHT - 1 - row) : row;
-                uint8_t line = char_data[actual_row];
-
-                for (uint8_t col = 0; col < FONT6X12_WIDTH; col++) {
-                    uint8_t actual_col = (orientation == ORIENTATION_180) ? (FONT6X12_WIDTH - 1 - col) : col;
-                    if (line & (1 << actual_col)) {
-                        for (uint8_t sy = 0; sy < scale; sy++) {
-                            for (uint8_t sx = 0; sx < scale; sx++) {
-                                uint16_t px = cursor_x + col * scale + sx;
-                                uint16_t py = cursor_y + row * scale + sy;
-                                uint16_t out_x, out_y;
-                                transform_coordinates(px, py, orientation, &out_x, &out_y);
-                                epaper_draw_pixel_direct(out_x, out_y, color);
-                            }
-                        }
-                    }
-                }
+            int32_t bx0, by0, bx1, by1;
+            logical_to_fb(x + col * scale, y + row * scale, scale, scale, &bx0, &by0, &bx1, &by1);
+            if (bx0 < clip->x0) bx0 = clip->x0;
+            if (by0 < clip->y0) by0 = clip->y0;
+            if (bx1 > clip->x1) bx1 = clip->x1;
+            if (by1 > clip->y1) by1 = clip->y1;
+            if (bx0 <= bx1 && by0 <= by1) {
+                fill_panel_rect(bx0, by0, bx1, by1, run->color);
             }
         }
-
-        cursor_x += dx;
-        cursor_y += dy;
-        text += is_utf8 ? 2 : 1;
     }
 }
 
-// ========== 8x16 Font Rendering (cleaner, more readable) ==========
+// The whole framebuffer in its current layout, or the clip mapped onto it.
+// Returns false when nothing can be drawn.
+static bool glyph_clip_screen(glyph_clip_t *gc) {
+    if (draw_clip.valid) {
+        const region_t *c = &draw_clip;
+        return transform_rect(c->x0, c->y0, c->x1 - c->x0 + 1, c->y1 - c->y0 + 1, &gc->x0, &gc->y0, &gc->x1, &gc->y1);
+    }
+    *gc = (glyph_clip_t){ 0, 0, fb_width - 1, fb_height - 1 };
+    return true;
+}
 
-// Draw a single character using 8x16 font to the framebuffer
+// Draw a single character to the framebuffer (uses global orientation)
 // x, y: top-left corner of character
-// c: character to draw
+// c: code point (Latin-1), unknown ones are drawn as '?'
 // color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
 // scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_char_8x16(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
-    // Check if character is in font range
-    if (c < FONT8X16_FIRST_CHAR || c > FONT8X16_LAST_CHAR) {
-        c = '?'; // Replace unknown chars with question mark
+void epaper_draw_char_font(uint16_t x, uint16_t y, uint8_t c, const font_t *font, uint8_t color, uint8_t scale) {
+    if (!framebuffer_ready()) {
+        return;
     }
 
-    // Get font data for this character
-    const uint8_t *glyph = font8x16[c - FONT8X16_FIRST_CHAR];
-
-    // Draw each row of the character
-    for (uint8_t row = 0; row < FONT8X16_HEIGHT; row++) {
-        uint8_t row_data = glyph[row];
-
-        // Draw each column (bit) in this row
-        for (uint8_t col = 0; col < FONT8X16_WIDTH; col++) {
-            if (row_data & (0x80 >> col)) {
-                // Pixel is set - draw it (scaled)
-                for (uint8_t sx = 0; sx < scale; sx++) {
-                    for (uint8_t sy = 0; sy < scale; sy++) {
-                        uint16_t px = x + (col * scale) + sx;
-                        uint16_t py = y + (row * scale) + sy;
-
-                        // Draw single pixel using epaper_rect (1x1 rectangle)
-                        if (px < SCREEN_2_6_WIDTH && py < SCREEN_2_6_HEIGHT) {
-                            epaper_rect(px, py, 1, 1, color);
-                        }
-                    }
-                }
-            }
-        }
+    glyph_clip_t gc;
+    glyph_run_t run;
+    if (!glyph_clip_screen(&gc) || !glyph_run_init(&run, font, color, scale, &gc)) {
+        return;
+    }
+    font_metrics_t m;
+    int32_t glyph = font_text_glyph(font, c, &m);
+    if (glyph < 0) {
+        return;
     }
+
+    dirty_add_logical(x, y, m.width * scale, m.height * scale);
+    glyph_draw(&run, glyph, &m, x, y);
 }
 
-// Draw a text string using 8x16 font to the framebuffer (uses global orientation)
+// Draw the first len bytes of a UTF-8 string to the framebuffer (uses global orientation)
 // x, y: top-left corner of first character
-// text: null-terminated string
+// text: UTF-8, stops early at a NUL
+// font: any font_t, see font.h
 // color: COLOR_BLACK, COLOR_RED, or COLOR_WHITE
 // scale: scaling factor (1 = normal, 2 = 2x, etc.)
-void epaper_draw_text_8x16(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
+void epaper_draw_text_span(uint16_t x, uint16_t y, const char *text, size_t len, const font_t *font,
+                           uint8_t color, uint8_t scale) {
     if (text == NULL) return;
+    const char *end = text + len;
 
-    uint8_t orientation = screen_orientation;
-    uint16_t char_width = (FONT8X16_WIDTH + 1) * scale;
-
-    // For rotated text, calculate text length and adjust starting position
-    uint16_t cursor_x = x;
-    uint16_t cursor_y = y;
-    if (orientation != ORIENTATION_0) {
-        const char *temp = text;
-        uint16_t char_count = 0;
-        while (*temp) {
-            if ((unsigned char)*temp == 0xC2 || (unsigned char)*temp == 0xC3) {
-                temp += 2;
-                char_count++;
-            } else if (*temp == '\n' || *temp == '\r') {
-                temp++;
-            } else {
-                temp++;
-                char_count++;
-            }
-        }
-        switch (orientation) {
-            case ORIENTATION_90:
-                cursor_y = y + (char_count * char_width);
-                break;
-            case ORIENTATION_180:
-                cursor_x = x + (char_count * char_width);
-                break;
-            case ORIENTATION_270:
-                cursor_y = y + (char_count * char_width);
-                break;
-        }
-    }
-
-    // Calculate character advancement direction
-    int16_t dx = 0, dy = 0;
-    switch (orientation) {
-        case ORIENTATION_0:   dx = char_width; dy = 0; break;
-        case ORIENTATION_90:  dx = 0; dy = char_width; break;
-        case ORIENTATION_180: dx = -char_width; dy = 0; break;
-        case ORIENTATION_270: dx = 0; dy = -char_width; break;
-    }
-
-    while (*text) {
-        uint8_t c;
-        bool is_utf8 = false;
-
-        if ((unsigned char)*text == 0xC2 && (unsigned char)*(text + 1) == 0xB0) {
-            c = 127;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA9) {
-            c = 128;
-            is_utf8 = true;
-        } else if ((unsigned char)*text == 0xC3 && (unsigned char)*(text + 1) == 0xA8) {
-            c = 129;
-            is_utf8 = true;
-        } else if (*text == '\n' || *text == '\r') {
-            text++;
-            continue;
-        } else {
-            c = *text;
-        }
-
-        if (c >= FONT8X16_FIRST_CHAR && c <= FONT8X16_LAST_CHAR) {
-            const uint8_t *char_data = font8x16[c - FONT8X16_FIRST_CHAR];
-
-            for (uint8_t row = 0; row < FONT8X16_HEIGHT; row++) {
-                uint8_t actual_row = (orientation == ORIENTATION_180) ? (FONT8X16_HEIGHT - 1 - row) : row;
-                uint8_t line = char_data[actual_row];
-
-                for (uint8_t col = 0; col < FONT8X16_WIDTH; col++) {
-                    uint8_t actual_col = (orientation == ORIENTATION_180) ? (FONT8X16_WIDTH - 1 - col) : col;
-                    if (line & (1 << actual_col)) {
-                        for (uint8_t sy = 0; sy < scale; sy++) {
-                            for (uint8_t sx = 0; sx < scale; sx++) {
-                                uint16_t px = cursor_x + col * scale + sx;
-                                uint16_t py = cursor_y + row * scale + sy;
-                                uint16_t out_x, out_y;
-                                transform_coordinates(px, py, orientation, &out_x, &out_y);
-                                epaper_draw_pixel_direct(out_x, out_y, color);
-                            }
-                        }
-                    }
-                }
-            }
+    if (!framebuffer_ready()) {
+        return;
+    }
+    glyph_clip_t gc;
+    glyph_run_t run;
+    if (font == NULL || !glyph_clip_screen(&gc) || !glyph_run_init(&run, font, color, scale, &gc)) {
+        return;
+    }
+
+    // Glyphs advance along logical x in every orientation, like any other drawing;
+    // glyph_draw() rotates each cell onto the framebuffer
+    font_metrics_t m;
+    int32_t cursor_x = x;
+    while (text < end && *text) {
+        uint32_t c = font_next_code(&text);
+        if (c == '\n' || c == '\r') {
+            continue; // Line breaks take no cell
         }
 
-        cursor_x += dx;
-        cursor_y += dy;
-        text += is_utf8 ? 2 : 1;
+        // Characters the font lacks are drawn as '?', or left blank without one
+        uint16_t advance = font->advance;
+        int32_t glyph = font_text_glyph(font, c, &m);
+        if (glyph >= 0) {
+            dirty_add_logical(cursor_x, y, m.width * scale, m.height * scale);
+            glyph_draw(&run, glyph, &m, cursor_x, y);
+            advance = m.advance;
+        }
+        cursor_x += advance * scale;
     }
 }
 
+// Draw a text string to the framebuffer (uses global orientation), see epaper_draw_text_span()
+void epaper_draw_text_font(uint16_t x, uint16_t y, const char *text, const font_t *font, uint8_t color, uint8_t scale) {
+    if (text == NULL) return;
+    epaper_draw_text_span(x, y, text, strlen(text), font, color, scale);
+}
+
+// ========== Built-in fonts ==========
+
+void epaper_draw_char(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
+    epaper_draw_char_font(x, y, (uint8_t)c, &font_5x8, color, scale);
+}
+
+void epaper_draw_text(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
+    epaper_draw_text_font(x, y, text, &font_5x8, color, scale);
+}
+
+void epaper_draw_char_6x12(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
+    epaper_draw_char_font(x, y, (uint8_t)c, &font_6x12, color, scale);
+}
+
+void epaper_draw_text_6x12(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
+    epaper_draw_text_font(x, y, text, &font_6x12, color, scale);
+}
+
+void epaper_draw_char_8x16(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale) {
+    epaper_draw_char_font(x, y, (uint8_t)c, &font_8x16, color, scale);
+}
+
+void epaper_draw_text_8x16(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale) {
+    epaper_draw_text_font(x, y, text, &font_8x16, color, scale);
+}
@@ -2,8 +2,11 @@
 #define EPAPER_H
 
 #include "epaper_utils.h"
+#include "font.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "esp_err.h"
 
 #define SCREEN_2_6_WIDTH 152
 #define SCREEN_2_6_HEIGHT 296
@@ -17,9 +20,25 @@ void epaper_sendIndexData(uint8_t index, const uint8_t *data, uint32_t len);
 void epaper_softReset(void);
 void epaper_waitBusy(void);
 
+// BUSY period statistics, per command (0x04 power on, 0x02 power off,
+// 0x12 refresh; any other command shares one slot)
+#define EPAPER_BUSY_HIST_BUCKETS 16
+typedef struct {
+    uint32_t count;
+    uint32_t timeouts;
+    uint32_t missed;   // BUSY did not rise after the command, not counted as a period
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[EPAPER_BUSY_HIST_BUCKETS]; // [0] < 1 ms, [i] 2^(i-1)..2^i ms, last is open-ended
+} epaper_busy_stats_t;
+
+void epaper_set_busy_timeout(uint32_t timeout_ms);
+void epaper_get_busy_stats(uint8_t cmd, epaper_busy_stats_t *stats);
+
 void epaper_send_command(uint8_t cmd);
 void epaper_send_data(uint8_t data);
-void epaper_send_color(uint8_t index, const uint8_t data, uint32_t len);
+void epaper_send_color(uint8_t index, const uint8_t data, uint32_t len); // len in bytes
 
 void epaper_clearDisplay(void);
 void epaper_fill(uint8_t color);
@@ -33,13 +52,114 @@ void epaper_DCDC_powerOn(void);
 void epaper_DCDC_powerOff(void);
 
 void epaper_send_buffer(const uint8_t *buffer, size_t length);
+void epaper_send_plane(uint8_t index, const uint8_t *buffer, size_t length);
+
+// Frame transfer statistics (filled by epaper_display_update)
+typedef struct {
+    uint32_t bytes;         // Bytes clocked out, commands included
+    uint32_t transactions;  // SPI transactions issued
+    uint32_t duration_us;   // Time spent transmitting
+} epaper_transfer_stats_t;
+
+void epaper_set_bulk_transfer(uint8_t enable); // 1 = DMA whole planes (default), 0 = byte per transaction
+void epaper_get_frame_stats(epaper_transfer_stats_t *stats);
+void epaper_get_fill_stats(epaper_transfer_stats_t *stats);  // Last epaper_fill()/epaper_send_color()
+
+// Asynchronous transport: build a command/data sequence, submit it as queued
+// DMA transactions and keep working while it is clocked out.
+// Data buffers longer than 4 bytes are not copied: they must be DMA-capable and
+// stay untouched until the sequence completes. A timeout of 0 waits forever.
+void epaper_async_begin(void);
+esp_err_t epaper_async_command(uint8_t cmd);
+esp_err_t epaper_async_data(const uint8_t *data, size_t len);
+esp_err_t epaper_async_submit(void);
+esp_err_t epaper_async_wait(uint32_t timeout_ms);
+bool epaper_async_busy(void);
 
 // Display pixel
-void epaper_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t color);
 void epaper_set_partial_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 void epaper_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color);
+
+// Vector shapes - use the global orientation and may reach past the screen edges.
+// A thickness of 0 fills the shape (arcs: a pie slice), lines are at least 1 pixel wide.
+#define EPAPER_POLYGON_MAX_POINTS 32
+void epaper_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t thickness, uint8_t color);
+void epaper_round_rect(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t radius,
+                       uint8_t thickness, uint8_t color);  // radius 0 = square corners
+void epaper_circle(int16_t cx, int16_t cy, uint16_t r, uint8_t thickness, uint8_t color);
+// Degrees clockwise from 3 o'clock, drawn clockwise from start to end (0 to 360 = full ring)
+void epaper_arc(int16_t cx, int16_t cy, uint16_t r, uint16_t start, uint16_t end,
+                uint8_t thickness, uint8_t color);
+void epaper_polygon(const int16_t *points, uint16_t count, uint8_t color);  // Filled, convex, x/y pairs
+
+// One row of w pixels from packed planes (MSB = leftmost, set = black / red), global orientation
+void epaper_draw_row(int16_t x, int16_t y, uint16_t w, const uint8_t *bw, const uint8_t *red);
+
+// Limit drawing to a logical rectangle until epaper_reset_clip(). Applies to
+// rectangles, shapes, rows and text, not to clears and bitmaps.
+void epaper_set_clip(int16_t x, int16_t y, uint16_t w, uint16_t h);
+void epaper_reset_clip(void);
+
 void epaper_display_update(void); // Send framebuffer to display
-void epaper_display_clear(void);  // Clear framebuffer
+esp_err_t epaper_display_update_async(void);            // Queue the frame planes, returns immediately
+esp_err_t epaper_display_update_wait(uint32_t timeout_ms); // Wait for the planes, then refresh (blocks ~15 s)
+void epaper_display_refresh(void); // Send only what changed (partial window refresh when small)
+
+// Two-phase versions of epaper_display_update()/epaper_display_refresh(): *_begin()
+// snapshots the framebuffers (false = nothing to send), after which drawing may
+// continue while epaper_display_flush() transfers the snapshot and waits for the panel
+bool epaper_display_update_begin(void);
+bool epaper_display_refresh_begin(void);
+void epaper_display_flush(void);
+
+// Refresh counters: full and partial refreshes done, refreshes skipped because
+// nothing changed, full updates shrunk to a partial window by the shadow-frame diff
+typedef struct {
+    uint32_t full;
+    uint32_t partial;
+    uint32_t skipped;
+    uint32_t shrunk;
+} epaper_refresh_stats_t;
+
+void epaper_get_refresh_stats(epaper_refresh_stats_t *stats);
+void epaper_set_partial_refresh(uint8_t enable); // 1 = allow partial refresh (default), 0 = always full
+void epaper_display_clear(void);  // Clear framebuffer (the selected layer, see below)
+
+// Layers: a background that starts as what the frame shows, and overlays on
+// top of it, each with its own planes. While a layer is selected, drawing and
+// epaper_display_clear() go to it (an overlay clears to transparent: pixels it
+// never drew show what is below). What changed in the layers is composited into
+// the framebuffers when an update or refresh begins, and only that region
+// reaches the panel. EPAPER_LAYER_NONE draws into the framebuffers directly,
+// where layers overwrite it once they change there; clearing it drops the layers.
+#define EPAPER_LAYER_BACKGROUND 0
+#define EPAPER_LAYER_COUNT      4     // Background plus three overlays, bottom to top
+#define EPAPER_LAYER_NONE       0xFF  // Default
+
+esp_err_t epaper_layer_select(uint8_t layer);  // Allocates on first use, ESP_ERR_NO_MEM
+uint8_t epaper_layer_get(void);
+void epaper_layers_free(void);  // The framebuffers keep what the layers showed
+
+// Packed bitmap streamed straight into the framebuffers. The window is in panel
+// coordinates (no orientation), x and w multiples of 8. The stream holds the
+// window's rows of each selected plane, MSB = leftmost pixel, BW plane first;
+// a set bit is black in the BW plane and red in the red plane. Callers fill the
+// span epaper_bitmap_span() points to (e.g. receive into it), then advance.
+#define EPAPER_PLANE_BW  0x01
+#define EPAPER_PLANE_RED 0x02
+
+typedef struct {
+    uint16_t x, y, w, h;
+    uint8_t planes;   // EPAPER_PLANE_* mask
+    size_t offset;    // Bytes of the stream written so far
+    size_t size;      // Bytes of the whole stream
+} epaper_bitmap_t;
+
+esp_err_t epaper_bitmap_begin(epaper_bitmap_t *bm, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                              uint8_t planes);  // ESP_ERR_INVALID_ARG for windows off the panel
+size_t epaper_bitmap_span(const epaper_bitmap_t *bm, uint8_t **dest);  // 0 when complete
+void epaper_bitmap_advance(epaper_bitmap_t *bm, size_t len);
+void epaper_bitmap_abort(const epaper_bitmap_t *bm);  // Fill an unfinished window white
 void epaper_test_partial_update(void); // Test if partial updates work
 
 void test_rect();
@@ -50,11 +170,21 @@ void test_rect();
 #define ORIENTATION_180 2  // Rotated 180°
 #define ORIENTATION_270 3  // Rotated 270° clockwise (90° counter-clockwise)
 
-// Global orientation functions
+// Global orientation functions. The logical screen is 152 x 296 at 0° and 180°,
+// 296 x 152 at 90° and 270°.
 void epaper_set_orientation(uint8_t orientation);
 uint8_t epaper_get_orientation(void);
+// 1 = keep the framebuffer in the 90°/270° orientation and rotate it into panel
+// order at flush time (default), 0 = always in panel order
+void epaper_set_native_orientation(uint8_t enable);
 
 // Text rendering functions - all use global orientation set by epaper_set_orientation()
+// Any font (see font.h)
+void epaper_draw_char_font(uint16_t x, uint16_t y, uint8_t c, const font_t *font, uint8_t color, uint8_t scale);
+void epaper_draw_text_font(uint16_t x, uint16_t y, const char *text, const font_t *font, uint8_t color, uint8_t scale);
+void epaper_draw_text_span(uint16_t x, uint16_t y, const char *text, size_t len, const font_t *font,
+                           uint8_t color, uint8_t scale);
+
 // 5x8 font (small, basic)
 void epaper_draw_char(uint16_t x, uint16_t y, char c, uint8_t color, uint8_t scale);
 void epaper_draw_text(uint16_t x, uint16_t y, const char *text, uint8_t color, uint8_t scale);
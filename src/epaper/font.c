@@ -0,0 +1,214 @@
+#include "font.h"
+#include <stddef.h>
+#include <string.h>
+#include "font5x7.h"
+#include "font6x12.h"
+#include "font8x16.h"
+#include "font_pack.h"
+
+// Glyphs after ASCII, in the same order in all three built-in fonts
+enum {
+    G_DEGREE = 95, G_E_ACUTE, G_E_GRAVE,
+    G_a_GRAVE, G_a_CIRC, G_a_UML, G_c_CEDIL, G_e_CIRC, G_e_UML, G_i_CIRC, G_i_UML,
+    G_o_CIRC, G_o_UML, G_u_GRAVE, G_u_CIRC, G_u_UML, G_y_UML, G_SHARP_S, G_oe,
+    G_A_GRAVE, G_A_CIRC, G_A_UML, G_C_CEDIL, G_E_GRAVE_CAP, G_E_ACUTE_CAP, G_E_CIRC, G_E_UML,
+    G_I_CIRC, G_I_UML, G_O_CIRC, G_O_UML, G_U_GRAVE, G_U_CIRC, G_U_UML, G_OE,
+    G_LAQUO, G_RAQUO, G_EURO,
+};
+
+#define G_ASCII(c) ((c) - ' ')
+
+// Code points above ASCII, sorted. Typographic quotes and dashes fall back on ASCII.
+static const font_range_t latin_ranges[] = {
+    { 0x00A0, 0x00A0, G_ASCII(' ') },      // No-break space
+    { 0x00AB, 0x00AB, G_LAQUO },
+    { 0x00B0, 0x00B0, G_DEGREE },
+    { 0x00BB, 0x00BB, G_RAQUO },
+    { 0x00C0, 0x00C0, G_A_GRAVE },
+    { 0x00C2, 0x00C2, G_A_CIRC },
+    { 0x00C4, 0x00C4, G_A_UML },
+    { 0x00C7, 0x00C7, G_C_CEDIL },
+    { 0x00C8, 0x00CB, G_E_GRAVE_CAP },     // È É Ê Ë
+    { 0x00CE, 0x00CF, G_I_CIRC },          // Î Ï
+    { 0x00D4, 0x00D4, G_O_CIRC },
+    { 0x00D6, 0x00D6, G_O_UML },
+    { 0x00D9, 0x00D9, G_U_GRAVE },
+    { 0x00DB, 0x00DC, G_U_CIRC },          // Û Ü
+    { 0x00DF, 0x00DF, G_SHARP_S },
+    { 0x00E0, 0x00E0, G_a_GRAVE },
+    { 0x00E2, 0x00E2, G_a_CIRC },
+    { 0x00E4, 0x00E4, G_a_UML },
+    { 0x00E7, 0x00E7, G_c_CEDIL },
+    { 0x00E8, 0x00E8, G_E_GRAVE },
+    { 0x00E9, 0x00E9, G_E_ACUTE },
+    { 0x00EA, 0x00EB, G_e_CIRC },          // ê ë
+    { 0x00EE, 0x00EF, G_i_CIRC },          // î ï
+    { 0x00F4, 0x00F4, G_o_CIRC },
+    { 0x00F6, 0x00F6, G_o_UML },
+    { 0x00F9, 0x00F9, G_u_GRAVE },
+    { 0x00FB, 0x00FC, G_u_CIRC },          // û ü
+    { 0x00FF, 0x00FF, G_y_UML },
+    { 0x0152, 0x0152, G_OE },
+    { 0x0153, 0x0153, G_oe },
+    { 0x2013, 0x2014, G_ASCII('-') },      // En and em dash
+    { 0x2018, 0x2019, G_ASCII('\'') },    // Curly single quotes
+    { 0x201C, 0x201D, G_ASCII('"') },      // Curly double quotes
+    { 0x20AC, 0x20AC, G_EURO },
+};
+
+#define LATIN_RANGES .ranges = latin_ranges, .range_count = sizeof(latin_ranges) / sizeof(latin_ranges[0])
+
+const font_t font_5x8 = {
+    .name = "5x8",
+    .width = FONT_WIDTH,
+    .height = FONT_HEIGHT,
+    .advance = FONT_WIDTH + 1,
+    .first = FONT_FIRST_CHAR,
+    .last = FONT_LAST_CHAR,
+    .glyph_count = FONT_GLYPH_COUNT,
+    LATIN_RANGES,
+    .layout = FONT_LAYOUT_COLUMNS_LSB_TOP,
+    .bytes_per_glyph = sizeof(font5x7[0]),
+    .data = &font5x7[0][0],
+};
+
+const font_t font_6x12 = {
+    .name = "6x12",
+    .width = FONT6X12_WIDTH,
+    .height = FONT6X12_HEIGHT,
+    .advance = FONT6X12_WIDTH + 1,
+    .first = FONT6X12_FIRST_CHAR,
+    .last = FONT6X12_LAST_CHAR,
+    .glyph_count = FONT6X12_GLYPH_COUNT,
+    LATIN_RANGES,
+    .layout = FONT_LAYOUT_ROWS_MSB_LEFT,
+    .bytes_per_glyph = sizeof(font6x12[0]),
+    .data = &font6x12[0][0],
+};
+
+const font_t font_8x16 = {
+    .name = "8x16",
+    .width = FONT8X16_WIDTH,
+    .height = FONT8X16_HEIGHT,
+    .advance = FONT8X16_WIDTH + 1,
+    .first = FONT8X16_FIRST_CHAR,
+    .last = FONT8X16_LAST_CHAR,
+    .glyph_count = FONT8X16_GLYPH_COUNT,
+    LATIN_RANGES,
+    .layout = FONT_LAYOUT_ROWS_MSB_LEFT,
+    .bytes_per_glyph = sizeof(font8x16[0]),
+    .data = &font8x16[0][0],
+};
+
+static const font_t *fonts[FONT_MAX] = {
+    [FONT_ID_5X8]  = &font_5x8,
+    [FONT_ID_6X12] = &font_6x12,
+    [FONT_ID_8X16] = &font_8x16,
+};
+static uint8_t font_count = FONT_ID_8X16 + 1;
+
+const font_t *font_get(uint8_t id) {
+    if (id >= font_count) {
+        return NULL;
+    }
+    return fonts[id];
+}
+
+int font_find(const char *name) {
+    for (uint8_t i = 0; i < font_count; i++) {
+        if (strcmp(fonts[i]->name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int font_register(const font_t *font) {
+    if (font_count >= FONT_MAX) {
+        return -1;
+    }
+    fonts[font_count] = font;
+    return font_count++;
+}
+
+int32_t font_glyph_lookup(const font_t *font, uint32_t code) {
+    if (font->layout == FONT_LAYOUT_PACK) {
+        return font_pack_find(font->pack, code);
+    }
+    int lo = 0, hi = font->range_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const font_range_t *r = &font->ranges[mid];
+        if (code < r->first) {
+            hi = mid - 1;
+        } else if (code > r->last) {
+            lo = mid + 1;
+        } else {
+            return r->glyph + (int32_t)(code - r->first);
+        }
+    }
+    return -1;
+}
+
+bool font_glyph_metrics(const font_t *font, uint32_t glyph, font_metrics_t *metrics) {
+    if (font->layout == FONT_LAYOUT_PACK) {
+        return font_pack_metrics(font->pack, glyph, metrics);
+    }
+    if (glyph >= font->glyph_count) {
+        return false;
+    }
+    metrics->width = font->width;
+    metrics->height = font->height;
+    metrics->advance = font->advance;
+    return true;
+}
+
+int32_t font_text_glyph(const font_t *font, uint32_t code, font_metrics_t *metrics) {
+    int32_t glyph = font_glyph_index(font, code);
+    if (glyph < 0 || !font_glyph_metrics(font, glyph, metrics)) {
+        glyph = font_glyph_index(font, '?');
+        if (glyph < 0 || !font_glyph_metrics(font, glyph, metrics)) {
+            return -1;
+        }
+    }
+    return glyph;
+}
+
+uint32_t font_utf8_next(const char **text) {
+    const uint8_t *s = (const uint8_t *)*text;
+    if (s[0] < 0x80) {
+        if (s[0] != 0) {
+            *text += 1;
+        }
+        return s[0];
+    }
+
+    // Lead byte: sequence length, payload bits and the smallest code it may encode
+    uint8_t len;
+    uint32_t code, min;
+    if (s[0] >= 0xC2 && s[0] <= 0xDF) {
+        len = 2; code = s[0] & 0x1F; min = 0x80;
+    } else if (s[0] >= 0xE0 && s[0] <= 0xEF) {
+        len = 3; code = s[0] & 0x0F; min = 0x800;
+    } else if (s[0] >= 0xF0 && s[0] <= 0xF4) {
+        len = 4; code = s[0] & 0x07; min = 0x10000;
+    } else {
+        *text += 1; // Stray continuation byte, C0/C1 or F5..FF
+        return FONT_REPLACEMENT_CHAR;
+    }
+
+    // A NUL is no continuation byte, so this stops at the end of the string
+    for (uint8_t i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *text += 1;
+            return FONT_REPLACEMENT_CHAR;
+        }
+        code = code << 6 | (s[i] & 0x3F);
+    }
+    if (code < min || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+        *text += 1;
+        return FONT_REPLACEMENT_CHAR;
+    }
+    *text += len;
+    return code;
+}
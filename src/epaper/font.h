@@ -0,0 +1,106 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// How a font stores its glyph bitmaps
+typedef enum {
+    FONT_LAYOUT_COLUMNS_LSB_TOP,  // (height + 7) / 8 bytes per column, bit 0 = top row
+    FONT_LAYOUT_ROWS_MSB_LEFT,    // (width + 7) / 8 bytes per row, MSB = leftmost pixel
+    FONT_LAYOUT_PACK,             // Font pack file, glyphs come from font_pack.h
+} font_layout_t;
+
+struct font_pack;
+
+// Code points first..last drawn with glyphs glyph, glyph + 1, ...
+typedef struct {
+    uint32_t first, last;
+    uint16_t glyph;
+} font_range_t;
+
+// Bitmap font: glyph_count glyphs, bytes_per_glyph apart in data. Code points
+// first..last are glyphs 0.. (ASCII for the built-in fonts), anything else is
+// looked up in the sorted ranges, or in the pack index for pack fonts.
+// Adding a font only takes one of these; the renderer reads nothing else.
+// Pack fonts fill in their sizes and range when the pack is loaded.
+typedef struct {
+    const char *name;
+    uint8_t width, height;     // Glyph cell in pixels (packs: widest glyph, line height)
+    uint8_t advance;           // Cursor step in pixels (cell plus spacing)
+    uint32_t first, last;      // Code points mapped straight to glyphs
+    uint16_t glyph_count;
+    const font_range_t *ranges;
+    uint16_t range_count;
+    uint8_t layout;            // font_layout_t
+    uint8_t bytes_per_glyph;
+    const uint8_t *data;
+    struct font_pack *pack;    // FONT_LAYOUT_PACK only
+} font_t;
+
+// One glyph: a width x height bitmap, top-aligned in the line
+typedef struct {
+    uint8_t width, height;
+    uint8_t advance;
+} font_metrics_t;
+
+// Font ids of the API ("font" field of text requests)
+#define FONT_ID_5X8   0
+#define FONT_ID_6X12  1
+#define FONT_ID_8X16  2
+
+#define FONT_MAX      8  // Built-in fonts and registered packs
+
+extern const font_t font_5x8;    // Small, basic
+extern const font_t font_6x12;   // Medium, clean
+extern const font_t font_8x16;   // Large, cleaner
+
+// Font for an API id, NULL when there is none
+const font_t *font_get(uint8_t id);
+
+// Id of the font called name, -1 when there is none
+int font_find(const char *name);
+
+// Add a font after the built-in ones, returns its id or -1 when the table is full
+int font_register(const font_t *font);
+
+// Drawn for bytes that are not valid UTF-8
+#define FONT_REPLACEMENT_CHAR 0xFFFD
+
+// Glyph for a code point outside first..last, -1 when the font has none
+int32_t font_glyph_lookup(const font_t *font, uint32_t code);
+
+// Glyph for a code point, -1 when the font has none. ASCII takes the first branch.
+static inline int32_t font_glyph_index(const font_t *font, uint32_t code) {
+    if (code >= font->first && code <= font->last) {
+        return (int32_t)(code - font->first);
+    }
+    return font_glyph_lookup(font, code);
+}
+
+// Size of a glyph (from font_glyph_index()), false when the font has none
+bool font_glyph_metrics(const font_t *font, uint32_t glyph, font_metrics_t *metrics);
+
+// Decode the next code point of a NUL-terminated UTF-8 string and step past it.
+// Malformed, overlong or truncated sequences give FONT_REPLACEMENT_CHAR and skip
+// one byte; the terminating NUL is never stepped over.
+uint32_t font_utf8_next(const char **text);
+
+// Next code point of a text, plain ASCII bytes skip the decoder. Like
+// font_utf8_next(), stays on the terminating NUL.
+static inline uint32_t font_next_code(const char **text) {
+    uint8_t c = (uint8_t)**text;
+    if (c < 0x80) {
+        if (c != 0) {
+            *text += 1;
+        }
+        return c;
+    }
+    return font_utf8_next(text);
+}
+
+// Glyph text drawing uses for code: the font's own, else its '?' (-1 when it has
+// neither). Fills in the glyph's metrics.
+int32_t font_text_glyph(const font_t *font, uint32_t code, font_metrics_t *metrics);
+
+#endif // FONT_H
@@ -1,9 +1,9 @@
 #include "font5x7.h"
 
-// 5x8 bitmap font for ASCII 32-126
+// 5x8 bitmap font for ASCII 32-126, then °, French/German letters, « » and €
 // Each byte represents one column (5 columns per character)
 // Bits 0-7 are used (8 rows), bit 7 is for descenders
-const uint8_t font5x7[][5] = {
+const uint8_t font5x7[FONT_GLYPH_COUNT][5] = {
     {0x00, 0x00, 0x00, 0x00, 0x00}, // (space)
     {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
     {0x00, 0x07, 0x00, 0x07, 0x00}, // "
@@ -100,6 +100,41 @@ const uint8_t font5x7[][5] = {
     {0x00, 0x41, 0x36, 0x08, 0x00}, // }
     {0x02, 0x01, 0x02, 0x04, 0x02}, // ~
     {0x00, 0x06, 0x09, 0x06, 0x00}, // ° (degree symbol)
-    {0x04, 0x3C, 0x54, 0x54, 0x18}, // é (e with acute)
-    {0x08, 0x3C, 0x54, 0x54, 0x18}, // è (e with grave)
+    {0x38, 0x54, 0x56, 0x55, 0x18}, // é (e with acute)
+    {0x38, 0x55, 0x56, 0x54, 0x18}, // è (e with grave)
+    {0x20, 0x55, 0x56, 0x78, 0x40}, // à (a with grave)
+    {0x20, 0x56, 0x55, 0x7A, 0x40}, // â (a with circumflex)
+    {0x20, 0x55, 0x54, 0x79, 0x40}, // ä (a with diaeresis)
+    {0x38, 0x44, 0xC4, 0x44, 0x28}, // ç (c with cedilla)
+    {0x38, 0x56, 0x55, 0x56, 0x18}, // ê (e with circumflex)
+    {0x38, 0x55, 0x54, 0x55, 0x18}, // ë (e with diaeresis)
+    {0x00, 0x46, 0x7D, 0x42, 0x00}, // î (i with circumflex)
+    {0x00, 0x45, 0x7C, 0x41, 0x00}, // ï (i with diaeresis)
+    {0x38, 0x46, 0x45, 0x46, 0x38}, // ô (o with circumflex)
+    {0x38, 0x45, 0x44, 0x45, 0x38}, // ö (o with diaeresis)
+    {0x3C, 0x41, 0x42, 0x20, 0x7C}, // ù (u with grave)
+    {0x3C, 0x42, 0x41, 0x22, 0x7C}, // û (u with circumflex)
+    {0x3C, 0x41, 0x40, 0x21, 0x7C}, // ü (u with diaeresis)
+    {0x4C, 0x91, 0x90, 0x91, 0x7C}, // ÿ (y with diaeresis)
+    {0x7E, 0x01, 0x49, 0x56, 0x20}, // ß (sharp s)
+    {0x38, 0x44, 0x38, 0x54, 0x58}, // œ (oe ligature)
+    {0x78, 0x15, 0x12, 0x14, 0x78}, // À (A with grave)
+    {0x78, 0x15, 0x13, 0x15, 0x78}, // Â (A with circumflex)
+    {0x78, 0x15, 0x12, 0x15, 0x78}, // Ä (A with diaeresis)
+    {0x3C, 0x42, 0xC2, 0x42, 0x24}, // Ç (C with cedilla)
+    {0x7E, 0x4B, 0x4A, 0x4A, 0x42}, // È (E with grave)
+    {0x7E, 0x4A, 0x4A, 0x4B, 0x42}, // É (E with acute)
+    {0x7E, 0x4B, 0x4B, 0x4B, 0x42}, // Ê (E with circumflex)
+    {0x7E, 0x4B, 0x4A, 0x4B, 0x42}, // Ë (E with diaeresis)
+    {0x00, 0x43, 0x7F, 0x43, 0x00}, // Î (I with circumflex)
+    {0x00, 0x43, 0x7E, 0x43, 0x00}, // Ï (I with diaeresis)
+    {0x3C, 0x43, 0x43, 0x43, 0x3C}, // Ô (O with circumflex)
+    {0x3C, 0x43, 0x42, 0x43, 0x3C}, // Ö (O with diaeresis)
+    {0x3E, 0x41, 0x40, 0x40, 0x3E}, // Ù (U with grave)
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // Û (U with circumflex)
+    {0x3E, 0x41, 0x40, 0x41, 0x3E}, // Ü (U with diaeresis)
+    {0x3E, 0x41, 0x7F, 0x49, 0x49}, // Œ (OE ligature)
+    {0x00, 0x10, 0x28, 0x10, 0x28}, // « (left guillemet)
+    {0x28, 0x10, 0x28, 0x10, 0x00}, // » (right guillemet)
+    {0x14, 0x3E, 0x55, 0x45, 0x41}, // € (euro sign)
 };
@@ -1,9 +1,9 @@
 #include "font6x12.h"
 
-// 6x12 bitmap font for ASCII 32-126
+// 6x12 bitmap font for ASCII 32-126, then °, French/German letters, « » and €
 // Each character is 12 bytes (12 rows of 6 pixels)
 // Cleaner than 5x8, more compact than 8x16
-const uint8_t font6x12[][12] = {
+const uint8_t font6x12[FONT6X12_GLYPH_COUNT][12] = {
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // (space)
     {0x00,0x00,0x20,0x20,0x20,0x20,0x20,0x20,0x00,0x20,0x00,0x00}, // !
     {0x00,0x28,0x28,0x28,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // "
@@ -100,6 +100,41 @@ const uint8_t font6x12[][12] = {
     {0x00,0x20,0x10,0x10,0x10,0x08,0x10,0x10,0x10,0x20,0x00,0x00}, // }
     {0x00,0x00,0x00,0x24,0x54,0x48,0x00,0x00,0x00,0x00,0x00,0x00}, // ~
     {0x00,0x00,0x38,0x44,0x44,0x38,0x00,0x00,0x00,0x00,0x00,0x00}, // ° (degree symbol)
-    {0x00,0x10,0x08,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // é (e with acute)
-    {0x00,0x08,0x10,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // è (e with grave)
+    {0x00,0x08,0x10,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // é (e with acute)
+    {0x00,0x20,0x10,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // è (e with grave)
+    {0x00,0x20,0x10,0x00,0x38,0x04,0x3C,0x44,0x3C,0x00,0x00,0x00}, // à (a with grave)
+    {0x00,0x10,0x28,0x00,0x38,0x04,0x3C,0x44,0x3C,0x00,0x00,0x00}, // â (a with circumflex)
+    {0x00,0x00,0x28,0x00,0x38,0x04,0x3C,0x44,0x3C,0x00,0x00,0x00}, // ä (a with diaeresis)
+    {0x00,0x00,0x00,0x00,0x38,0x44,0x40,0x44,0x38,0x10,0x20,0x00}, // ç (c with cedilla)
+    {0x00,0x10,0x28,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // ê (e with circumflex)
+    {0x00,0x00,0x28,0x00,0x38,0x44,0x7C,0x40,0x38,0x00,0x00,0x00}, // ë (e with diaeresis)
+    {0x00,0x10,0x28,0x00,0x30,0x10,0x10,0x10,0x38,0x00,0x00,0x00}, // î (i with circumflex)
+    {0x00,0x00,0x28,0x00,0x30,0x10,0x10,0x10,0x38,0x00,0x00,0x00}, // ï (i with diaeresis)
+    {0x00,0x10,0x28,0x00,0x38,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // ô (o with circumflex)
+    {0x00,0x00,0x28,0x00,0x38,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // ö (o with diaeresis)
+    {0x00,0x20,0x10,0x00,0x44,0x44,0x44,0x4C,0x34,0x00,0x00,0x00}, // ù (u with grave)
+    {0x00,0x10,0x28,0x00,0x44,0x44,0x44,0x4C,0x34,0x00,0x00,0x00}, // û (u with circumflex)
+    {0x00,0x00,0x28,0x00,0x44,0x44,0x44,0x4C,0x34,0x00,0x00,0x00}, // ü (u with diaeresis)
+    {0x00,0x00,0x28,0x00,0x44,0x44,0x44,0x4C,0x34,0x04,0x38,0x00}, // ÿ (y with diaeresis)
+    {0x00,0x00,0x30,0x48,0x48,0x50,0x48,0x44,0x58,0x00,0x00,0x00}, // ß (sharp s)
+    {0x00,0x00,0x00,0x00,0x58,0xA4,0xBC,0xA0,0x5C,0x00,0x00,0x00}, // œ (oe ligature)
+    {0x20,0x10,0x10,0x28,0x44,0x44,0x7C,0x44,0x44,0x00,0x00,0x00}, // À (A with grave)
+    {0x10,0x28,0x10,0x28,0x44,0x44,0x7C,0x44,0x44,0x00,0x00,0x00}, // Â (A with circumflex)
+    {0x28,0x00,0x10,0x28,0x44,0x44,0x7C,0x44,0x44,0x00,0x00,0x00}, // Ä (A with diaeresis)
+    {0x00,0x00,0x38,0x44,0x40,0x40,0x40,0x44,0x38,0x10,0x20,0x00}, // Ç (C with cedilla)
+    {0x20,0x10,0x7C,0x40,0x40,0x78,0x40,0x40,0x7C,0x00,0x00,0x00}, // È (E with grave)
+    {0x08,0x10,0x7C,0x40,0x40,0x78,0x40,0x40,0x7C,0x00,0x00,0x00}, // É (E with acute)
+    {0x10,0x28,0x7C,0x40,0x40,0x78,0x40,0x40,0x7C,0x00,0x00,0x00}, // Ê (E with circumflex)
+    {0x28,0x00,0x7C,0x40,0x40,0x78,0x40,0x40,0x7C,0x00,0x00,0x00}, // Ë (E with diaeresis)
+    {0x10,0x28,0x38,0x10,0x10,0x10,0x10,0x10,0x38,0x00,0x00,0x00}, // Î (I with circumflex)
+    {0x28,0x00,0x38,0x10,0x10,0x10,0x10,0x10,0x38,0x00,0x00,0x00}, // Ï (I with diaeresis)
+    {0x10,0x28,0x38,0x44,0x44,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // Ô (O with circumflex)
+    {0x28,0x00,0x38,0x44,0x44,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // Ö (O with diaeresis)
+    {0x20,0x10,0x44,0x44,0x44,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // Ù (U with grave)
+    {0x10,0x28,0x44,0x44,0x44,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // Û (U with circumflex)
+    {0x28,0x00,0x44,0x44,0x44,0x44,0x44,0x44,0x38,0x00,0x00,0x00}, // Ü (U with diaeresis)
+    {0x00,0x00,0x7C,0xA0,0xA0,0xBC,0xA0,0xA0,0x7C,0x00,0x00,0x00}, // Œ (OE ligature)
+    {0x00,0x00,0x00,0x00,0x14,0x28,0x50,0x28,0x14,0x00,0x00,0x00}, // « (left guillemet)
+    {0x00,0x00,0x00,0x00,0x50,0x28,0x14,0x28,0x50,0x00,0x00,0x00}, // » (right guillemet)
+    {0x00,0x00,0x1C,0x20,0x78,0x20,0x78,0x20,0x1C,0x00,0x00,0x00}, // € (euro sign)
 };
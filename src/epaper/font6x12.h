@@ -3,7 +3,7 @@
 
 #include <stdint.h>
 
-// 6x12 bitmap font for ASCII characters 32-126
+// 6x12 bitmap font for ASCII characters 32-126 and French/German letters
 // Each character is 12 bytes (12 rows of 6 pixels)
 // Good balance between readability and space
 
@@ -12,6 +12,7 @@ extern const uint8_t font6x12[][12];
 #define FONT6X12_WIDTH  6
 #define FONT6X12_HEIGHT 12
 #define FONT6X12_FIRST_CHAR 32   // Space
-#define FONT6X12_LAST_CHAR  129  // Extended characters (127=°, 128=é, 129=è)
+#define FONT6X12_LAST_CHAR  126  // Tilde, FIRST..LAST map straight to glyphs 0-94
+#define FONT6X12_GLYPH_COUNT 133  // Then °, accented letters, « » € (mapped in font.c)
 
 #endif // FONT6X12_H
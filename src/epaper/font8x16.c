@@ -1,9 +1,9 @@
 #include "font8x16.h"
 
-// 8x16 bitmap font for ASCII 32-126
+// 8x16 bitmap font for ASCII 32-126, then °, French/German letters, « » and €
 // Each character is 16 bytes (16 rows of 8 pixels)
 // More readable and cleaner than 5x7 font
-const uint8_t font8x16[][16] = {
+const uint8_t font8x16[FONT8X16_GLYPH_COUNT][16] = {
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // (space)
     {0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x3C,0x3C,0x18,0x18,0x00,0x18,0x18,0x00,0x00}, // !
     {0x00,0x00,0x00,0x66,0x66,0x66,0x24,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // "
@@ -100,6 +100,41 @@ const uint8_t font8x16[][16] = {
     {0x00,0x00,0x00,0x70,0x18,0x18,0x18,0x0E,0x18,0x18,0x18,0x18,0x70,0x00,0x00,0x00}, // }
     {0x00,0x00,0x00,0x76,0xDC,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // ~
     {0x00,0x00,0x38,0x44,0x44,0x44,0x38,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // ° (degree symbol)
-    {0x00,0x10,0x08,0x04,0x00,0x38,0x44,0xFE,0xC0,0xC0,0x44,0x38,0x00,0x00,0x00,0x00}, // é (e with acute)
-    {0x00,0x04,0x08,0x10,0x00,0x38,0x44,0xFE,0xC0,0xC0,0x44,0x38,0x00,0x00,0x00,0x00}, // è (e with grave)
+    {0x00,0x00,0x0C,0x18,0x30,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00}, // é (e with acute)
+    {0x00,0x00,0x60,0x30,0x18,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00}, // è (e with grave)
+    {0x00,0x00,0x60,0x30,0x18,0x00,0x78,0x0C,0x7C,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // à (a with grave)
+    {0x00,0x00,0x10,0x38,0x6C,0x00,0x78,0x0C,0x7C,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // â (a with circumflex)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0x78,0x0C,0x7C,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // ä (a with diaeresis)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x7C,0xC6,0xC0,0xC0,0xC0,0xC6,0x7C,0x18,0x30,0x00}, // ç (c with cedilla)
+    {0x00,0x00,0x10,0x38,0x6C,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00}, // ê (e with circumflex)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0x7C,0xC6,0xFE,0xC0,0xC0,0xC6,0x7C,0x00,0x00,0x00}, // ë (e with diaeresis)
+    {0x00,0x00,0x10,0x38,0x6C,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00}, // î (i with circumflex)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0x38,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00}, // ï (i with diaeresis)
+    {0x00,0x00,0x10,0x38,0x6C,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00}, // ô (o with circumflex)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0x7C,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00}, // ö (o with diaeresis)
+    {0x00,0x00,0x60,0x30,0x18,0x00,0xCC,0xCC,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // ù (u with grave)
+    {0x00,0x00,0x10,0x38,0x6C,0x00,0xCC,0xCC,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // û (u with circumflex)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0xCC,0xCC,0xCC,0xCC,0xCC,0xCC,0x76,0x00,0x00,0x00}, // ü (u with diaeresis)
+    {0x00,0x00,0x00,0x6C,0x6C,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0x7E,0x06,0x0C,0xF8,0x00}, // ÿ (y with diaeresis)
+    {0x00,0x00,0x00,0x78,0xCC,0xCC,0xD8,0xD8,0xCC,0xC6,0xC6,0xCC,0xD8,0x00,0x00,0x00}, // ß (sharp s)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x6C,0x92,0x92,0x9E,0x90,0x92,0x6C,0x00,0x00,0x00}, // œ (oe ligature)
+    {0x30,0x18,0x00,0x10,0x38,0x6C,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00}, // À (A with grave)
+    {0x10,0x28,0x00,0x10,0x38,0x6C,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00}, // Â (A with circumflex)
+    {0x6C,0x00,0x00,0x10,0x38,0x6C,0xC6,0xC6,0xFE,0xC6,0xC6,0xC6,0xC6,0x00,0x00,0x00}, // Ä (A with diaeresis)
+    {0x00,0x00,0x00,0x3C,0x66,0xC2,0xC0,0xC0,0xC0,0xC0,0xC2,0x66,0x3C,0x18,0x30,0x00}, // Ç (C with cedilla)
+    {0x30,0x18,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00}, // È (E with grave)
+    {0x18,0x30,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00}, // É (E with acute)
+    {0x10,0x28,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00}, // Ê (E with circumflex)
+    {0x6C,0x00,0x00,0xFE,0x66,0x62,0x68,0x78,0x68,0x60,0x62,0x66,0xFE,0x00,0x00,0x00}, // Ë (E with diaeresis)
+    {0x10,0x28,0x00,0x3C,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00}, // Î (I with circumflex)
+    {0x6C,0x00,0x00,0x3C,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x18,0x3C,0x00,0x00,0x00}, // Ï (I with diaeresis)
+    {0x10,0x28,0x00,0x38,0x6C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x6C,0x38,0x00,0x00,0x00}, // Ô (O with circumflex)
+    {0x6C,0x00,0x00,0x38,0x6C,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x6C,0x38,0x00,0x00,0x00}, // Ö (O with diaeresis)
+    {0x30,0x18,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00}, // Ù (U with grave)
+    {0x10,0x28,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00}, // Û (U with circumflex)
+    {0x6C,0x00,0x00,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0xC6,0x7C,0x00,0x00,0x00}, // Ü (U with diaeresis)
+    {0x00,0x00,0x00,0x7E,0xD8,0xD8,0xD8,0xDE,0xD8,0xD8,0xD8,0xD8,0x7E,0x00,0x00,0x00}, // Œ (OE ligature)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x12,0x36,0x6C,0xD8,0x6C,0x36,0x12,0x00,0x00,0x00}, // « (left guillemet)
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x90,0xD8,0x6C,0x36,0x6C,0xD8,0x90,0x00,0x00,0x00}, // » (right guillemet)
+    {0x00,0x00,0x00,0x3C,0x66,0xC0,0xF8,0xC0,0xF8,0xC0,0xC0,0x66,0x3C,0x00,0x00,0x00}, // € (euro sign)
 };
@@ -0,0 +1,380 @@
+#include "font_pack.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "font_pack";
+
+#define FONT_PACK_MAGIC        "EPFP"
+#define FONT_PACK_VERSION      1
+#define FONT_PACK_HEADER_SIZE  16
+#define FONT_PACK_ENTRY_SIZE   12
+#define FONT_PACK_MAX_GLYPHS   2048
+#define FONT_PACK_NAME_LEN     16
+#define FONT_PACK_PATH_LEN     64
+
+#define FONT_PACK_CACHE_SLOTS  32
+#define FONT_PACK_CACHE_BUDGET (8 * 1024)  // Decoded bitmaps of all packs together
+#define FONT_PACK_READ_MAX     ((FONT_PACK_MAX_WIDTH * FONT_PACK_MAX_HEIGHT + 7) / 8 + 1)
+
+typedef enum {
+    FONT_PACK_BITS,
+    FONT_PACK_RUNS,
+} font_pack_encoding_t;
+
+typedef struct {
+    uint32_t code;
+    uint32_t offset;     // In the file
+    uint16_t size;       // Encoded bytes
+    uint8_t width;
+    uint8_t advance;
+    uint8_t encoding;
+} font_pack_glyph_t;
+
+struct font_pack {
+    font_t font;
+    char name[FONT_PACK_NAME_LEN];
+    char path[FONT_PACK_PATH_LEN];
+    bool loaded;
+    bool failed;         // Don't retry a broken file on every string
+    uint16_t glyph_count;
+    font_pack_glyph_t *glyphs;
+};
+
+typedef struct {
+    const font_pack_t *pack;  // NULL = empty slot
+    uint32_t glyph;
+    uint32_t used;
+    uint16_t capacity;
+    uint8_t *rows;
+} font_pack_cache_t;
+
+static font_pack_cache_t cache[FONT_PACK_CACHE_SLOTS];
+static uint32_t cache_clock = 0;
+static uint32_t cache_bytes = 0;
+
+// One file stays open, glyph misses mostly hit the same pack
+static FILE *open_file = NULL;
+static const font_pack_t *open_pack = NULL;
+
+static uint16_t read_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static FILE *pack_file(const font_pack_t *pack) {
+    if (open_pack == pack) {
+        return open_file;
+    }
+    if (open_file != NULL) {
+        fclose(open_file);
+    }
+    open_file = fopen(pack->path, "rb");
+    open_pack = open_file != NULL ? pack : NULL;
+    return open_file;
+}
+
+static bool pack_read(const font_pack_t *pack, uint32_t offset, void *buf, size_t len) {
+    FILE *f = pack_file(pack);
+    return f != NULL && fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+}
+
+static bool load_index(font_pack_t *pack) {
+    uint8_t header[FONT_PACK_HEADER_SIZE];
+    if (!pack_read(pack, 0, header, sizeof(header))) {
+        ESP_LOGE(TAG, "%s: cannot read header", pack->path);
+        return false;
+    }
+    if (memcmp(header, FONT_PACK_MAGIC, 4) != 0 || header[4] != FONT_PACK_VERSION) {
+        ESP_LOGE(TAG, "%s: not a version %d font pack", pack->path, FONT_PACK_VERSION);
+        return false;
+    }
+    uint8_t height = header[5];
+    uint16_t count = read_u16(header + 6);
+    uint32_t store = read_u32(header + 8);
+    if (height == 0 || height > FONT_PACK_MAX_HEIGHT || count == 0 || count > FONT_PACK_MAX_GLYPHS) {
+        ESP_LOGE(TAG, "%s: bad header (height %d, %d glyphs)", pack->path, height, count);
+        return false;
+    }
+
+    // Glyph sizes follow from the next offset, the last glyph ends with the file
+    FILE *f = pack_file(pack);
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long file_size = ftell(f);
+
+    uint8_t *raw = (uint8_t*)malloc((size_t)count * FONT_PACK_ENTRY_SIZE);
+    pack->glyphs = (font_pack_glyph_t*)malloc(count * sizeof(font_pack_glyph_t));
+    if (raw == NULL || pack->glyphs == NULL) {
+        ESP_LOGE(TAG, "%s: no memory for %d glyphs", pack->path, count);
+        free(raw);
+        free(pack->glyphs);
+        pack->glyphs = NULL;
+        return false;
+    }
+    if (!pack_read(pack, FONT_PACK_HEADER_SIZE, raw, (size_t)count * FONT_PACK_ENTRY_SIZE)) {
+        ESP_LOGE(TAG, "%s: cannot read index", pack->path);
+        free(raw);
+        return false;
+    }
+
+    uint8_t max_width = 0, max_advance = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *e = raw + (size_t)i * FONT_PACK_ENTRY_SIZE;
+        const uint8_t *next = e + FONT_PACK_ENTRY_SIZE;
+        font_pack_glyph_t *g = &pack->glyphs[i];
+        g->code = read_u32(e);
+        g->offset = store + read_u32(e + 4);
+        g->width = e[8];
+        g->advance = e[9];
+        g->encoding = e[10];
+        uint32_t end = (i + 1 < count) ? store + read_u32(next + 4) : (uint32_t)file_size;
+
+        if ((i > 0 && g->code <= pack->glyphs[i - 1].code) || end < g->offset || end - g->offset > FONT_PACK_READ_MAX ||
+            g->width > FONT_PACK_MAX_WIDTH || g->encoding > FONT_PACK_RUNS) {
+            ESP_LOGE(TAG, "%s: bad index entry %d (code %u)", pack->path, i, (unsigned)g->code);
+            free(raw);
+            return false;
+        }
+        g->size = end - g->offset;
+        if (g->width > max_width) max_width = g->width;
+        if (g->advance > max_advance) max_advance = g->advance;
+    }
+    free(raw);
+
+    pack->glyph_count = count;
+    pack->font.width = max_width;
+    pack->font.height = height;
+    pack->font.advance = max_advance;
+    // The run of consecutive codes at the start (usually ASCII) skips the search
+    uint16_t run = 1;
+    while (run < count && pack->glyphs[run].code == pack->glyphs[0].code + run) {
+        run++;
+    }
+    pack->font.first = pack->glyphs[0].code;
+    pack->font.last = pack->glyphs[0].code + run - 1;
+    pack->font.glyph_count = count;
+    return true;
+}
+
+bool font_pack_load(font_pack_t *pack) {
+    if (pack->loaded) {
+        return true;
+    }
+    if (pack->failed) {
+        return false;
+    }
+    if (!load_index(pack)) {
+        free(pack->glyphs);
+        pack->glyphs = NULL;
+        pack->failed = true;
+        return false;
+    }
+    pack->loaded = true;
+    ESP_LOGI(TAG, "Loaded %s: %d glyphs, %d px high", pack->name, pack->glyph_count, pack->font.height);
+    return true;
+}
+
+int32_t font_pack_find(font_pack_t *pack, uint32_t code) {
+    if (!font_pack_load(pack)) {
+        return -1;
+    }
+    int lo = 0, hi = pack->glyph_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (pack->glyphs[mid].code == code) {
+            return mid;
+        }
+        if (pack->glyphs[mid].code < code) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+bool font_pack_metrics(font_pack_t *pack, uint32_t glyph, font_metrics_t *metrics) {
+    if (!pack->loaded || glyph >= pack->glyph_count) {
+        return false;
+    }
+    const font_pack_glyph_t *g = &pack->glyphs[glyph];
+    metrics->width = g->width;
+    metrics->height = pack->font.height;
+    metrics->advance = g->advance;
+    return true;
+}
+
+// Expand the stored pixels into rows padded to whole bytes
+static bool decode(const font_pack_glyph_t *g, uint8_t height, const uint8_t *src, uint8_t *rows) {
+    uint16_t stride = (g->width + 7) / 8;
+    uint32_t total = (uint32_t)g->width * height;
+    memset(rows, 0, (size_t)stride * height);
+
+    if (g->encoding == FONT_PACK_BITS) {
+        if (g->size < (total + 7) / 8) {
+            return false;
+        }
+        for (uint32_t i = 0; i < total; i++) {
+            if (src[i / 8] & (0x80 >> (i % 8))) {
+                rows[(i / g->width) * stride + (i % g->width) / 8] |= 0x80 >> (i % g->width % 8);
+            }
+        }
+        return true;
+    }
+
+    uint32_t pos = 0;
+    bool black = false;
+    for (uint16_t i = 0; i < g->size; i++) {
+        uint32_t end = pos + src[i];
+        if (end > total) {
+            return false;
+        }
+        for (; black && pos < end; pos++) {
+            rows[(pos / g->width) * stride + (pos % g->width) / 8] |= 0x80 >> (pos % g->width % 8);
+        }
+        pos = end;
+        black = !black;
+    }
+    return true;
+}
+
+// Free the bitmap of the least recently used allocated slot other than keep,
+// false when there is none left
+static bool cache_release(const font_pack_cache_t *keep) {
+    font_pack_cache_t *victim = NULL;
+    for (uint8_t i = 0; i < FONT_PACK_CACHE_SLOTS; i++) {
+        if (&cache[i] != keep && cache[i].capacity > 0 && (victim == NULL || cache[i].used < victim->used)) {
+            victim = &cache[i];
+        }
+    }
+    if (victim == NULL) {
+        return false;
+    }
+    free(victim->rows);
+    cache_bytes -= victim->capacity;
+    *victim = (font_pack_cache_t){ 0 };
+    return true;
+}
+
+const uint8_t *font_pack_glyph(font_pack_t *pack, uint32_t glyph) {
+    if (!pack->loaded || glyph >= pack->glyph_count) {
+        return NULL;
+    }
+    const font_pack_glyph_t *g = &pack->glyphs[glyph];
+
+    font_pack_cache_t *slot = &cache[0];
+    cache_clock++;
+    for (uint8_t i = 0; i < FONT_PACK_CACHE_SLOTS; i++) {
+        if (cache[i].pack == pack && cache[i].glyph == glyph) {
+            cache[i].used = cache_clock;
+            return cache[i].rows;
+        }
+        if (cache[i].used < slot->used) {
+            slot = &cache[i];
+        }
+    }
+
+    // Decode into the least recently used slot
+    uint16_t size = (uint16_t)((g->width + 7) / 8) * pack->font.height;
+    if (size == 0) {
+        size = 1; // Blank glyph, nothing to read
+    }
+    if (slot->capacity < size) {
+        // Over budget: make room from the other slots, oldest first
+        while (cache_bytes - slot->capacity + size > FONT_PACK_CACHE_BUDGET) {
+            if (!cache_release(slot)) {
+                ESP_LOGW(TAG, "Glyph cache full, U+%04X of %s not drawn", (unsigned)g->code, pack->name);
+                return NULL;
+            }
+        }
+        uint8_t *rows = (uint8_t*)realloc(slot->rows, size);
+        if (rows == NULL) {
+            return NULL;
+        }
+        cache_bytes += size - slot->capacity;
+        slot->rows = rows;
+        slot->capacity = size;
+    }
+    slot->pack = NULL;
+
+    static uint8_t src[FONT_PACK_READ_MAX];
+    if (g->size > 0 && !pack_read(pack, g->offset, src, g->size)) {
+        ESP_LOGE(TAG, "%s: cannot read glyph U+%04X", pack->path, (unsigned)g->code);
+        return NULL;
+    }
+    if (!decode(g, pack->font.height, src, slot->rows)) {
+        ESP_LOGE(TAG, "%s: corrupt glyph U+%04X", pack->path, (unsigned)g->code);
+        return NULL;
+    }
+    slot->pack = pack;
+    slot->glyph = glyph;
+    slot->used = cache_clock;
+    return slot->rows;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+int font_pack_register_dir(const char *dir) {
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        ESP_LOGW(TAG, "Cannot open %s, no font packs", dir);
+        return 0;
+    }
+
+    // Sorted, so the ids don't depend on the directory order
+    char *names[FONT_MAX];
+    int found = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL && found < FONT_MAX) {
+        size_t len = strlen(entry->d_name);
+        size_t ext = strlen(FONT_PACK_EXT);
+        if (len > ext && strcmp(entry->d_name + len - ext, FONT_PACK_EXT) == 0) {
+            names[found] = strdup(entry->d_name);
+            if (names[found] != NULL) {
+                found++;
+            }
+        }
+    }
+    closedir(d);
+    qsort(names, found, sizeof(names[0]), compare_names);
+
+    int registered = 0;
+    for (int i = 0; i < found; i++) {
+        font_pack_t *pack = (font_pack_t*)calloc(1, sizeof(font_pack_t));
+        if (pack == NULL) {
+            free(names[i]);
+            continue;
+        }
+        snprintf(pack->path, sizeof(pack->path), "%s/%s", dir, names[i]);
+        size_t len = strlen(names[i]) - strlen(FONT_PACK_EXT);
+        if (len >= sizeof(pack->name)) {
+            len = sizeof(pack->name) - 1;
+        }
+        memcpy(pack->name, names[i], len);
+        free(names[i]);
+
+        pack->font.name = pack->name;
+        pack->font.first = 1; // Nothing maps straight to a glyph until the index is loaded
+        pack->font.last = 0;
+        pack->font.layout = FONT_LAYOUT_PACK;
+        pack->font.pack = pack;
+        int id = font_register(&pack->font);
+        if (id < 0) {
+            ESP_LOGW(TAG, "Font table full, %s skipped", pack->path);
+            free(pack);
+            continue;
+        }
+        ESP_LOGI(TAG, "Font %d: %s", id, pack->path);
+        registered++;
+    }
+    return registered;
+}
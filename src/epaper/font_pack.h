@@ -0,0 +1,55 @@
+#ifndef FONT_PACK_H
+#define FONT_PACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "font.h"
+
+// Font packs: bitmap fonts stored as files on SPIFFS (made by host/mkfontpack.py).
+// Only the file names are read at boot; a pack's glyph index is loaded the first
+// time it is used and glyph bitmaps are decoded on demand into a small LRU cache.
+//
+// File layout (little endian):
+//   header, 16 bytes
+//     0  char[4]   magic "EPFP"
+//     4  uint8     version (1)
+//     5  uint8     height, every glyph bitmap is this tall (ascent + descent)
+//     6  uint16    glyph count
+//     8  uint32    glyph store offset
+//     12 uint32    reserved
+//   index, 12 bytes per glyph, sorted by code point
+//     0  uint32    code point
+//     4  uint32    offset from the glyph store
+//     8  uint8     bitmap width (0 for blank glyphs)
+//     9  uint8     advance
+//     10 uint8     encoding: 0 = bits, 1 = runs
+//     11 uint8     reserved
+//   glyph store
+//     bits: width x height bits row by row, MSB first, no padding between rows
+//     runs: the same pixels as byte run lengths, alternating white and black
+//           starting with white; 255 is followed by a 0-length run to go on
+
+#define FONT_PACK_EXT        ".epf"
+#define FONT_PACK_MAX_WIDTH  64
+#define FONT_PACK_MAX_HEIGHT 64
+
+typedef struct font_pack font_pack_t;
+
+// Register every *.epf file of dir as a font named after the file.
+// Returns the number of packs registered.
+int font_pack_register_dir(const char *dir);
+
+// Glyph (index entry) for code, -1 when the pack has none. Loads the index on first use.
+int32_t font_pack_find(font_pack_t *pack, uint32_t code);
+
+// Size of a glyph from font_pack_find()
+bool font_pack_metrics(font_pack_t *pack, uint32_t glyph, font_metrics_t *metrics);
+
+// Bitmap of a glyph from font_pack_find() as rows of (width + 7) / 8 bytes,
+// MSB = leftmost pixel. Valid until the next call.
+const uint8_t *font_pack_glyph(font_pack_t *pack, uint32_t glyph);
+
+// Load the pack index (sets the font sizes), false when the file is unusable
+bool font_pack_load(font_pack_t *pack);
+
+#endif // FONT_PACK_H
@@ -0,0 +1,596 @@
+#include "image_decode.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "miniz.h"
+
+static const char *TAG = "image";
+
+#define HEADER_MAX        1024  // BMP headers and palette, PNG chunk headers, PLTE and tRNS
+#define PNG_MAX_ROW_BYTES 8192  // Longer scanlines are refused, unfiltering keeps two of them
+
+#define PNG_CHUNK(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((c) << 8) | (d))
+
+typedef enum {
+    ST_SNIFF,          // First two bytes pick the format
+    ST_BMP_HEADER,     // File header and DIB header size
+    ST_BMP_INFO,       // Rest of the DIB header
+    ST_BMP_PALETTE,
+    ST_BMP_GAP,        // Anything between palette and pixel data
+    ST_BMP_ROWS,
+    ST_PNG_SIGNATURE,
+    ST_PNG_CHUNK,      // Chunk length and type
+    ST_PNG_DATA,       // Chunk data collected in buf (IHDR, PLTE, tRNS)
+    ST_PNG_IDAT,       // Chunk data inflated as it comes
+    ST_PNG_SKIP,       // Chunk data ignored
+    ST_PNG_CRC,
+    ST_DONE,
+} decode_state_t;
+
+struct image_decoder {
+    dither_t out;
+    image_info_t info;
+    esp_err_t err;          // Sticky
+    uint8_t state;          // decode_state_t
+    uint32_t need;          // Bytes of the current state to collect into buf or to skip
+    uint32_t have;
+    uint8_t buf[HEADER_MAX];
+    uint8_t palette[256][3];
+    uint16_t palette_count;
+
+    uint8_t *line;          // Scanline being received (PNG: filter type first)
+    uint8_t *prev;          // PNG: previous scanline, unfiltered
+    uint32_t line_bytes;    // Bytes per scanline in the file (BMP: padded)
+    uint32_t line_keep;     // BMP: bytes of it stored, the rest is cropped
+    uint32_t line_fill;
+    uint8_t *pixels;        // Scanline converted for the dither stage
+
+    // BMP
+    uint32_t pixel_offset;  // Start of the pixel data in the file
+    uint32_t pixel_gap;     // Bytes between the palette and the pixel data
+    uint16_t bpp;
+
+    // PNG
+    uint32_t chunk_type;
+    uint8_t color_type, depth, channels;
+    uint8_t filter_bytes;   // Bytes per complete pixel, at least 1
+    bool inflate_done;
+    tinfl_decompressor *inflator;
+    uint8_t *dict;          // Ring of TINFL_LZ_DICT_SIZE bytes, the inflate window
+    size_t dict_ofs;
+};
+
+static uint16_t le16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static void *dec_alloc(image_decoder_t *dec, size_t size) {
+    void *p = calloc(1, size);
+    if (p != NULL) {
+        dec->info.heap_bytes += size;
+    }
+    return p;
+}
+
+static esp_err_t fail(image_decoder_t *dec, esp_err_t err, const char *why) {
+    ESP_LOGE(TAG, "%s (at byte %lu)", why, (unsigned long)dec->info.bytes_in);
+    dec->err = err;
+    return err;
+}
+
+static void expect(image_decoder_t *dec, uint8_t state, uint32_t need) {
+    dec->state = state;
+    dec->need = need;
+    dec->have = 0;
+}
+
+// Gather the state's bytes into buf, true once all of them are there
+static bool collect(image_decoder_t *dec, const uint8_t **data, size_t *len) {
+    size_t n = dec->need - dec->have;
+    if (n > *len) n = *len;
+    memcpy(dec->buf + dec->have, *data, n);
+    dec->have += n;
+    *data += n;
+    *len -= n;
+    return dec->have == dec->need;
+}
+
+// Pass over the state's bytes, true once all of them went by
+static bool skip(image_decoder_t *dec, const uint8_t **data, size_t *len) {
+    size_t n = dec->need - dec->have;
+    if (n > *len) n = *len;
+    dec->have += n;
+    *data += n;
+    *len -= n;
+    return dec->have == dec->need;
+}
+
+// Size the output once the header is known and start the converter
+static esp_err_t begin_output(image_decoder_t *dec, uint32_t width, uint32_t height, uint8_t format) {
+    dec->info.width = width;
+    dec->info.height = height;
+    if (width == 0 || height == 0 || height > UINT16_MAX) {
+        return fail(dec, ESP_ERR_NOT_SUPPORTED, "Unsupported image size");
+    }
+    dec->out.w = width > DITHER_MAX_WIDTH ? DITHER_MAX_WIDTH : width;
+    dec->out.h = height;
+    dec->out.format = format;
+    dec->pixels = dec_alloc(dec, (size_t)dec->out.w * 3);
+    if (dec->pixels == NULL) {
+        return fail(dec, ESP_ERR_NO_MEM, "No memory for the scanline");
+    }
+    esp_err_t err = dither_begin(&dec->out);
+    if (err != ESP_OK) {
+        return fail(dec, err, "Cannot start the conversion");
+    }
+    if (dec->out.err_cur != NULL) {
+        dec->info.heap_bytes += (size_t)dec->out.channels * (dec->out.w + 2) * 2 * sizeof(int16_t);
+    }
+    ESP_LOGI(TAG, "%s %lux%lu", dec->info.type == IMAGE_TYPE_BMP ? "BMP" : "PNG",
+             (unsigned long)width, (unsigned long)height);
+    return ESP_OK;
+}
+
+// Hand a converted scanline to the framebuffer
+static void emit_row(image_decoder_t *dec) {
+    dither_write(&dec->out, dec->pixels, (size_t)dec->out.w * (dec->out.format == DITHER_RGB888 ? 3 : 1));
+    dec->info.rows++;
+    if (dither_done(&dec->out)) {
+        dec->state = ST_DONE;
+    }
+}
+
+// Sample i of a row packed depth bits per sample (depth < 8), MSB first
+static uint8_t packed_sample(const uint8_t *row, uint32_t i, uint8_t depth) {
+    uint32_t bit = i * depth;
+    return (row[bit / 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1);
+}
+
+// Color blended onto white by alpha
+static uint8_t on_white(uint8_t v, uint8_t alpha) {
+    return (v * alpha + 255 * (255 - alpha)) / 255;
+}
+
+// ========== BMP ==========
+
+static esp_err_t bmp_info(image_decoder_t *dec) {
+    const uint8_t *dib = dec->buf + 14;
+    int32_t width = (int32_t)le32(dib + 4), height = (int32_t)le32(dib + 8);
+    uint32_t compression = le32(dib + 16), colors = le32(dib + 32);
+    dec->bpp = le16(dib + 14);
+
+    if (compression != 0 || width <= 0 || height == 0 ||
+        (dec->bpp != 1 && dec->bpp != 4 && dec->bpp != 8 && dec->bpp != 24 && dec->bpp != 32)) {
+        return fail(dec, ESP_ERR_NOT_SUPPORTED, "Only uncompressed 1, 4, 8, 24 and 32-bit BMP");
+    }
+    // Rows are stored bottom-up unless the height is negative
+    dec->out.bottom_up = height > 0;
+    uint32_t rows = height > 0 ? (uint32_t)height : (uint32_t)-height;
+    if (begin_output(dec, width, rows, DITHER_RGB888) != ESP_OK) {
+        return dec->err;
+    }
+
+    dec->line_bytes = (((uint32_t)width * dec->bpp + 31) / 32) * 4;
+    dec->line_keep = ((uint32_t)dec->out.w * dec->bpp + 7) / 8;
+    dec->line = dec_alloc(dec, dec->line_keep);
+    if (dec->line == NULL) {
+        return fail(dec, ESP_ERR_NO_MEM, "No memory for the scanline");
+    }
+
+    uint32_t pos = 14 + le32(dib);
+    dec->palette_count = dec->bpp <= 8 ? (colors != 0 && colors < (1u << dec->bpp) ? colors : 1u << dec->bpp) : 0;
+    pos += dec->palette_count * 4;
+    if (dec->pixel_offset < pos) {
+        return fail(dec, ESP_ERR_INVALID_RESPONSE, "BMP pixel data overlaps the header");
+    }
+    dec->pixel_gap = dec->pixel_offset - pos;
+    if (dec->palette_count > 0) {
+        expect(dec, ST_BMP_PALETTE, dec->palette_count * 4);
+    } else {
+        expect(dec, ST_BMP_GAP, dec->pixel_gap);
+    }
+    return ESP_OK;
+}
+
+static void bmp_palette(image_decoder_t *dec) {
+    for (uint16_t i = 0; i < dec->palette_count; i++) {
+        const uint8_t *bgr = dec->buf + 4 * i;
+        dec->palette[i][0] = bgr[2];
+        dec->palette[i][1] = bgr[1];
+        dec->palette[i][2] = bgr[0];
+    }
+    expect(dec, ST_BMP_GAP, dec->pixel_gap);
+}
+
+static void bmp_row(image_decoder_t *dec) {
+    uint8_t *out = dec->pixels;
+    for (uint32_t i = 0; i < dec->out.w; i++, out += 3) {
+        const uint8_t *rgb;
+        uint8_t bgr[3];
+        if (dec->bpp <= 8) {
+            uint8_t index = dec->bpp == 8 ? dec->line[i] : packed_sample(dec->line, i, dec->bpp);
+            rgb = index < dec->palette_count ? dec->palette[index] : (const uint8_t[3]){ 0, 0, 0 };
+        } else {
+            const uint8_t *p = dec->line + i * (dec->bpp / 8);
+            bgr[0] = p[2]; bgr[1] = p[1]; bgr[2] = p[0];
+            rgb = bgr;
+        }
+        memcpy(out, rgb, 3);
+    }
+    emit_row(dec);
+}
+
+static void bmp_rows(image_decoder_t *dec, const uint8_t **data, size_t *len) {
+    size_t n = dec->line_bytes - dec->line_fill;
+    if (n > *len) n = *len;
+    if (dec->line_fill < dec->line_keep) {
+        size_t keep = dec->line_keep - dec->line_fill;
+        memcpy(dec->line + dec->line_fill, *data, n < keep ? n : keep);
+    }
+    dec->line_fill += n;
+    *data += n;
+    *len -= n;
+    if (dec->line_fill == dec->line_bytes) {
+        dec->line_fill = 0;
+        bmp_row(dec);
+    }
+}
+
+// ========== PNG ==========
+
+static esp_err_t png_header(image_decoder_t *dec) {
+    const uint8_t *p = dec->buf;
+    uint32_t width = be32(p), height = be32(p + 4);
+    dec->depth = p[8];
+    dec->color_type = p[9];
+    if (p[10] != 0 || p[11] != 0 || p[12] != 0) {
+        return fail(dec, ESP_ERR_NOT_SUPPORTED, "Interlaced or unknown PNG method");
+    }
+
+    static const uint8_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    uint8_t ct = dec->color_type, d = dec->depth;
+    bool ok = ct <= 6 && channels[ct] != 0 &&
+              (d == 8 || (d == 16 && ct != 3) || ((d == 1 || d == 2 || d == 4) && (ct == 0 || ct == 3)));
+    if (!ok) {
+        return fail(dec, ESP_ERR_NOT_SUPPORTED, "Unsupported PNG color type or depth");
+    }
+    dec->channels = channels[ct];
+    uint32_t bits = (uint32_t)dec->channels * d;
+    dec->filter_bytes = bits >= 8 ? bits / 8 : 1;
+    uint64_t row_bytes = ((uint64_t)width * bits + 7) / 8;
+    if (row_bytes + 1 > PNG_MAX_ROW_BYTES) {
+        return fail(dec, ESP_ERR_NOT_SUPPORTED, "PNG too wide");
+    }
+    dec->line_bytes = row_bytes + 1;
+
+    uint8_t format = (ct == 0 || ct == 4) ? DITHER_GRAY8 : DITHER_RGB888;
+    if (begin_output(dec, width, height, format) != ESP_OK) {
+        return dec->err;
+    }
+    dec->line = dec_alloc(dec, dec->line_bytes);
+    dec->prev = dec_alloc(dec, dec->line_bytes);
+    dec->inflator = dec_alloc(dec, sizeof(tinfl_decompressor));
+    dec->dict = dec_alloc(dec, TINFL_LZ_DICT_SIZE);
+    if (dec->line == NULL || dec->prev == NULL || dec->inflator == NULL || dec->dict == NULL) {
+        return fail(dec, ESP_ERR_NO_MEM, "No memory to inflate");
+    }
+    tinfl_init(dec->inflator);
+    return ESP_OK;
+}
+
+static void png_palette(image_decoder_t *dec, uint32_t len) {
+    dec->palette_count = len / 3;
+    memcpy(dec->palette, dec->buf, dec->palette_count * 3);
+}
+
+// Palette transparency, blended onto white once instead of per pixel
+static void png_transparency(image_decoder_t *dec, uint32_t len) {
+    if (dec->color_type != 3) {
+        return;
+    }
+    for (uint32_t i = 0; i < len && i < dec->palette_count; i++) {
+        for (int c = 0; c < 3; c++) {
+            dec->palette[i][c] = on_white(dec->palette[i][c], dec->buf[i]);
+        }
+    }
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// Sample ch of pixel i, reduced to 8 bits
+static uint8_t png_sample(const image_decoder_t *dec, const uint8_t *row, uint32_t i, uint8_t ch) {
+    uint32_t index = i * dec->channels + ch;
+    if (dec->depth == 16) {
+        return row[2 * index];
+    }
+    if (dec->depth == 8) {
+        return row[index];
+    }
+    uint8_t v = packed_sample(row, index, dec->depth);
+    return dec->color_type == 3 ? v : v * 255 / ((1 << dec->depth) - 1);
+}
+
+static void png_row(image_decoder_t *dec) {
+    uint8_t *cur = dec->line + 1, *up = dec->prev + 1;
+    uint32_t n = dec->line_bytes - 1, bpp = dec->filter_bytes;
+
+    switch (dec->line[0]) {
+        case 0:
+            break;
+        case 1:
+            for (uint32_t i = bpp; i < n; i++) cur[i] += cur[i - bpp];
+            break;
+        case 2:
+            for (uint32_t i = 0; i < n; i++) cur[i] += up[i];
+            break;
+        case 3:
+            for (uint32_t i = 0; i < n; i++) cur[i] += ((i >= bpp ? cur[i - bpp] : 0) + up[i]) / 2;
+            break;
+        case 4:
+            for (uint32_t i = 0; i < n; i++) {
+                cur[i] += paeth(i >= bpp ? cur[i - bpp] : 0, up[i], i >= bpp ? up[i - bpp] : 0);
+            }
+            break;
+        default:
+            fail(dec, ESP_ERR_INVALID_RESPONSE, "Bad PNG filter");
+            return;
+    }
+
+    uint8_t *out = dec->pixels;
+    for (uint32_t i = 0; i < dec->out.w; i++) {
+        switch (dec->color_type) {
+            case 0:
+                *out++ = png_sample(dec, cur, i, 0);
+                break;
+            case 4:
+                *out++ = on_white(png_sample(dec, cur, i, 0), png_sample(dec, cur, i, 1));
+                break;
+            case 3: {
+                uint8_t index = png_sample(dec, cur, i, 0);
+                if (index < dec->palette_count) {
+                    memcpy(out, dec->palette[index], 3);
+                } else {
+                    memset(out, 0, 3);
+                }
+                out += 3;
+                break;
+            }
+            default: {
+                uint8_t alpha = dec->color_type == 6 ? png_sample(dec, cur, i, 3) : 255;
+                for (uint8_t c = 0; c < 3; c++) {
+                    *out++ = on_white(png_sample(dec, cur, i, c), alpha);
+                }
+                break;
+            }
+        }
+    }
+
+    // This row is the next one's "up"
+    uint8_t *t = dec->prev;
+    dec->prev = dec->line;
+    dec->line = t;
+    emit_row(dec);
+}
+
+// Inflated bytes: cut them into scanlines
+static void png_scanlines(image_decoder_t *dec, const uint8_t *data, size_t len) {
+    while (len > 0 && dec->state != ST_DONE && dec->err == ESP_OK) {
+        size_t n = dec->line_bytes - dec->line_fill;
+        if (n > len) n = len;
+        memcpy(dec->line + dec->line_fill, data, n);
+        dec->line_fill += n;
+        data += n;
+        len -= n;
+        if (dec->line_fill == dec->line_bytes) {
+            dec->line_fill = 0;
+            png_row(dec);
+        }
+    }
+}
+
+static void png_inflate(image_decoder_t *dec, const uint8_t *data, size_t len) {
+    while (!dec->inflate_done && dec->state != ST_DONE && dec->err == ESP_OK) {
+        size_t in_bytes = len, out_bytes = TINFL_LZ_DICT_SIZE - dec->dict_ofs;
+        tinfl_status status = tinfl_decompress(dec->inflator, data, &in_bytes, dec->dict,
+                                               dec->dict + dec->dict_ofs, &out_bytes,
+                                               TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_bytes;
+        len -= in_bytes;
+        png_scanlines(dec, dec->dict + dec->dict_ofs, out_bytes);
+        dec->dict_ofs = (dec->dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (status < TINFL_STATUS_DONE) {
+            fail(dec, ESP_ERR_INVALID_RESPONSE, "Corrupt PNG data");
+        } else if (status == TINFL_STATUS_DONE) {
+            dec->inflate_done = true;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            break;
+        }
+    }
+}
+
+static esp_err_t png_chunk(image_decoder_t *dec) {
+    uint32_t len = be32(dec->buf);
+    uint32_t type = be32(dec->buf + 4);
+    bool have_header = dec->line != NULL;
+    dec->chunk_type = type;
+
+    if (!have_header && type != PNG_CHUNK('I', 'H', 'D', 'R')) {
+        return fail(dec, ESP_ERR_INVALID_RESPONSE, "PNG does not start with IHDR");
+    }
+    switch (type) {
+        case PNG_CHUNK('I', 'H', 'D', 'R'):
+            if (have_header || len != 13) {
+                return fail(dec, ESP_ERR_INVALID_RESPONSE, "Bad IHDR");
+            }
+            expect(dec, ST_PNG_DATA, len);
+            break;
+        case PNG_CHUNK('P', 'L', 'T', 'E'):
+            if (len > 768 || len % 3 != 0) {
+                return fail(dec, ESP_ERR_INVALID_RESPONSE, "Bad PLTE");
+            }
+            expect(dec, ST_PNG_DATA, len);
+            break;
+        case PNG_CHUNK('t', 'R', 'N', 'S'):
+            expect(dec, len <= 256 ? ST_PNG_DATA : ST_PNG_SKIP, len);
+            break;
+        case PNG_CHUNK('I', 'D', 'A', 'T'):
+            if (dec->color_type == 3 && dec->palette_count == 0) {
+                return fail(dec, ESP_ERR_INVALID_RESPONSE, "PNG palette missing");
+            }
+            expect(dec, ST_PNG_IDAT, len);
+            break;
+        case PNG_CHUNK('I', 'E', 'N', 'D'):
+            return fail(dec, ESP_ERR_INVALID_RESPONSE, "PNG ended before its last row");
+        default:
+            expect(dec, ST_PNG_SKIP, len);  // Ancillary chunks
+            break;
+    }
+    return ESP_OK;
+}
+
+static void png_chunk_data(image_decoder_t *dec) {
+    switch (dec->chunk_type) {
+        case PNG_CHUNK('I', 'H', 'D', 'R'):
+            png_header(dec);
+            break;
+        case PNG_CHUNK('P', 'L', 'T', 'E'):
+            png_palette(dec, dec->need);
+            break;
+        case PNG_CHUNK('t', 'R', 'N', 'S'):
+            png_transparency(dec, dec->need);
+            break;
+    }
+}
+
+// ========== Common ==========
+
+image_decoder_t *image_decoder_create(const dither_t *settings) {
+    image_decoder_t *dec = calloc(1, sizeof(*dec));
+    if (dec == NULL) {
+        return NULL;
+    }
+    dec->info.heap_bytes = sizeof(*dec);
+    dec->out.x = settings->x;
+    dec->out.y = settings->y;
+    dec->out.method = settings->method;
+    dec->out.threshold = settings->threshold;
+    dec->out.red = settings->red;
+    expect(dec, ST_SNIFF, 2);
+    return dec;
+}
+
+esp_err_t image_decoder_write(image_decoder_t *dec, const uint8_t *data, size_t len) {
+    if (dec->err != ESP_OK) {
+        return dec->err;
+    }
+    dec->info.bytes_in += len;
+
+    while (len > 0 && dec->err == ESP_OK && dec->state != ST_DONE) {
+        switch (dec->state) {
+            case ST_SNIFF:
+                if (!collect(dec, &data, &len)) break;
+                if (dec->buf[0] == 'B' && dec->buf[1] == 'M') {
+                    dec->info.type = IMAGE_TYPE_BMP;
+                    dec->state = ST_BMP_HEADER;
+                    dec->need = 18;
+                } else if (dec->buf[0] == 0x89 && dec->buf[1] == 'P') {
+                    dec->info.type = IMAGE_TYPE_PNG;
+                    dec->state = ST_PNG_SIGNATURE;
+                    dec->need = 8;
+                } else {
+                    fail(dec, ESP_ERR_NOT_SUPPORTED, "Neither BMP nor PNG");
+                }
+                break;  // The bytes stay in buf, the next state continues after them
+
+            case ST_BMP_HEADER:
+                if (!collect(dec, &data, &len)) break;
+                dec->pixel_offset = le32(dec->buf + 10);
+                if (le32(dec->buf + 14) < 40 || le32(dec->buf + 14) > HEADER_MAX - 14) {
+                    fail(dec, ESP_ERR_NOT_SUPPORTED, "Unknown BMP header");
+                    break;
+                }
+                dec->state = ST_BMP_INFO;
+                dec->need = 14 + le32(dec->buf + 14);
+                break;
+            case ST_BMP_INFO:
+                if (collect(dec, &data, &len)) bmp_info(dec);
+                break;
+            case ST_BMP_PALETTE:
+                if (collect(dec, &data, &len)) {
+                    bmp_palette(dec);
+                }
+                break;
+            case ST_BMP_GAP:
+                if (skip(dec, &data, &len)) dec->state = ST_BMP_ROWS;
+                break;
+            case ST_BMP_ROWS:
+                bmp_rows(dec, &data, &len);
+                break;
+
+            case ST_PNG_SIGNATURE:
+                if (!collect(dec, &data, &len)) break;
+                if (memcmp(dec->buf, "\x89PNG\r\n\x1a\n", 8) != 0) {
+                    fail(dec, ESP_ERR_INVALID_RESPONSE, "Bad PNG signature");
+                    break;
+                }
+                expect(dec, ST_PNG_CHUNK, 8);
+                break;
+            case ST_PNG_CHUNK:
+                if (collect(dec, &data, &len)) png_chunk(dec);
+                break;
+            case ST_PNG_DATA:
+                if (!collect(dec, &data, &len)) break;
+                png_chunk_data(dec);
+                if (dec->err == ESP_OK) expect(dec, ST_PNG_CRC, 4);
+                break;
+            case ST_PNG_IDAT: {
+                const uint8_t *start = data;
+                if (skip(dec, &data, &len)) expect(dec, ST_PNG_CRC, 4);
+                png_inflate(dec, start, data - start);
+                break;
+            }
+            case ST_PNG_SKIP:
+                if (skip(dec, &data, &len)) expect(dec, ST_PNG_CRC, 4);
+                break;
+            case ST_PNG_CRC:
+                if (skip(dec, &data, &len)) expect(dec, ST_PNG_CHUNK, 8);
+                break;
+        }
+    }
+    return dec->err;
+}
+
+bool image_decoder_done(const image_decoder_t *dec) {
+    return dec->state == ST_DONE;
+}
+
+void image_decoder_get_info(const image_decoder_t *dec, image_info_t *info) {
+    *info = dec->info;
+}
+
+void image_decoder_free(image_decoder_t *dec) {
+    if (dec == NULL) {
+        return;
+    }
+    dither_end(&dec->out);
+    free(dec->pixels);
+    free(dec->line);
+    free(dec->prev);
+    free(dec->inflator);
+    free(dec->dict);
+    free(dec);
+}
@@ -0,0 +1,48 @@
+#ifndef IMAGE_DECODE_H
+#define IMAGE_DECODE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "dither.h"
+
+// Incremental BMP and PNG decoder. The file is fed in chunks of any size as
+// it arrives, each decoded scanline goes straight to the tri-color conversion
+// (dither.h) and the framebuffer, so the file is never held in memory.
+//   BMP: uncompressed 1, 4, 8, 24 and 32 bits per pixel
+//   PNG: grayscale, palette, RGB, with or without alpha (blended onto white),
+//        1 to 16 bits per sample, not interlaced. IDAT is inflated by the ROM.
+// Images wider than DITHER_MAX_WIDTH are cropped. Callers hold display_lock().
+
+typedef enum {
+    IMAGE_TYPE_UNKNOWN,  // Not enough bytes seen yet
+    IMAGE_TYPE_BMP,
+    IMAGE_TYPE_PNG,
+} image_type_t;
+
+typedef struct {
+    uint8_t type;         // image_type_t
+    uint32_t width, height;
+    uint32_t bytes_in;    // File bytes consumed
+    uint32_t rows;        // Scanlines drawn
+    size_t heap_bytes;    // Allocated by the decoder, converter included
+} image_info_t;
+
+typedef struct image_decoder image_decoder_t;
+
+// settings: position, dither method, threshold and red of the output (size
+// and format come from the file). Returns NULL when out of memory.
+image_decoder_t *image_decoder_create(const dither_t *settings);
+
+// Decode the next chunk. Errors are sticky: ESP_ERR_NOT_SUPPORTED for formats
+// outside the list above, ESP_ERR_INVALID_RESPONSE for corrupt data.
+esp_err_t image_decoder_write(image_decoder_t *dec, const uint8_t *data, size_t len);
+
+// All scanlines decoded
+bool image_decoder_done(const image_decoder_t *dec);
+
+void image_decoder_get_info(const image_decoder_t *dec, image_info_t *info);
+void image_decoder_free(image_decoder_t *dec);
+
+#endif // IMAGE_DECODE_H
@@ -0,0 +1,263 @@
+#include "text_layout.h"
+#include <string.h>
+#include "epaper.h"
+#include "font_pack.h"
+
+#define MEASURE_CACHE_SLOTS 16
+#define MEASURE_KEY_MAX     32  // Longer strings are measured every time
+
+// Unscaled size of a short string, widths scale linearly
+typedef struct {
+    const font_t *font;  // NULL = empty slot
+    uint16_t width;      // Font pixels, widest line
+    uint8_t lines;
+    char text[MEASURE_KEY_MAX];
+} measure_entry_t;
+
+static measure_entry_t measure_cache[MEASURE_CACHE_SLOTS];
+
+static bool font_ready(const font_t *font) {
+    if (font == NULL) {
+        return false;
+    }
+    return font->layout != FONT_LAYOUT_PACK || font_pack_load(font->pack);
+}
+
+// Ink extent and pen step of the glyph drawn for c, as epaper_draw_text_span() draws it.
+// Spaces advance but never count as ink, so trailing blanks don't widen a line.
+static void glyph_extent(const font_t *font, uint32_t c, uint8_t *ink, uint8_t *advance) {
+    font_metrics_t m;
+    if (font_text_glyph(font, c, &m) < 0) {
+        *ink = 0;
+        *advance = font->advance;
+        return;
+    }
+    *ink = (c == ' ') ? 0 : m.width;
+    *advance = m.advance;
+}
+
+static uint16_t clamp_u16(uint32_t v) {
+    return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+// Widest line in font pixels and the number of lines, one per '\n'
+static void measure_lines(const char *text, const font_t *font, uint16_t *width, uint8_t *lines) {
+    uint32_t widest = 0, pen = 0, ink = 0;
+    uint8_t n = 1;
+    while (*text) {
+        uint32_t c = font_next_code(&text);
+        if (c == '\n') {
+            if (ink > widest) widest = ink;
+            pen = ink = 0;
+            if (n < 0xFF) n++;
+            continue;
+        }
+        if (c == '\r') {
+            continue;
+        }
+        uint8_t w, advance;
+        glyph_extent(font, c, &w, &advance);
+        if (w > 0 && pen + w > ink) {
+            ink = pen + w;
+        }
+        pen += advance;
+    }
+    if (ink > widest) widest = ink;
+    *width = clamp_u16(widest);
+    *lines = n;
+}
+
+// FNV-1a, picks the cache slot
+static uint32_t hash_text(const char *text, const font_t *font) {
+    uint32_t h = 2166136261u ^ (uint32_t)(uintptr_t)font;
+    for (; *text; text++) {
+        h = (h ^ (uint8_t)*text) * 16777619u;
+    }
+    return h;
+}
+
+static void measure_unscaled(const char *text, const font_t *font, uint16_t *width, uint8_t *lines) {
+    size_t len = strlen(text);
+    if (len >= MEASURE_KEY_MAX) {
+        measure_lines(text, font, width, lines);
+        return;
+    }
+    measure_entry_t *e = &measure_cache[hash_text(text, font) % MEASURE_CACHE_SLOTS];
+    if (e->font != font || strcmp(e->text, text) != 0) {
+        measure_lines(text, font, &e->width, &e->lines);
+        memcpy(e->text, text, len + 1);
+        e->font = font;
+    }
+    *width = e->width;
+    *lines = e->lines;
+}
+
+// Height in font pixels of n lines
+static uint32_t block_height(const font_t *font, uint8_t n, uint8_t line_gap) {
+    return n == 0 ? 0 : (uint32_t)n * font->height + (uint32_t)(n - 1) * line_gap;
+}
+
+void text_measure(const char *text, const font_t *font, uint8_t scale, uint16_t *width, uint16_t *height) {
+    *width = *height = 0;
+    if (text == NULL || !font_ready(font)) {
+        return;
+    }
+    uint16_t w;
+    uint8_t lines;
+    measure_unscaled(text, font, &w, &lines);
+    *width = clamp_u16((uint32_t)w * scale);
+    *height = clamp_u16(block_height(font, lines, TEXT_LAYOUT_LINE_GAP) * scale);
+}
+
+// Break text into lines at one scale, then place them in the box. Returns whether it fits.
+static bool layout_at(const char *text, const font_t *font, const text_box_t *box, uint8_t scale,
+                      text_layout_t *out) {
+    uint32_t max_w = box->w ? box->w / scale : UINT32_MAX;  // Font pixels
+    uint32_t max_h = box->h ? box->h / scale : UINT32_MAX;
+    bool fits = true;
+    uint8_t n = 0;
+    uint32_t widest = 0;
+    const char *p = text;
+
+    while (p != NULL) {
+        if (n == TEXT_LAYOUT_MAX_LINES || (n > 0 && block_height(font, n + 1, box->line_gap) > max_h)) {
+            fits = false; // Lines past the box are dropped, the first one is always kept
+            break;
+        }
+        if (block_height(font, n + 1, box->line_gap) > max_h) {
+            fits = false;
+        }
+        const char *start = p, *end = NULL, *next = NULL;
+        const char *brk = NULL, *brk_next = NULL;  // Last space, where the line may wrap
+        uint32_t pen = 0, ink = 0, brk_ink = 0;
+
+        while (1) {
+            if (*p == '\0') {
+                end = p;
+                next = NULL;
+                break;
+            }
+            const char *q = p;
+            uint32_t c = font_next_code(&q);
+            if (c == '\n') {
+                end = p;
+                next = q;
+                break;
+            }
+            if (c == '\r') {
+                p = q;
+                continue;
+            }
+            uint8_t w, advance;
+            glyph_extent(font, c, &w, &advance);
+            if (c == ' ' && ink > 0) {
+                brk = p;
+                brk_ink = ink;
+                brk_next = q;
+            }
+            if (w > 0 && pen + w > max_w) {
+                if (!box->wrap) {
+                    fits = false;
+                } else if (brk != NULL) {
+                    end = brk;
+                    ink = brk_ink;
+                    next = brk_next;
+                    while (*next == ' ') next++;
+                    break;
+                } else if (p > start) {
+                    end = p; // One word wider than the box: split it
+                    next = p;
+                    fits = false;
+                    break;
+                } else {
+                    fits = false; // Not even one glyph fits, take it anyway
+                }
+            }
+            if (w > 0 && pen + w > ink) {
+                ink = pen + w;
+            }
+            pen += advance;
+            p = q;
+        }
+
+        text_line_t *line = &out->lines[n++];
+        line->start = (uint16_t)(start - text);
+        line->len = (uint16_t)(end - start);
+        line->width = clamp_u16(ink * scale);
+        if (ink > widest) widest = ink;
+        p = next;
+    }
+
+    out->scale = scale;
+    out->fits = fits;
+    out->line_count = n;
+    out->width = clamp_u16(widest * scale);
+    out->height = clamp_u16(block_height(font, n, box->line_gap) * scale);
+
+    // Place the lines
+    int32_t top = box->y;
+    if (box->h > out->height) {
+        if (box->valign == TEXT_VALIGN_MIDDLE) top += (box->h - out->height) / 2;
+        if (box->valign == TEXT_VALIGN_BOTTOM) top += box->h - out->height;
+    }
+    uint32_t step = ((uint32_t)font->height + box->line_gap) * scale;
+    for (uint8_t i = 0; i < n; i++) {
+        text_line_t *line = &out->lines[i];
+        int32_t x = box->x;
+        if (box->align == TEXT_ALIGN_CENTER) {
+            x += box->w ? ((int32_t)box->w - line->width) / 2 : -(int32_t)line->width / 2;
+        } else if (box->align == TEXT_ALIGN_RIGHT) {
+            x += box->w ? (int32_t)box->w - line->width : -(int32_t)line->width;
+        }
+        int32_t y = top + (int32_t)(i * step);
+        line->x = x < 0 ? 0 : clamp_u16(x);
+        line->y = clamp_u16(y);
+    }
+    return fits;
+}
+
+bool text_layout(const char *text, const font_t *font, const text_box_t *box, text_layout_t *layout) {
+    memset(layout, 0, sizeof(*layout));
+    if (text == NULL || !font_ready(font)) {
+        return false;
+    }
+    if (!box->fit) {
+        layout_at(text, font, box, box->scale ? box->scale : 1, layout);
+        return true;
+    }
+
+    uint8_t max_scale = (box->scale && box->scale < TEXT_LAYOUT_MAX_SCALE) ? box->scale : TEXT_LAYOUT_MAX_SCALE;
+
+    // Single line: the cached measurement gives the largest scale right away.
+    // With wrapping that is only a lower bound, more lines may allow larger text.
+    uint8_t min_scale = 1;
+    uint16_t w;
+    uint8_t lines;
+    measure_unscaled(text, font, &w, &lines);
+    if (lines == 1) {
+        uint32_t s = max_scale;
+        if (box->w && w > 0 && box->w / w < s) s = box->w / w;
+        if (box->h && box->h / font->height < s) s = box->h / font->height;
+        if (s >= 1 && box->wrap) {
+            min_scale = (uint8_t)s;
+        } else if (s >= 1 && layout_at(text, font, box, (uint8_t)s, layout)) {
+            return true;
+        }
+    }
+
+    // Otherwise (or when only wrapping helps) try the scales from the largest down
+    for (uint8_t s = max_scale; s > min_scale; s--) {
+        if (layout_at(text, font, box, s, layout)) {
+            return true;
+        }
+    }
+    layout_at(text, font, box, min_scale, layout);
+    return true;
+}
+
+void text_layout_draw(const char *text, const font_t *font, const text_layout_t *layout, uint8_t color) {
+    for (uint8_t i = 0; i < layout->line_count; i++) {
+        const text_line_t *line = &layout->lines[i];
+        epaper_draw_text_span(line->x, line->y, text + line->start, line->len, font, color, layout->scale);
+    }
+}
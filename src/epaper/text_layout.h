@@ -0,0 +1,69 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "font.h"
+
+// Text layout on top of the renderer: measuring without drawing, word wrap,
+// alignment and the largest scale that fits a box. All positions are logical
+// pixels (same as epaper_draw_text_font()). Not thread safe: the display
+// service lays out with the framebuffer locked, other callers take display_lock().
+
+#define TEXT_LAYOUT_MAX_LINES 16
+#define TEXT_LAYOUT_MAX_SCALE 10  // Largest scale fit tries
+#define TEXT_LAYOUT_LINE_GAP  1   // Default font pixels between lines
+
+typedef enum {
+    TEXT_ALIGN_LEFT,
+    TEXT_ALIGN_CENTER,
+    TEXT_ALIGN_RIGHT,
+} text_align_t;
+
+typedef enum {
+    TEXT_VALIGN_TOP,
+    TEXT_VALIGN_MIDDLE,
+    TEXT_VALIGN_BOTTOM,
+} text_valign_t;
+
+// Where and how to lay out a text. A box side of 0 has no limit: without a
+// width, x is the left edge, center or right edge of the lines (per align).
+typedef struct {
+    uint16_t x, y;
+    uint16_t w, h;
+    uint8_t align;     // text_align_t
+    uint8_t valign;    // text_valign_t, needs h
+    uint8_t scale;     // Scale to use, with fit the largest one to try (0 = TEXT_LAYOUT_MAX_SCALE)
+    uint8_t line_gap;  // Font pixels between lines
+    bool wrap;         // Break lines at spaces to stay within w
+    bool fit;          // Pick the largest scale <= scale that fits the box
+} text_box_t;
+
+// One laid out line: bytes start..start+len of the text, drawn at (x, y)
+typedef struct {
+    uint16_t start, len;
+    uint16_t x, y;
+    uint16_t width;
+} text_line_t;
+
+typedef struct {
+    uint8_t scale;         // Scale used
+    bool fits;             // All of the text is inside the box, no word was split
+    uint8_t line_count;
+    uint16_t width, height;  // Of the whole block
+    text_line_t lines[TEXT_LAYOUT_MAX_LINES];
+} text_layout_t;
+
+// Size of text drawn one line per '\n' (TEXT_LAYOUT_LINE_GAP apart), without
+// wrapping. Cached per string and font, sizes are linear in the scale.
+void text_measure(const char *text, const font_t *font, uint8_t scale,
+                  uint16_t *width, uint16_t *height);
+
+// Lay out text in a box, returns false when the font is unusable
+bool text_layout(const char *text, const font_t *font, const text_box_t *box, text_layout_t *layout);
+
+// Draw the lines of a layout made for the same text and font
+void text_layout_draw(const char *text, const font_t *font, const text_layout_t *layout, uint8_t color);
+
+#endif // TEXT_LAYOUT_H
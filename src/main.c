@@ -6,11 +6,13 @@
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
 #include "epaper/epaper.h"
+#include "epaper/font_pack.h"
 // WS2812 RGB LED driver
 #include "ws2812.h"
 #include "driver/ledc.h"
 #include "wifi/wifi.h"
 #include "webserver/webserver.h"
+#include "display/display.h"
 #include "config/config.h"
 
 static const char *TAG = "main";
@@ -72,6 +74,9 @@ if (wifi_mgr_is_connected()) {
     ESP_LOGI(TAG, "Loading configuration...");
     config_init();
 
+    // Font packs uploaded with the filesystem (*.epf), loaded on first use
+    font_pack_register_dir("/spiffs");
+
     // Initialize WiFi
     ESP_LOGI(TAG, "Initializing WiFi...");
     wifi_mgr_init();
@@ -117,6 +122,16 @@ if (wifi_mgr_is_connected()) {
         epaper_draw_text(10, 75, "Port: 80", COLOR_BLACK, 1);
         epaper_display_update();
 
+        // From here on the display task owns the framebuffer
+        display_start();
+        const config_t *cfg = config_get();
+        if (cfg->display_debounce_ms >= 0 || cfg->display_max_latency_ms >= 0) {
+            display_stats_t ds;
+            display_get_stats(&ds);
+            display_set_schedule(cfg->display_debounce_ms >= 0 ? (uint32_t)cfg->display_debounce_ms : ds.debounce_ms,
+                                 cfg->display_max_latency_ms >= 0 ? (uint32_t)cfg->display_max_latency_ms : ds.max_latency_ms);
+        }
+
         // Start web server
         ESP_LOGI(TAG, "Starting web server...");
         webserver_start();
@@ -0,0 +1,94 @@
+#include "templates.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *TAG = "templates";
+
+typedef struct {
+    char id[TEMPLATE_ID_LEN];
+    display_job_t *job;  // NULL = free slot
+    uint32_t used;       // Clock of the last use
+} template_slot_t;
+
+static template_slot_t cache[TEMPLATE_CACHE_SIZE];
+static uint32_t cache_clock = 0;
+
+bool template_id_valid(const char *id) {
+    size_t len = strlen(id);
+    if (len == 0 || len >= TEMPLATE_ID_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = id[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '-' || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Read and parse a template file
+static esp_err_t load(const char *id, template_parse_t parse, display_job_t **job) {
+    char path[sizeof(TEMPLATE_DIR) + TEMPLATE_ID_LEN + sizeof(TEMPLATE_EXT)];
+    snprintf(path, sizeof(path), TEMPLATE_DIR "/%s" TEMPLATE_EXT, id);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char *content = malloc(TEMPLATE_MAX_BYTES + 1);
+    if (content == NULL) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    size_t len = fread(content, 1, TEMPLATE_MAX_BYTES + 1, f);
+    fclose(f);
+    if (len > TEMPLATE_MAX_BYTES) {
+        free(content);
+        ESP_LOGE(TAG, "%s is larger than %d bytes", path, TEMPLATE_MAX_BYTES);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    content[len] = '\0';
+
+    *job = parse(content);
+    free(content);
+    if (*job == NULL) {
+        ESP_LOGE(TAG, "%s is not a valid template", path);
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "Loaded %s (%u bytes)", path, (unsigned)len);
+    return ESP_OK;
+}
+
+esp_err_t template_get(const char *id, template_parse_t parse, const display_job_t **job) {
+    if (!template_id_valid(id)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    cache_clock++;
+    template_slot_t *victim = &cache[0];
+    for (int i = 0; i < TEMPLATE_CACHE_SIZE; i++) {
+        template_slot_t *slot = &cache[i];
+        if (slot->job != NULL && strcmp(slot->id, id) == 0) {
+            slot->used = cache_clock;
+            *job = slot->job;
+            return ESP_OK;
+        }
+        if (victim->job != NULL && (slot->job == NULL || slot->used < victim->used)) {
+            victim = slot;
+        }
+    }
+
+    display_job_t *loaded;
+    esp_err_t err = load(id, parse, &loaded);
+    if (err != ESP_OK) {
+        return err;
+    }
+    display_job_free(victim->job);
+    snprintf(victim->id, sizeof(victim->id), "%s", id);
+    victim->job = loaded;
+    victim->used = cache_clock;
+    *job = loaded;
+    return ESP_OK;
+}
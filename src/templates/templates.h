@@ -0,0 +1,37 @@
+#ifndef TEMPLATES_H
+#define TEMPLATES_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "display/display.h"
+
+// Screen templates: layouts stored on SPIFFS as <id>.tpl, parsed once into a
+// display job whose texts hold "{name}" placeholders (display_job_bind()).
+// The parsed jobs are kept in a small LRU cache, so an update only costs
+// binding the values. Template files come with the filesystem image, which
+// restarts the device, so a cached template never goes stale.
+// Not thread safe: the web server task is the only user.
+
+#define TEMPLATE_DIR        "/spiffs"
+#define TEMPLATE_EXT        ".tpl"
+#define TEMPLATE_ID_LEN     24    // Including the terminator, keeps paths within SPIFFS limits
+#define TEMPLATE_MAX_BYTES  4096  // Largest template file
+#define TEMPLATE_CACHE_SIZE 4
+
+// Turns the contents of a template file into a job, NULL when it is invalid
+typedef display_job_t *(*template_parse_t)(const char *content);
+
+bool template_id_valid(const char *id);
+
+/**
+ * @brief Parsed template id, read from SPIFFS and parsed on first use
+ *
+ * The job stays owned by the cache; bind it to get a job to submit.
+ *
+ * @return ESP_OK, ESP_ERR_NOT_FOUND when there is no such file,
+ *         ESP_ERR_INVALID_SIZE when it is too large, ESP_ERR_INVALID_ARG when
+ *         parse rejects it, ESP_ERR_NO_MEM
+ */
+esp_err_t template_get(const char *id, template_parse_t parse, const display_job_t **job);
+
+#endif // TEMPLATES_H
@@ -1,8 +1,16 @@
 #include "webserver.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "cJSON.h"
 #include "epaper/epaper.h"
+#include "epaper/dither.h"
+#include "epaper/image_decode.h"
+#include "display/display.h"
+#include "display/display_list.h"
+#include "widgets/widgets.h"
+#include "templates/templates.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -152,6 +160,124 @@ static esp_err_t index_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+static esp_err_t send_bad_request(httpd_req_t *req, const char *error) {
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"error\":\"%s\"}", error);
+    httpd_resp_set_status(req, "400 Bad Request");
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+// Reply to a request whose drawing was handed to the display service
+static esp_err_t send_job_response(httpd_req_t *req, esp_err_t err, const char *message) {
+    httpd_resp_set_type(req, "application/json");
+    if (err != ESP_OK) {
+        const char *resp = "{\"error\":\"Display busy, try again later\"}";
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_OK;
+    }
+
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"success\":true,\"message\":\"%s\"}", message);
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+// "font" field: an id or the name of a font (built-in or font pack)
+static uint8_t parse_font(const cJSON *item, uint8_t fallback) {
+    if (item && cJSON_IsNumber(item)) {
+        return item->valueint;
+    }
+    if (item && cJSON_IsString(item)) {
+        int id = font_find(item->valuestring);
+        if (id >= 0) {
+            return id;
+        }
+        ESP_LOGW(TAG, "Unknown font '%s'", item->valuestring);
+    }
+    return fallback;
+}
+
+static const char *const align_names[] = { "left", "center", "right" };
+static const char *const valign_names[] = { "top", "middle", "bottom" };
+
+// Index of value in names, -1 when it isn't there
+static int name_index(const char *value, const char *const *names, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(value, names[i]) == 0) {
+            return i;
+        }
+    }
+    ESP_LOGW(TAG, "Unknown value '%s'", value);
+    return -1;
+}
+
+// Field given as a number or as one of names (its index)
+static uint8_t parse_choice(const cJSON *item, const char *const *names, uint8_t count, uint8_t fallback) {
+    if (item && cJSON_IsNumber(item) && item->valueint >= 0 && item->valueint < count) {
+        return item->valueint;
+    }
+    if (item && cJSON_IsString(item)) {
+        int index = name_index(item->valuestring, names, count);
+        if (index >= 0) {
+            return index;
+        }
+    }
+    return fallback;
+}
+
+static const char *const layer_names[] = { "background", "overlay1", "overlay2", "overlay3" };
+
+// "layer" field: a layer index or name, the framebuffer itself when left out.
+// Returns false for an unknown layer, which must not end up clearing the screen.
+static bool parse_layer(const cJSON *json, display_job_t *job) {
+    cJSON *layer_item = cJSON_GetObjectItem(json, "layer");
+    if (layer_item == NULL) {
+        return true;
+    }
+    uint8_t layer = parse_choice(layer_item, layer_names, EPAPER_LAYER_COUNT, EPAPER_LAYER_NONE);
+    display_job_set_layer(job, layer);
+    return layer != EPAPER_LAYER_NONE;
+}
+
+// Reply to a request with an unknown layer
+static esp_err_t reject_layer(httpd_req_t *req, cJSON *json, display_job_t *job) {
+    display_job_free(job);
+    cJSON_Delete(json);
+    return send_bad_request(req, "Unknown layer");
+}
+
+// Layout fields of a text item: w, h, align, valign, wrap, fit, line_gap.
+// Returns false when there are none, the text is then drawn at x, y as is.
+static bool parse_text_box(const cJSON *item, uint16_t x, uint16_t y, text_box_t *box) {
+    cJSON *w_item = cJSON_GetObjectItem(item, "w");
+    cJSON *h_item = cJSON_GetObjectItem(item, "h");
+    cJSON *align_item = cJSON_GetObjectItem(item, "align");
+    cJSON *valign_item = cJSON_GetObjectItem(item, "valign");
+    cJSON *wrap_item = cJSON_GetObjectItem(item, "wrap");
+    cJSON *fit_item = cJSON_GetObjectItem(item, "fit");
+    cJSON *gap_item = cJSON_GetObjectItem(item, "line_gap");
+    cJSON *scale_item = cJSON_GetObjectItem(item, "scale");
+
+    if (!w_item && !h_item && !align_item && !valign_item && !wrap_item && !fit_item && !gap_item) {
+        return false;
+    }
+    memset(box, 0, sizeof(*box));
+    box->x = x;
+    box->y = y;
+    box->w = w_item && cJSON_IsNumber(w_item) ? w_item->valueint : 0;
+    box->h = h_item && cJSON_IsNumber(h_item) ? h_item->valueint : 0;
+    box->align = parse_choice(align_item, align_names, 3, TEXT_ALIGN_LEFT);
+    box->valign = parse_choice(valign_item, valign_names, 3, TEXT_VALIGN_TOP);
+    box->wrap = wrap_item && cJSON_IsTrue(wrap_item);
+    box->fit = fit_item && cJSON_IsTrue(fit_item);
+    box->line_gap = gap_item && cJSON_IsNumber(gap_item) ? gap_item->valueint : TEXT_LAYOUT_LINE_GAP;
+    // With fit, scale is the largest one to try (all of them when left out)
+    box->scale = scale_item && cJSON_IsNumber(scale_item) ? scale_item->valueint : (box->fit ? 0 : 1);
+    return true;
+}
+
 // POST /api/text - Display text
 static esp_err_t api_text_handler(httpd_req_t *req) {
     char content[512];
@@ -181,6 +307,7 @@ static esp_err_t api_text_handler(httpd_req_t *req) {
     cJSON *color_item = cJSON_GetObjectItem(json, "color");
     cJSON *scale_item = cJSON_GetObjectItem(json, "scale");
     cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    cJSON *font_item = cJSON_GetObjectItem(json, "font");
 
     // Default values
     const char *text = text_item && cJSON_IsString(text_item) ? text_item->valuestring : "Hello";
@@ -189,27 +316,59 @@ static esp_err_t api_text_handler(httpd_req_t *req) {
     uint8_t color = color_item && cJSON_IsNumber(color_item) ? color_item->valueint : COLOR_BLACK;
     uint8_t scale = scale_item && cJSON_IsNumber(scale_item) ? scale_item->valueint : 1;
     bool clear = clear_item && cJSON_IsBool(clear_item) ? cJSON_IsTrue(clear_item) : true;
+    uint8_t font = parse_font(font_item, FONT_ID_5X8);
 
     ESP_LOGI(TAG, "Displaying text: '%s' at (%d,%d) color=%d scale=%d", text, x, y, color, scale);
 
-    // Clear display if requested
-    if (clear) {
-        epaper_display_clear();
+    display_job_t *job = display_job_create(1, strlen(text) + 1);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
     }
+    display_job_set_clear(job, clear); // Clear display if requested
+    if (!parse_layer(json, job)) {
+        return reject_layer(req, json, job);
+    }
+    text_box_t box;
+    if (parse_text_box(json, x, y, &box)) {
+        display_job_add_text_box(job, &box, text, font, color);
+    } else {
+        display_job_add_text(job, x, y, text, font, color, scale);
+    }
+    cJSON_Delete(json);
 
-    // Draw text
-    epaper_draw_text(x, y, text, color, scale);
+    // Drawing and refresh happen on the display task
+    return send_job_response(req, display_submit(job), "Text queued");
+}
 
-    // Update display
-    epaper_display_update();
+// Add one entry of a "texts" array to a job
+static void add_text_item(display_job_t *job, const cJSON *item) {
+    if (!cJSON_IsObject(item)) {
+        return;
+    }
+    cJSON *text_item = cJSON_GetObjectItem(item, "text");
+    cJSON *x_item = cJSON_GetObjectItem(item, "x");
+    cJSON *y_item = cJSON_GetObjectItem(item, "y");
+    cJSON *color_item = cJSON_GetObjectItem(item, "color");
+    cJSON *scale_item = cJSON_GetObjectItem(item, "scale");
+    cJSON *font_item = cJSON_GetObjectItem(item, "font");
+
+    const char *text = text_item && cJSON_IsString(text_item) ? text_item->valuestring : "";
+    uint16_t x = x_item && cJSON_IsNumber(x_item) ? x_item->valueint : 0;
+    uint16_t y = y_item && cJSON_IsNumber(y_item) ? y_item->valueint : 0;
+    uint8_t color = color_item && cJSON_IsNumber(color_item) ? color_item->valueint : COLOR_BLACK;
+    uint8_t scale = scale_item && cJSON_IsNumber(scale_item) ? scale_item->valueint : 1;
+    uint8_t font = parse_font(font_item, FONT_ID_6X12); // Default to medium font
 
-    // Send response
-    const char *resp = "{\"success\":true,\"message\":\"Text displayed\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp, strlen(resp));
+    ESP_LOGI(TAG, "  '%s' at (%d,%d) color=%d scale=%d font=%d", text, x, y, color, scale, font);
 
-    cJSON_Delete(json);
-    return ESP_OK;
+    text_box_t box;
+    if (parse_text_box(item, x, y, &box)) {
+        display_job_add_text_box(job, &box, text, font, color);
+    } else {
+        display_job_add_text(job, x, y, text, font, color, scale);
+    }
 }
 
 // POST /api/multi - Display multiple texts
@@ -242,14 +401,6 @@ static esp_err_t api_multi_handler(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
-    // Get optional global orientation (applied to all texts)
-    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
-    if (orientation_item && cJSON_IsNumber(orientation_item)) {
-        uint8_t orientation = orientation_item->valueint;
-        ESP_LOGI(TAG, "Setting global orientation to %d°", orientation * 90);
-        epaper_set_orientation(orientation);
-    }
-
     // Get texts array
     cJSON *texts = cJSON_GetObjectItem(json, "texts");
     if (!cJSON_IsArray(texts)) {
@@ -263,65 +414,60 @@ static esp_err_t api_multi_handler(httpd_req_t *req) {
     int count = cJSON_GetArraySize(texts);
     ESP_LOGI(TAG, "Drawing %d text items", count);
 
-    // Clear display first
-    epaper_display_clear();
-
-    // Draw each text item
+    // Size the job: one op and one string copy per item
+    size_t text_bytes = 0;
     for (int i = 0; i < count; i++) {
-        cJSON *item = cJSON_GetArrayItem(texts, i);
-        if (!cJSON_IsObject(item)) continue;
-
-        cJSON *text_item = cJSON_GetObjectItem(item, "text");
-        cJSON *x_item = cJSON_GetObjectItem(item, "x");
-        cJSON *y_item = cJSON_GetObjectItem(item, "y");
-        cJSON *color_item = cJSON_GetObjectItem(item, "color");
-        cJSON *scale_item = cJSON_GetObjectItem(item, "scale");
-        cJSON *font_item = cJSON_GetObjectItem(item, "font");
-
-        const char *text = text_item && cJSON_IsString(text_item) ? text_item->valuestring : "";
-        uint16_t x = x_item && cJSON_IsNumber(x_item) ? x_item->valueint : 0;
-        uint16_t y = y_item && cJSON_IsNumber(y_item) ? y_item->valueint : 0;
-        uint8_t color = color_item && cJSON_IsNumber(color_item) ? color_item->valueint : COLOR_BLACK;
-        uint8_t scale = scale_item && cJSON_IsNumber(scale_item) ? scale_item->valueint : 1;
-        uint8_t font = font_item && cJSON_IsNumber(font_item) ? font_item->valueint : 1; // Default to medium font
-
-        ESP_LOGI(TAG, "  [%d] '%s' at (%d,%d) color=%d scale=%d font=%d", i, text, x, y, color, scale, font);
-
-        // Use appropriate font (uses global orientation)
-        if (font == 0) {
-            epaper_draw_text(x, y, text, color, scale);  // Small 5x8 font
-        } else if (font == 1) {
-            epaper_draw_text_6x12(x, y, text, color, scale);  // Medium 6x12 font
-        } else {
-            epaper_draw_text_8x16(x, y, text, color, scale);  // Large 8x16 font
+        cJSON *text_item = cJSON_GetObjectItem(cJSON_GetArrayItem(texts, i), "text");
+        if (text_item && cJSON_IsString(text_item)) {
+            text_bytes += strlen(text_item->valuestring);
         }
+        text_bytes++;
+    }
+    display_job_t *job = display_job_create(count, text_bytes);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
     }
 
-    // Update display once with all texts
-    epaper_display_update();
+    // Get optional global orientation (applied to all texts)
+    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
+    if (orientation_item && cJSON_IsNumber(orientation_item)) {
+        uint8_t orientation = orientation_item->valueint;
+        ESP_LOGI(TAG, "Setting global orientation to %d°", orientation * 90);
+        display_job_set_orientation(job, orientation);
+    }
 
-    // Send response
-    char resp[128];
-    snprintf(resp, sizeof(resp), "{\"success\":true,\"message\":\"%d texts displayed\"}", count);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp, strlen(resp));
+    // Clear display first (only the layer when one is given)
+    display_job_set_clear(job, true);
+    if (!parse_layer(json, job)) {
+        return reject_layer(req, json, job);
+    }
 
+    // Draw each text item
+    for (int i = 0; i < count; i++) {
+        add_text_item(job, cJSON_GetArrayItem(texts, i));
+    }
     cJSON_Delete(json);
-    return ESP_OK;
+
+    // Update display once with all texts
+    char message[48];
+    snprintf(message, sizeof(message), "%d texts queued", count);
+    return send_job_response(req, display_submit(job), message);
 }
 
 // POST /api/clear - Clear display
 static esp_err_t api_clear_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "Clearing display");
 
-    epaper_display_clear();
-    epaper_display_update();
-
-    const char *resp = "{\"success\":true,\"message\":\"Display cleared\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp, strlen(resp));
+    display_job_t *job = display_job_create(0, 0);
+    if (job == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    display_job_set_clear(job, true);
 
-    return ESP_OK;
+    return send_job_response(req, display_submit(job), "Display clear queued");
 }
 
 // POST /api/rect - Draw rectangle
@@ -351,6 +497,8 @@ static esp_err_t api_rect_handler(httpd_req_t *req) {
     cJSON *h_item = cJSON_GetObjectItem(json, "h");
     cJSON *color_item = cJSON_GetObjectItem(json, "color");
     cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    cJSON *radius_item = cJSON_GetObjectItem(json, "radius");
+    cJSON *thickness_item = cJSON_GetObjectItem(json, "thickness");
 
     uint16_t x = x_item && cJSON_IsNumber(x_item) ? x_item->valueint : 0;
     uint16_t y = y_item && cJSON_IsNumber(y_item) ? y_item->valueint : 0;
@@ -358,30 +506,101 @@ static esp_err_t api_rect_handler(httpd_req_t *req) {
     uint16_t h = h_item && cJSON_IsNumber(h_item) ? h_item->valueint : 50;
     uint8_t color = color_item && cJSON_IsNumber(color_item) ? color_item->valueint : COLOR_BLACK;
     bool clear = clear_item && cJSON_IsBool(clear_item) ? cJSON_IsTrue(clear_item) : false;
+    // Filled unless a thickness is given
+    uint16_t radius = radius_item && cJSON_IsNumber(radius_item) ? radius_item->valueint : 0;
+    uint8_t thickness = thickness_item && cJSON_IsNumber(thickness_item) ? thickness_item->valueint : 0;
 
-    ESP_LOGI(TAG, "Drawing rect: (%d,%d) %dx%d color=%d", x, y, w, h, color);
+    ESP_LOGI(TAG, "Drawing rect: (%d,%d) %dx%d color=%d radius=%d thickness=%d", x, y, w, h, color,
+             radius, thickness);
 
-    if (clear) {
-        epaper_display_clear();
+    display_job_t *job = display_job_create(1, 0);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    display_job_set_clear(job, clear);
+    if (!parse_layer(json, job)) {
+        return reject_layer(req, json, job);
+    }
+    cJSON_Delete(json);
+    if (radius > 0 || thickness > 0) {
+        display_job_add_round_rect(job, x, y, w, h, radius, thickness, color);
+    } else {
+        display_job_add_rect(job, x, y, w, h, color);
     }
 
-    epaper_rect(x, y, w, h, color);
-    epaper_display_update();
+    return send_job_response(req, display_submit(job), "Rectangle queued");
+}
 
-    const char *resp = "{\"success\":true,\"message\":\"Rectangle drawn\"}";
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, resp, strlen(resp));
+static int json_int(const cJSON *obj, const char *name, int fallback) {
+    cJSON *item = cJSON_GetObjectItem(obj, name);
+    return item && cJSON_IsNumber(item) ? item->valueint : fallback;
+}
 
-    cJSON_Delete(json);
-    return ESP_OK;
+enum { SHAPE_LINE, SHAPE_RECT, SHAPE_CIRCLE, SHAPE_ARC, SHAPE_POLYGON, SHAPE_UNKNOWN = 0xFF };
+static const char *const shape_names[] = { "line", "rect", "circle", "arc", "polygon" };
+
+// Outline width of a closed shape: "fill": true or "thickness" (default 1)
+static uint8_t parse_thickness(const cJSON *item) {
+    cJSON *fill_item = cJSON_GetObjectItem(item, "fill");
+    if (fill_item && cJSON_IsTrue(fill_item)) {
+        return 0;
+    }
+    return json_int(item, "thickness", 1);
 }
 
-// POST /api/orientation - Set global screen orientation
-static esp_err_t api_orientation_handler(httpd_req_t *req) {
-    char content[128];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+// Add one entry of the "shapes" array to a job
+static esp_err_t add_shape(display_job_t *job, const cJSON *item) {
+    uint8_t type = parse_choice(cJSON_GetObjectItem(item, "type"), shape_names, 5, SHAPE_UNKNOWN);
+    uint8_t color = json_int(item, "color", COLOR_BLACK);
+    int16_t x = json_int(item, "x", 0), y = json_int(item, "y", 0);
+
+    switch (type) {
+        case SHAPE_LINE:
+            return display_job_add_line(job, json_int(item, "x0", 0), json_int(item, "y0", 0),
+                                        json_int(item, "x1", 0), json_int(item, "y1", 0),
+                                        json_int(item, "thickness", 1), color);
+        case SHAPE_RECT:
+            return display_job_add_round_rect(job, x, y, json_int(item, "w", 0), json_int(item, "h", 0),
+                                              json_int(item, "radius", 0), parse_thickness(item), color);
+        case SHAPE_CIRCLE:
+            return display_job_add_circle(job, x, y, json_int(item, "r", 0), parse_thickness(item), color);
+        case SHAPE_ARC:
+            return display_job_add_arc(job, x, y, json_int(item, "r", 0), json_int(item, "start", 0),
+                                       json_int(item, "end", 360), parse_thickness(item), color);
+        case SHAPE_POLYGON: {
+            cJSON *points = cJSON_GetObjectItem(item, "points");
+            int count = cJSON_IsArray(points) ? cJSON_GetArraySize(points) : 0;
+            if (count == 0 || count > EPAPER_POLYGON_MAX_POINTS) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            int16_t xy[2 * EPAPER_POLYGON_MAX_POINTS];
+            for (int i = 0; i < count; i++) {
+                cJSON *point = cJSON_GetArrayItem(points, i);
+                cJSON *px = cJSON_GetArrayItem(point, 0), *py = cJSON_GetArrayItem(point, 1);
+                xy[2 * i] = px && cJSON_IsNumber(px) ? px->valueint : 0;
+                xy[2 * i + 1] = py && cJSON_IsNumber(py) ? py->valueint : 0;
+            }
+            return display_job_add_polygon(job, xy, count, color);
+        }
+        default:
+            return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// POST /api/shapes - Draw lines, rectangles, circles, arcs and polygons
+static esp_err_t api_shapes_handler(httpd_req_t *req) {
+    char *content = malloc(2048);
+    if (content == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    int ret = httpd_req_recv(req, content, 2047);
 
     if (ret <= 0) {
+        free(content);
         httpd_resp_send_500(req);
         return ESP_FAIL;
     }
@@ -389,6 +608,8 @@ static esp_err_t api_orientation_handler(httpd_req_t *req) {
     content[ret] = '\0';
 
     cJSON *json = cJSON_Parse(content);
+    free(content);
+
     if (json == NULL) {
         const char *resp = "{\"error\":\"Invalid JSON\"}";
         httpd_resp_set_type(req, "application/json");
@@ -396,56 +617,1138 @@ static esp_err_t api_orientation_handler(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
-    // Extract orientation parameter
-    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
-    if (!orientation_item || !cJSON_IsNumber(orientation_item)) {
-        const char *resp = "{\"error\":\"Missing or invalid orientation parameter\"}";
+    cJSON *shapes = cJSON_GetObjectItem(json, "shapes");
+    if (!cJSON_IsArray(shapes)) {
+        const char *resp = "{\"error\":\"shapes must be an array\"}";
         httpd_resp_set_type(req, "application/json");
         httpd_resp_send(req, resp, strlen(resp));
         cJSON_Delete(json);
         return ESP_FAIL;
     }
 
-    uint8_t orientation = orientation_item->valueint;
-    if (orientation > ORIENTATION_270) {
-        const char *resp = "{\"error\":\"Invalid orientation value (must be 0-3)\"}";
+    // Size the job: one op per shape, polygon points in the data area
+    int count = cJSON_GetArraySize(shapes);
+    size_t data_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        cJSON *points = cJSON_GetObjectItem(cJSON_GetArrayItem(shapes, i), "points");
+        if (cJSON_IsArray(points)) {
+            data_bytes += (size_t)cJSON_GetArraySize(points) * 2 * sizeof(int16_t) + 1;
+        }
+    }
+    display_job_t *job = display_job_create(count, data_bytes);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    display_job_set_clear(job, clear_item && cJSON_IsTrue(clear_item));
+    if (!parse_layer(json, job)) {
+        return reject_layer(req, json, job);
+    }
+    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
+    if (orientation_item && cJSON_IsNumber(orientation_item)) {
+        display_job_set_orientation(job, orientation_item->valueint);
+    }
+
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        if (add_shape(job, cJSON_GetArrayItem(shapes, i)) == ESP_OK) {
+            added++;
+        } else {
+            ESP_LOGW(TAG, "Skipping invalid shape %d", i);
+        }
+    }
+    cJSON_Delete(json);
+
+    ESP_LOGI(TAG, "Drawing %d of %d shapes", added, count);
+    char message[48];
+    snprintf(message, sizeof(message), "%d shapes queued", added);
+    return send_job_response(req, display_submit(job), message);
+}
+
+#define TEMPLATE_MAX_FIELDS 16
+
+// Contents of a template file: "texts" as for /api/multi, "shapes" as for
+// /api/shapes, "clear" (default true), "orientation" and "layer".
+// Texts may contain "{name}" placeholders, filled in per request.
+static display_job_t *parse_template(const char *content) {
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        return NULL;
+    }
+    cJSON *texts = cJSON_GetObjectItem(json, "texts");
+    cJSON *shapes = cJSON_GetObjectItem(json, "shapes");
+
+    // Size the job as /api/multi and /api/shapes do
+    int count = 0;
+    size_t data_bytes = 0;
+    cJSON *item;
+    cJSON_ArrayForEach(item, texts) {
+        cJSON *text_item = cJSON_GetObjectItem(item, "text");
+        if (text_item && cJSON_IsString(text_item)) {
+            data_bytes += strlen(text_item->valuestring);
+        }
+        data_bytes++;
+        count++;
+    }
+    cJSON_ArrayForEach(item, shapes) {
+        cJSON *points = cJSON_GetObjectItem(item, "points");
+        if (cJSON_IsArray(points)) {
+            data_bytes += (size_t)cJSON_GetArraySize(points) * 2 * sizeof(int16_t) + 1;
+        }
+        count++;
+    }
+    display_job_t *job = display_job_create(count, data_bytes);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        return NULL;
+    }
+
+    cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    display_job_set_clear(job, !clear_item || cJSON_IsTrue(clear_item));
+    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
+    if (orientation_item && cJSON_IsNumber(orientation_item)) {
+        display_job_set_orientation(job, orientation_item->valueint);
+    }
+    if (!parse_layer(json, job)) {
+        display_job_free(job);
+        cJSON_Delete(json);
+        return NULL;
+    }
+    cJSON_ArrayForEach(item, texts) {
+        add_text_item(job, item);
+    }
+    cJSON_ArrayForEach(item, shapes) {
+        if (add_shape(job, item) != ESP_OK) {
+            ESP_LOGW(TAG, "Skipping invalid template shape");
+        }
+    }
+    cJSON_Delete(json);
+    return job;
+}
+
+// POST /api/template - Draw a stored template: {"id": "...", "data": {"name": value}}
+static esp_err_t api_template_handler(httpd_req_t *req) {
+    char content[512];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        return send_bad_request(req, "Invalid JSON");
+    }
+    cJSON *id_item = cJSON_GetObjectItem(json, "id");
+    if (!id_item || !cJSON_IsString(id_item)) {
+        cJSON_Delete(json);
+        return send_bad_request(req, "Missing template id");
+    }
+
+    const display_job_t *tpl;
+    esp_err_t err = template_get(id_item->valuestring, parse_template, &tpl);
+    if (err == ESP_ERR_NOT_FOUND) {
+        cJSON_Delete(json);
+        const char *resp = "{\"error\":\"No such template\"}";
         httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_status(req, "404 Not Found");
         httpd_resp_send(req, resp, strlen(resp));
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
         cJSON_Delete(json);
+        return send_bad_request(req, err == ESP_ERR_NO_MEM ? "Out of memory" : "Invalid template");
+    }
+
+    // Strings are bound as they are, numbers and booleans printed
+    display_field_t fields[TEMPLATE_MAX_FIELDS];
+    char numbers[TEMPLATE_MAX_FIELDS][16];
+    uint8_t field_count = 0;
+    cJSON *item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(json, "data")) {
+        if (field_count == TEMPLATE_MAX_FIELDS || item->string == NULL) {
+            break;
+        }
+        display_field_t *field = &fields[field_count];
+        field->name = item->string;
+        if (cJSON_IsString(item)) {
+            field->value = item->valuestring;
+        } else if (cJSON_IsNumber(item)) {
+            snprintf(numbers[field_count], sizeof(numbers[0]), "%g", item->valuedouble);
+            field->value = numbers[field_count];
+        } else if (cJSON_IsBool(item)) {
+            field->value = cJSON_IsTrue(item) ? "true" : "false";
+        } else {
+            continue;
+        }
+        field_count++;
+    }
+
+    display_job_t *job = display_job_bind(tpl, fields, field_count);
+    cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    if (job != NULL && clear_item && cJSON_IsBool(clear_item)) {
+        display_job_set_clear(job, cJSON_IsTrue(clear_item));
+    }
+    cJSON_Delete(json);
+    if (job == NULL) {
+        httpd_resp_send_500(req);
         return ESP_FAIL;
     }
+    return send_job_response(req, display_submit(job), "Template queued");
+}
 
-    ESP_LOGI(TAG, "Setting global orientation to %d° (%d)", orientation * 90, orientation);
-    epaper_set_orientation(orientation);
+// Integer query parameter
+static int query_int(const char *query, const char *key, int fallback) {
+    char value[12];
+    if (query == NULL || httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return fallback;
+    }
+    return atoi(value);
+}
 
-    char resp[128];
-    snprintf(resp, sizeof(resp), "{\"success\":true,\"orientation\":%d,\"degrees\":%d}", orientation, orientation * 90);
+static const char *const plane_names[] = { "", "bw", "red", "both" };
+
+// Throughput and heap use of one upload, reported with the reply
+typedef struct {
+    int64_t start_us;
+    size_t start_free;
+    size_t min_free;
+    size_t bytes;
+} upload_stats_t;
+
+static void upload_stats_begin(upload_stats_t *stats) {
+    stats->start_us = esp_timer_get_time();
+    stats->start_free = stats->min_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    stats->bytes = 0;
+}
+
+// Called once per received chunk, with all buffers of the upload allocated
+static void upload_stats_sample(upload_stats_t *stats, size_t bytes) {
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    if (free_now < stats->min_free) {
+        stats->min_free = free_now;
+    }
+    stats->bytes += bytes;
+}
+
+// Reply to an upload written into the framebuffer, queueing the refresh if asked
+static esp_err_t finish_upload(httpd_req_t *req, bool refresh, const char *message, const upload_stats_t *stats) {
+    int64_t us = esp_timer_get_time() - stats->start_us;
+    unsigned kbytes_per_s = us > 0 ? (unsigned)((int64_t)stats->bytes * 1000000 / 1024 / us) : 0;
+    unsigned heap_peak = (unsigned)(stats->start_free - stats->min_free);
+    ESP_LOGI(TAG, "%s: %u bytes in %lld us (%u KB/s), peak heap %u bytes", message, (unsigned)stats->bytes,
+             (long long)us, kbytes_per_s, heap_peak);
+
+    if (refresh) {
+        // Nothing left to draw, the job only asks for the refresh
+        display_job_t *job = display_job_create(0, 0);
+        if (job == NULL) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        esp_err_t err = display_submit(job);
+        if (err != ESP_OK) {
+            return send_job_response(req, err, message);
+        }
+    }
+
+    char resp[256];
+    snprintf(resp, sizeof(resp),
+             "{\"success\":true,\"message\":\"%s%s\",\"bytes\":%u,\"us\":%lld,"
+             "\"kbytes_per_s\":%u,\"heap_peak\":%u}",
+             message, refresh ? ", refresh queued" : "", (unsigned)stats->bytes, (long long)us, kbytes_per_s,
+             heap_peak);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
 
-    cJSON_Delete(json);
+#define BITMAP_RECV_RETRIES 3
+
+// Uploads hold the display lock while they write into the framebuffer, so the
+// display task waits for them: slower ones are aborted to keep queued jobs
+// within their latency. Receive calls time out after 1 s (webserver_start()).
+#define UPLOAD_MAX_MS 1500
+
+static bool upload_expired(const upload_stats_t *stats) {
+    return esp_timer_get_time() - stats->start_us > (int64_t)UPLOAD_MAX_MS * 1000;
+}
+
+static esp_err_t send_upload_timeout(httpd_req_t *req) {
+    char resp[64];
+    snprintf(resp, sizeof(resp), "{\"error\":\"Upload took over %d ms\"}", UPLOAD_MAX_MS);
+    httpd_resp_set_status(req, "408 Request Timeout");
+    httpd_resp_send(req, resp, strlen(resp));
     return ESP_OK;
 }
 
-// Start web server
-esp_err_t webserver_start(void) {
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.lru_purge_enable = true;
-    config.server_port = 80;
+// POST /api/bitmap?x=&y=&w=&h=&planes=bw|red|both&refresh=1 - Load packed planes.
+// The body is received straight into the framebuffers, no copy of the payload is kept.
+static esp_err_t api_bitmap_handler(httpd_req_t *req) {
+    char query[96];
+    const char *q = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK ? query : NULL;
+    char planes_value[8] = "both";
+    if (q != NULL) {
+        httpd_query_key_value(q, "planes", planes_value, sizeof(planes_value));
+    }
+    int planes = name_index(planes_value, plane_names, 4);
 
-    ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
+    uint16_t x = query_int(q, "x", 0), y = query_int(q, "y", 0);
+    uint16_t w = query_int(q, "w", SCREEN_2_6_WIDTH), h = query_int(q, "h", SCREEN_2_6_HEIGHT);
+    bool refresh = query_int(q, "refresh", 1) != 0;
 
-    if (httpd_start(&server, &config) == ESP_OK) {
-        // Register URI handlers
-        httpd_uri_t index_uri = {
-            .uri = "/",
-            .method = HTTP_GET,
-            .handler = index_handler,
-            .user_ctx = NULL
-        };
-        httpd_register_uri_handler(server, &index_uri);
+    httpd_resp_set_type(req, "application/json");
 
-        httpd_uri_t api_text_uri = {
+    // Held for the whole upload, so no refresh shows half an image; a failed
+    // upload leaves its window white
+    display_lock();
+    epaper_bitmap_t bm;
+    esp_err_t err = planes > 0 ? epaper_bitmap_begin(&bm, x, y, w, h, planes) : ESP_ERR_INVALID_ARG;
+    if (err != ESP_OK || req->content_len != bm.size) {
+        display_unlock();
+        char resp[128];
+        if (err != ESP_OK) {
+            snprintf(resp, sizeof(resp), "{\"error\":\"Invalid window or planes\"}");
+        } else {
+            snprintf(resp, sizeof(resp), "{\"error\":\"Body must be %u bytes\"}", (unsigned)bm.size);
+        }
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_OK;
+    }
+
+    display_record_break();
+    upload_stats_t stats;
+    upload_stats_begin(&stats);
+    int retries = 0;
+    uint8_t *dest;
+    size_t span;
+    bool expired = false;
+    while ((span = epaper_bitmap_span(&bm, &dest)) > 0 && !(expired = upload_expired(&stats))) {
+        int ret = httpd_req_recv(req, (char *)dest, span);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++retries <= BITMAP_RECV_RETRIES) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        epaper_bitmap_advance(&bm, ret);
+        upload_stats_sample(&stats, ret);
+    }
+    if (bm.offset < bm.size) {
+        epaper_bitmap_abort(&bm);
+    }
+    display_unlock();
+
+    if (bm.offset < bm.size) {
+        ESP_LOGE(TAG, "Bitmap upload aborted after %u of %u bytes", (unsigned)bm.offset, (unsigned)bm.size);
+        if (expired) {
+            return send_upload_timeout(req);
+        }
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Bitmap %dx%d at (%d,%d)", w, h, x, y);
+    return finish_upload(req, refresh, "Bitmap loaded", &stats);
+}
+
+static const char *const format_names[] = { "gray", "rgb", "bmp", "png" };
+static const char *const dither_names[] = { "threshold", "bayer", "fs" };
+
+#define FORMAT_FILE 2  // format_names from here on are files for image_decode.h
+#define IMAGE_CHUNK 512
+
+// "format" parameter, or the Content-Type of the body without one
+static int image_format(httpd_req_t *req, const char *query) {
+    char value[32];
+    if (query != NULL && httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) {
+        return name_index(value, format_names, 4);
+    }
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", value, sizeof(value)) == ESP_OK) {
+        if (strcmp(value, "image/bmp") == 0) {
+            return FORMAT_FILE;
+        }
+        if (strcmp(value, "image/png") == 0) {
+            return FORMAT_FILE + 1;
+        }
+    }
+    return DITHER_GRAY8;
+}
+
+// POST /api/image?x=&y=&w=&h=&format=gray|rgb|bmp|png&dither=threshold|bayer|fs&threshold=128&red=1&refresh=1
+// 8-bit gray or RGB888 rows, or a BMP or PNG file (size from the file), converted to
+// white/black/red while they arrive
+static esp_err_t api_image_handler(httpd_req_t *req) {
+    char query[160];
+    const char *q = httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK ? query : NULL;
+    char dither_value[12] = "fs";
+    if (q != NULL) {
+        httpd_query_key_value(q, "dither", dither_value, sizeof(dither_value));
+    }
+    int format = image_format(req, q);
+    int method = name_index(dither_value, dither_names, 3);
+
+    dither_t d = {
+        .x = query_int(q, "x", 0),
+        .y = query_int(q, "y", 0),
+        .w = query_int(q, "w", SCREEN_2_6_WIDTH),
+        .h = query_int(q, "h", SCREEN_2_6_HEIGHT),
+        .format = format < 0 ? 0xFF : format,
+        .method = method < 0 ? 0xFF : method,
+        .threshold = query_int(q, "threshold", 128),
+        .red = query_int(q, "red", 1) != 0,
+    };
+    bool refresh = query_int(q, "refresh", 1) != 0;
+    bool file = format >= FORMAT_FILE;
+
+    httpd_resp_set_type(req, "application/json");
+    if (format < 0 || method < 0) {
+        return send_bad_request(req, "Invalid format or dither");
+    }
+    upload_stats_t stats;
+    upload_stats_begin(&stats);
+    uint8_t *chunk = malloc(IMAGE_CHUNK);
+    image_decoder_t *dec = file ? image_decoder_create(&d) : NULL;
+    if (chunk == NULL || (file && dec == NULL)) {
+        free(chunk);
+        image_decoder_free(dec);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    // Held for the whole upload, so no refresh shows half an image; a failed
+    // upload leaves the image area white
+    display_lock();
+    esp_err_t err = file ? ESP_OK : dither_begin(&d);
+    if (err != ESP_OK || (!file && req->content_len != dither_size(&d))) {
+        display_unlock();
+        free(chunk);
+        if (err == ESP_ERR_NO_MEM) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        if (err != ESP_OK) {
+            return send_bad_request(req, "Invalid size");
+        }
+        dither_end(&d);
+        char error[48];
+        snprintf(error, sizeof(error), "Body must be %u bytes", (unsigned)dither_size(&d));
+        return send_bad_request(req, error);
+    }
+
+    display_record_break();
+    size_t remaining = req->content_len;
+    int retries = 0;
+    bool expired = false;
+    while (remaining > 0 && err == ESP_OK && !(expired = upload_expired(&stats))) {
+        int ret = httpd_req_recv(req, (char *)chunk, remaining < IMAGE_CHUNK ? remaining : IMAGE_CHUNK);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++retries <= BITMAP_RECV_RETRIES) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        if (file) {
+            err = image_decoder_write(dec, chunk, ret);
+        } else {
+            dither_write(&d, chunk, ret);
+        }
+        remaining -= ret;
+        upload_stats_sample(&stats, ret);
+    }
+    bool done = file ? image_decoder_done(dec) : dither_done(&d);
+    image_info_t info = { .width = d.w, .height = d.h };
+    if (file) {
+        image_decoder_get_info(dec, &info);
+        image_decoder_free(dec);
+    } else {
+        dither_end(&d);
+    }
+    if ((err != ESP_OK || !done) && info.width > 0 && info.height > 0) {
+        // Rows already drawn would show at the next refresh: blank the image instead.
+        // Filled shapes take negative positions, like the rows of the image.
+        epaper_round_rect(d.x, d.y, info.width < SCREEN_2_6_HEIGHT ? info.width : SCREEN_2_6_HEIGHT,
+                          info.height < SCREEN_2_6_HEIGHT ? info.height : SCREEN_2_6_HEIGHT, 0, 0, COLOR_WHITE);
+    }
+    display_unlock();
+    free(chunk);
+
+    if (err != ESP_OK) {
+        return send_bad_request(req, err == ESP_ERR_NOT_SUPPORTED ? "Unsupported image" : "Corrupt image");
+    }
+    if (!done) {
+        ESP_LOGE(TAG, "Image upload aborted, %u bytes missing", (unsigned)remaining);
+        if (expired) {
+            return send_upload_timeout(req);
+        }
+        if (file && remaining == 0) {
+            return send_bad_request(req, "Image truncated");
+        }
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Image %lux%lu at (%d,%d) %s/%s, decoder heap %u bytes", (unsigned long)info.width,
+             (unsigned long)info.height, d.x, d.y, format_names[format], dither_value, (unsigned)info.heap_bytes);
+    return finish_upload(req, refresh, "Image loaded", &stats);
+}
+
+#define DLIST_URI "/api/dlist"
+
+// GET /api/dlist - Display list of what the screen shows (display_list.h).
+// The ETag is the list hash, so a client can tell a screen it already has.
+static esp_err_t api_dlist_get_handler(httpd_req_t *req) {
+    uint8_t *list = malloc(DISPLAY_RECORD_BYTES);
+    if (list == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    size_t len;
+    if (display_get_recording(list, DISPLAY_RECORD_BYTES, &len) != ESP_OK) {
+        free(list);
+        const char *resp = "{\"error\":\"The screen was not drawn from a display list\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_status(req, "409 Conflict");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_OK;
+    }
+
+    char etag[12], match[12];
+    snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)display_list_hash(list, len));
+    httpd_resp_set_hdr(req, "ETag", etag);
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", match, sizeof(match)) == ESP_OK &&
+        strcmp(match, etag) == 0) {
+        free(list);
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_send(req, (const char *)list, len);
+    free(list);
+    return ESP_OK;
+}
+
+// POST /api/dlist - Replay a display list, e.g. one stored from GET /api/dlist
+static esp_err_t api_dlist_post_handler(httpd_req_t *req) {
+    if (req->content_len == 0 || req->content_len > DISPLAY_RECORD_BYTES) {
+        char error[48];
+        snprintf(error, sizeof(error), "Body must be 1 to %d bytes", DISPLAY_RECORD_BYTES);
+        return send_bad_request(req, error);
+    }
+    uint8_t *list = malloc(req->content_len);
+    if (list == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    size_t received = 0;
+    int retries = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, (char *)list + received, req->content_len - received);
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++retries <= BITMAP_RECV_RETRIES) {
+            continue;
+        }
+        if (ret <= 0) {
+            free(list);
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+
+    uint32_t hash = display_list_hash(list, received);
+    esp_err_t err = display_submit_list(list, received);
+    free(list);
+    if (err == ESP_ERR_INVALID_ARG) {
+        return send_bad_request(req, "Invalid display list");
+    }
+    char message[40];
+    snprintf(message, sizeof(message), "Display list %08lx queued", (unsigned long)hash);
+    return send_job_response(req, err, message);
+}
+
+// POST /api/orientation - Set global screen orientation
+static esp_err_t api_orientation_handler(httpd_req_t *req) {
+    char content[128];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+
+    if (ret <= 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    content[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        const char *resp = "{\"error\":\"Invalid JSON\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_FAIL;
+    }
+
+    // Extract orientation parameter
+    cJSON *orientation_item = cJSON_GetObjectItem(json, "orientation");
+    if (!orientation_item || !cJSON_IsNumber(orientation_item)) {
+        const char *resp = "{\"error\":\"Missing or invalid orientation parameter\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        cJSON_Delete(json);
+        return ESP_FAIL;
+    }
+
+    uint8_t orientation = orientation_item->valueint;
+    if (orientation > ORIENTATION_270) {
+        const char *resp = "{\"error\":\"Invalid orientation value (must be 0-3)\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        cJSON_Delete(json);
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Setting global orientation to %d° (%d)", orientation * 90, orientation);
+
+    // Orientation is framebuffer state, owned by the display task; nothing to refresh
+    display_job_t *job = display_job_create(0, 0);
+    if (job == NULL) {
+        cJSON_Delete(json);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    display_job_set_orientation(job, orientation);
+    display_job_set_refresh(job, false);
+    if (display_submit(job) != ESP_OK) {
+        cJSON_Delete(json);
+        return send_job_response(req, ESP_ERR_TIMEOUT, NULL);
+    }
+
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"success\":true,\"orientation\":%d,\"degrees\":%d}", orientation, orientation * 90);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+
+    cJSON_Delete(json);
+    return ESP_OK;
+}
+
+static void add_transfer_stats(cJSON *parent, const char *name, const epaper_transfer_stats_t *st) {
+    cJSON *obj = cJSON_AddObjectToObject(parent, name);
+    cJSON_AddNumberToObject(obj, "bytes", st->bytes);
+    cJSON_AddNumberToObject(obj, "transactions", st->transactions);
+    cJSON_AddNumberToObject(obj, "us", st->duration_us);
+}
+
+static void add_busy_stats(cJSON *parent, const char *name, uint8_t cmd) {
+    epaper_busy_stats_t st;
+    epaper_get_busy_stats(cmd, &st);
+
+    cJSON *obj = cJSON_AddObjectToObject(parent, name);
+    cJSON_AddNumberToObject(obj, "count", st.count);
+    cJSON_AddNumberToObject(obj, "timeouts", st.timeouts);
+    cJSON_AddNumberToObject(obj, "missed", st.missed);
+    cJSON_AddNumberToObject(obj, "last_ms", st.last_us / 1000);
+    cJSON_AddNumberToObject(obj, "max_ms", st.max_us / 1000);
+    cJSON_AddNumberToObject(obj, "avg_ms", st.count ? (double)(st.total_us / st.count) / 1000 : 0);
+    cJSON *hist = cJSON_AddArrayToObject(obj, "hist_log2_ms");
+    for (int i = 0; i < EPAPER_BUSY_HIST_BUCKETS; i++) {
+        cJSON_AddItemToArray(hist, cJSON_CreateNumber(st.buckets[i]));
+    }
+}
+
+// GET /api/stats - Transfer, refresh and BUSY timing statistics
+static esp_err_t api_stats_handler(httpd_req_t *req) {
+    epaper_transfer_stats_t frame, fill;
+    epaper_get_frame_stats(&frame);
+    epaper_get_fill_stats(&fill);
+
+    cJSON *json = cJSON_CreateObject();
+    add_transfer_stats(json, "frame", &frame);
+    add_transfer_stats(json, "fill", &fill);
+    epaper_refresh_stats_t refresh;
+    epaper_get_refresh_stats(&refresh);
+    cJSON *refresh_obj = cJSON_AddObjectToObject(json, "refresh");
+    cJSON_AddNumberToObject(refresh_obj, "full", refresh.full);
+    cJSON_AddNumberToObject(refresh_obj, "partial", refresh.partial);
+    cJSON_AddNumberToObject(refresh_obj, "skipped", refresh.skipped);
+    cJSON_AddNumberToObject(refresh_obj, "shrunk", refresh.shrunk);
+
+    display_stats_t ds;
+    display_get_stats(&ds);
+    cJSON *sched = cJSON_AddObjectToObject(json, "scheduler");
+    cJSON_AddNumberToObject(sched, "debounce_ms", ds.debounce_ms);
+    cJSON_AddNumberToObject(sched, "max_latency_ms", ds.max_latency_ms);
+    cJSON_AddNumberToObject(sched, "jobs", ds.jobs);
+    cJSON_AddNumberToObject(sched, "rejected", ds.rejected);
+    cJSON_AddNumberToObject(sched, "superseded", ds.superseded);
+    cJSON_AddNumberToObject(sched, "batches", ds.batches);
+    cJSON_AddNumberToObject(sched, "refreshes_avoided", ds.refreshes_avoided);
+    cJSON *latency = cJSON_AddObjectToObject(sched, "latency_ms");
+    cJSON_AddNumberToObject(latency, "samples", ds.latency_samples);
+    cJSON_AddNumberToObject(latency, "p50", ds.latency_p50_ms);
+    cJSON_AddNumberToObject(latency, "p90", ds.latency_p90_ms);
+    cJSON_AddNumberToObject(latency, "p99", ds.latency_p99_ms);
+    cJSON_AddNumberToObject(latency, "max", ds.latency_max_ms);
+
+    cJSON *busy = cJSON_AddObjectToObject(json, "busy");
+    add_busy_stats(busy, "power_on", 0x04);
+    add_busy_stats(busy, "power_off", 0x02);
+    add_busy_stats(busy, "refresh", 0x12);
+    add_busy_stats(busy, "other", 0x00);
+
+    char *resp = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (resp == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    cJSON_free(resp);
+    return ESP_OK;
+}
+
+// GET /api/fonts - Fonts usable in text requests
+static esp_err_t api_fonts_handler(httpd_req_t *req) {
+    cJSON *json = cJSON_CreateArray();
+    const font_t *font;
+    for (uint8_t id = 0; (font = font_get(id)) != NULL; id++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "id", id);
+        cJSON_AddStringToObject(item, "name", font->name);
+        cJSON_AddBoolToObject(item, "pack", font->layout == FONT_LAYOUT_PACK);
+        cJSON_AddItemToArray(json, item);
+    }
+
+    char *resp = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (resp == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    cJSON_free(resp);
+    return ESP_OK;
+}
+
+// POST /api/measure - Lay out text without drawing it
+static esp_err_t api_measure_handler(httpd_req_t *req) {
+    char content[512];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    cJSON *text_item = json ? cJSON_GetObjectItem(json, "text") : NULL;
+    if (!text_item || !cJSON_IsString(text_item)) {
+        const char *resp = "{\"error\":\"text is required\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        cJSON_Delete(json);
+        return ESP_FAIL;
+    }
+    const char *text = text_item->valuestring;
+    const font_t *font = font_get(parse_font(cJSON_GetObjectItem(json, "font"), FONT_ID_5X8));
+    if (font == NULL) {
+        font = &font_8x16; // Same fallback as drawing
+    }
+    text_box_t box;
+    if (!parse_text_box(json, 0, 0, &box)) {
+        cJSON *scale_item = cJSON_GetObjectItem(json, "scale");
+        memset(&box, 0, sizeof(box));
+        box.scale = scale_item && cJSON_IsNumber(scale_item) ? scale_item->valueint : 1;
+        box.line_gap = TEXT_LAYOUT_LINE_GAP;
+    }
+
+    // Fonts and the measurement cache belong to the display task while it draws
+    text_layout_t layout;
+    display_lock();
+    bool ok = text_layout(text, font, &box, &layout);
+    display_unlock();
+
+    cJSON *resp_json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(resp_json, "success", ok);
+    cJSON_AddNumberToObject(resp_json, "width", layout.width);
+    cJSON_AddNumberToObject(resp_json, "height", layout.height);
+    cJSON_AddNumberToObject(resp_json, "scale", layout.scale);
+    cJSON_AddBoolToObject(resp_json, "fits", layout.fits);
+    cJSON *lines = cJSON_AddArrayToObject(resp_json, "lines");
+    for (uint8_t i = 0; i < layout.line_count; i++) {
+        const text_line_t *line = &layout.lines[i];
+        char buf[128];
+        size_t len = line->len < sizeof(buf) - 1 ? line->len : sizeof(buf) - 1;
+        memcpy(buf, text + line->start, len);
+        buf[len] = '\0';
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "text", buf);
+        cJSON_AddNumberToObject(item, "x", line->x);
+        cJSON_AddNumberToObject(item, "y", line->y);
+        cJSON_AddNumberToObject(item, "width", line->width);
+        cJSON_AddItemToArray(lines, item);
+    }
+    cJSON_Delete(json);
+
+    char *resp = cJSON_PrintUnformatted(resp_json);
+    cJSON_Delete(resp_json);
+    if (resp == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    cJSON_free(resp);
+    return ESP_OK;
+}
+
+// POST /api/scheduler - Tune refresh coalescing
+static esp_err_t api_scheduler_handler(httpd_req_t *req) {
+    char content[128];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+
+    if (ret <= 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    content[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(content);
+    if (json == NULL) {
+        const char *resp = "{\"error\":\"Invalid JSON\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_FAIL;
+    }
+
+    // Missing fields keep their current value
+    display_stats_t ds;
+    display_get_stats(&ds);
+    cJSON *debounce_item = cJSON_GetObjectItem(json, "debounce_ms");
+    cJSON *latency_item = cJSON_GetObjectItem(json, "max_latency_ms");
+    int debounce = (debounce_item && cJSON_IsNumber(debounce_item)) ? debounce_item->valueint : (int)ds.debounce_ms;
+    int max_latency = (latency_item && cJSON_IsNumber(latency_item)) ? latency_item->valueint : (int)ds.max_latency_ms;
+    cJSON_Delete(json);
+
+    if (debounce < 0 || max_latency < 0) {
+        const char *resp = "{\"error\":\"Values must not be negative\"}";
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, resp, strlen(resp));
+        return ESP_FAIL;
+    }
+
+    display_set_schedule(debounce, max_latency);
+
+    char resp[128];
+    snprintf(resp, sizeof(resp), "{\"success\":true,\"debounce_ms\":%d,\"max_latency_ms\":%d}",
+             debounce, max_latency);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+static const char *const widget_type_names[] = { "label", "value", "icon", "bar", "box" };
+
+#define WIDGETS_URI "/api/widgets"
+
+// New content of a widget: the text of a label, value or icon, the level of a bar
+static void set_widget_value(widget_t *w, const char *value) {
+    if (w->type == WIDGET_BAR) {
+        w->value = atoi(value);
+    } else {
+        snprintf(w->text, sizeof(w->text), "%s", value);
+    }
+}
+
+// Apply the fields present in a widget description, the others keep their value.
+// A numeric "value" is printed with "decimals" digits, or as short as it gets.
+static void parse_widget(const cJSON *item, widget_t *w) {
+    w->x = json_int(item, "x", w->x);
+    w->y = json_int(item, "y", w->y);
+    w->w = json_int(item, "w", w->w);
+    w->h = json_int(item, "h", w->h);
+    w->color = json_int(item, "color", w->color);
+    cJSON *background_item = cJSON_GetObjectItem(item, "background");
+    if (background_item && cJSON_IsString(background_item) && strcmp(background_item->valuestring, "none") == 0) {
+        w->background = WIDGET_TRANSPARENT;
+    } else {
+        w->background = json_int(item, "background", w->background);
+    }
+    w->font = parse_font(cJSON_GetObjectItem(item, "font"), w->font);
+    w->scale = json_int(item, "scale", w->scale);
+    w->align = parse_choice(cJSON_GetObjectItem(item, "align"), align_names, 3, w->align);
+    w->valign = parse_choice(cJSON_GetObjectItem(item, "valign"), valign_names, 3, w->valign);
+    w->thickness = json_int(item, "thickness", w->thickness);
+    w->radius = json_int(item, "radius", w->radius);
+    w->min = json_int(item, "min", w->min);
+    w->max = json_int(item, "max", w->max);
+
+    cJSON *text_item = cJSON_GetObjectItem(item, "text");
+    if (text_item && cJSON_IsString(text_item)) {
+        snprintf(w->text, sizeof(w->text), "%s", text_item->valuestring);
+    }
+    cJSON *unit_item = cJSON_GetObjectItem(item, "unit");
+    if (unit_item && cJSON_IsString(unit_item)) {
+        snprintf(w->unit, sizeof(w->unit), "%s", unit_item->valuestring);
+    }
+    cJSON *value_item = cJSON_GetObjectItem(item, "value");
+    if (value_item && cJSON_IsString(value_item)) {
+        set_widget_value(w, value_item->valuestring);
+    } else if (value_item && cJSON_IsNumber(value_item)) {
+        if (w->type == WIDGET_BAR) {
+            w->value = value_item->valueint;
+        } else if (cJSON_GetObjectItem(item, "decimals")) {
+            snprintf(w->text, sizeof(w->text), "%.*f", json_int(item, "decimals", 0), value_item->valuedouble);
+        } else {
+            snprintf(w->text, sizeof(w->text), "%g", value_item->valuedouble);
+        }
+    }
+}
+
+// Id in a /api/widgets/<id> URI, empty when there is none or it is too long
+static void widget_uri_id(const httpd_req_t *req, char *id) {
+    const char *start = req->uri + strlen(WIDGETS_URI);
+    id[0] = '\0';
+    if (*start != '/') {
+        return;
+    }
+    start++;
+    size_t len = strcspn(start, "?");
+    if (len < WIDGET_ID_LEN) {
+        memcpy(id, start, len);
+        id[len] = '\0';
+    }
+}
+
+// Queue drawing the widgets that changed, optionally on a cleared screen
+static esp_err_t submit_widgets(bool clear) {
+    display_job_t *job = display_job_create(1, 0);
+    if (job == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    display_job_set_clear(job, clear);
+    display_job_add_widgets(job);
+    return display_submit(job);
+}
+
+static esp_err_t send_not_found(httpd_req_t *req) {
+    const char *resp = "{\"error\":\"No such widget\"}";
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, "404 Not Found");
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+// GET /api/widgets - List the widgets in drawing order
+static esp_err_t api_widgets_get_handler(httpd_req_t *req) {
+    cJSON *json = cJSON_CreateArray();
+    display_lock();
+    const widget_t *w;
+    for (uint8_t i = 0; (w = widgets_at(i)) != NULL; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "id", w->id);
+        cJSON_AddStringToObject(item, "type", widget_type_names[w->type]);
+        cJSON_AddNumberToObject(item, "x", w->x);
+        cJSON_AddNumberToObject(item, "y", w->y);
+        cJSON_AddNumberToObject(item, "w", w->w);
+        cJSON_AddNumberToObject(item, "h", w->h);
+        if (w->type == WIDGET_BAR) {
+            cJSON_AddNumberToObject(item, "value", w->value);
+            cJSON_AddNumberToObject(item, "min", w->min);
+            cJSON_AddNumberToObject(item, "max", w->max);
+        } else if (w->type != WIDGET_BOX) {
+            cJSON_AddStringToObject(item, "text", w->text);
+        }
+        cJSON_AddItemToArray(json, item);
+    }
+    display_unlock();
+
+    char *resp = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (resp == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    cJSON_free(resp);
+    return ESP_OK;
+}
+
+// POST /api/widgets - Add or replace widgets, "clear" starts from an empty screen
+static esp_err_t api_widgets_post_handler(httpd_req_t *req) {
+    char *content = malloc(2048);
+    if (content == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    int ret = httpd_req_recv(req, content, 2047);
+    if (ret <= 0) {
+        free(content);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    content[ret] = '\0';
+    cJSON *json = cJSON_Parse(content);
+    free(content);
+    if (json == NULL) {
+        return send_bad_request(req, "Invalid JSON");
+    }
+    cJSON *list = cJSON_GetObjectItem(json, "widgets");
+    cJSON *clear_item = cJSON_GetObjectItem(json, "clear");
+    bool clear = clear_item && cJSON_IsTrue(clear_item);
+    if (!cJSON_IsArray(list)) {
+        cJSON_Delete(json);
+        return send_bad_request(req, "widgets must be an array");
+    }
+
+    // Check everything first, so a bad entry changes nothing
+    display_lock();
+    cJSON *item;
+    cJSON_ArrayForEach(item, list) {
+        cJSON *id_item = cJSON_GetObjectItem(item, "id");
+        cJSON *type_item = cJSON_GetObjectItem(item, "type");
+        widget_t w;
+        if (!id_item || !cJSON_IsString(id_item) || !widget_id_valid(id_item->valuestring)) {
+            display_unlock();
+            cJSON_Delete(json);
+            return send_bad_request(req, "Invalid widget id");
+        }
+        bool known = !clear && widgets_get(id_item->valuestring, &w) == ESP_OK;
+        if (type_item ? !cJSON_IsString(type_item) ||
+                        name_index(type_item->valuestring, widget_type_names, 5) < 0 : !known) {
+            display_unlock();
+            cJSON_Delete(json);
+            return send_bad_request(req, "Unknown widget type");
+        }
+    }
+
+    if (clear) {
+        widgets_remove_all();
+    }
+    esp_err_t err = ESP_OK;
+    cJSON_ArrayForEach(item, list) {
+        const char *id = cJSON_GetObjectItem(item, "id")->valuestring;
+        cJSON *type_item = cJSON_GetObjectItem(item, "type");
+        widget_t w;
+        if (widgets_get(id, &w) != ESP_OK ||
+            (type_item && name_index(type_item->valuestring, widget_type_names, 5) != w.type)) {
+            widget_init(&w, type_item ? name_index(type_item->valuestring, widget_type_names, 5) : 0, id);
+        }
+        parse_widget(item, &w);
+        if ((err = widgets_set(&w)) != ESP_OK) {
+            break;
+        }
+    }
+    display_unlock();
+    cJSON_Delete(json);
+
+    if (err != ESP_OK) {
+        submit_widgets(clear);  // Show the ones that fit
+        return send_bad_request(req, "Too many widgets");
+    }
+    ESP_LOGI(TAG, "Widgets updated%s", clear ? " on a cleared screen" : "");
+    return send_job_response(req, submit_widgets(clear), "Widgets queued");
+}
+
+// PATCH /api/widgets/<id> - Change some fields of a widget, or just its value:
+// a body that is not a JSON object is taken as the new value
+static esp_err_t api_widgets_patch_handler(httpd_req_t *req) {
+    char id[WIDGET_ID_LEN];
+    widget_uri_id(req, id);
+
+    char content[512];
+    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
+    if (ret <= 0) {
+        return send_bad_request(req, "Missing value");
+    }
+    content[ret] = '\0';
+
+    cJSON *json = NULL;
+    if (content[0] == '{') {
+        json = cJSON_Parse(content);
+        if (json == NULL) {
+            return send_bad_request(req, "Invalid JSON");
+        }
+    }
+
+    display_lock();
+    widget_t before, w;
+    if (widgets_get(id, &before) != ESP_OK) {
+        display_unlock();
+        cJSON_Delete(json);
+        return send_not_found(req);
+    }
+    w = before;
+    if (json != NULL) {
+        parse_widget(json, &w);
+    } else {
+        set_widget_value(&w, content);
+    }
+    bool changed = memcmp(&before, &w, sizeof(w)) != 0;
+    widgets_set(&w);
+    display_unlock();
+    cJSON_Delete(json);
+
+    // An unchanged value costs no drawing and no refresh
+    if (changed && submit_widgets(false) != ESP_OK) {
+        return send_job_response(req, ESP_ERR_TIMEOUT, NULL);
+    }
+    char resp[64];
+    snprintf(resp, sizeof(resp), "{\"success\":true,\"changed\":%s}", changed ? "true" : "false");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, resp, strlen(resp));
+    return ESP_OK;
+}
+
+// DELETE /api/widgets/<id> - Remove a widget, DELETE /api/widgets removes all
+static esp_err_t api_widgets_delete_handler(httpd_req_t *req) {
+    char id[WIDGET_ID_LEN];
+    widget_uri_id(req, id);
+    bool all = strcspn(req->uri + strlen(WIDGETS_URI), "?") == 0;
+
+    display_lock();
+    esp_err_t err = ESP_OK;
+    if (all) {
+        widgets_remove_all();
+    } else {
+        err = widgets_remove(id);
+    }
+    display_unlock();
+
+    if (err != ESP_OK) {
+        return send_not_found(req);
+    }
+    return send_job_response(req, submit_widgets(false), all ? "Widgets removed" : "Widget removed");
+}
+
+// Start web server
+esp_err_t webserver_start(void) {
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.lru_purge_enable = true;
+    config.server_port = 80;
+    config.max_uri_handlers = 24;
+    config.uri_match_fn = httpd_uri_match_wildcard;  // /api/widgets/<id>
+    config.recv_wait_timeout = 1;  // Seconds, bounds how long an upload can stall (UPLOAD_MAX_MS)
+
+    ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
+
+    if (httpd_start(&server, &config) == ESP_OK) {
+        // Register URI handlers
+        httpd_uri_t index_uri = {
+            .uri = "/",
+            .method = HTTP_GET,
+            .handler = index_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &index_uri);
+
+        httpd_uri_t api_text_uri = {
             .uri = "/api/text",
             .method = HTTP_POST,
             .handler = api_text_handler,
@@ -477,6 +1780,54 @@ esp_err_t webserver_start(void) {
         };
         httpd_register_uri_handler(server, &api_rect_uri);
 
+        httpd_uri_t api_shapes_uri = {
+            .uri = "/api/shapes",
+            .method = HTTP_POST,
+            .handler = api_shapes_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_shapes_uri);
+
+        httpd_uri_t api_template_uri = {
+            .uri = "/api/template",
+            .method = HTTP_POST,
+            .handler = api_template_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_template_uri);
+
+        httpd_uri_t api_bitmap_uri = {
+            .uri = "/api/bitmap",
+            .method = HTTP_POST,
+            .handler = api_bitmap_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_bitmap_uri);
+
+        httpd_uri_t api_image_uri = {
+            .uri = "/api/image",
+            .method = HTTP_POST,
+            .handler = api_image_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_image_uri);
+
+        httpd_uri_t api_dlist_get_uri = {
+            .uri = DLIST_URI,
+            .method = HTTP_GET,
+            .handler = api_dlist_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_dlist_get_uri);
+
+        httpd_uri_t api_dlist_post_uri = {
+            .uri = DLIST_URI,
+            .method = HTTP_POST,
+            .handler = api_dlist_post_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_dlist_post_uri);
+
         httpd_uri_t api_orientation_uri = {
             .uri = "/api/orientation",
             .method = HTTP_POST,
@@ -485,6 +1836,70 @@ esp_err_t webserver_start(void) {
         };
         httpd_register_uri_handler(server, &api_orientation_uri);
 
+        httpd_uri_t api_stats_uri = {
+            .uri = "/api/stats",
+            .method = HTTP_GET,
+            .handler = api_stats_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_stats_uri);
+
+        httpd_uri_t api_scheduler_uri = {
+            .uri = "/api/scheduler",
+            .method = HTTP_POST,
+            .handler = api_scheduler_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_scheduler_uri);
+
+        httpd_uri_t api_fonts_uri = {
+            .uri = "/api/fonts",
+            .method = HTTP_GET,
+            .handler = api_fonts_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_fonts_uri);
+
+        httpd_uri_t api_measure_uri = {
+            .uri = "/api/measure",
+            .method = HTTP_POST,
+            .handler = api_measure_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_measure_uri);
+
+        httpd_uri_t api_widgets_get_uri = {
+            .uri = WIDGETS_URI,
+            .method = HTTP_GET,
+            .handler = api_widgets_get_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_widgets_get_uri);
+
+        httpd_uri_t api_widgets_post_uri = {
+            .uri = WIDGETS_URI,
+            .method = HTTP_POST,
+            .handler = api_widgets_post_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_widgets_post_uri);
+
+        httpd_uri_t api_widgets_patch_uri = {
+            .uri = WIDGETS_URI "/*",
+            .method = HTTP_PATCH,
+            .handler = api_widgets_patch_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_widgets_patch_uri);
+
+        httpd_uri_t api_widgets_delete_uri = {
+            .uri = WIDGETS_URI "*",
+            .method = HTTP_DELETE,
+            .handler = api_widgets_delete_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &api_widgets_delete_uri);
+
         ESP_LOGI(TAG, "Web server started successfully");
         return ESP_OK;
     }
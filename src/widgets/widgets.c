@@ -0,0 +1,315 @@
+#include "widgets.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "epaper/epaper.h"
+#include "epaper/font.h"
+#include "epaper/text_layout.h"
+
+static const char *TAG = "widgets";
+
+// Logical rectangle (inclusive)
+typedef struct {
+    int16_t x0, y0, x1, y1;
+} rect_t;
+
+// Render state of a widget, kept next to it in list order
+typedef struct {
+    bool invalid;  // Changed since it was last drawn
+    bool drawn;    // extent is on screen
+    rect_t extent; // Pixels the last drawing covered: the bounds, plus text running over them
+} widget_state_t;
+
+static widget_t widgets[WIDGET_MAX];
+static widget_state_t states[WIDGET_MAX];
+static uint8_t widget_count = 0;
+
+// Left behind by removed widgets, painted over at the next render
+#define ERASE_MAX 4
+static rect_t erased[ERASE_MAX];
+static uint8_t erased_count = 0;
+
+static rect_t rect_of(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    rect_t r = { x, y, x + (w > 0 ? w : 1) - 1, y + (h > 0 ? h : 1) - 1 };
+    return r;
+}
+
+static void rect_union(rect_t *r, const rect_t *other) {
+    if (other->x0 < r->x0) r->x0 = other->x0;
+    if (other->y0 < r->y0) r->y0 = other->y0;
+    if (other->x1 > r->x1) r->x1 = other->x1;
+    if (other->y1 > r->y1) r->y1 = other->y1;
+}
+
+static bool rect_overlaps(const rect_t *a, const rect_t *b) {
+    return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+// Everything a widget may cover: its bounds and what it last drew
+static rect_t widget_area(uint8_t i) {
+    const widget_t *w = &widgets[i];
+    rect_t r = rect_of(w->x, w->y, w->w, w->h);
+    if (states[i].drawn) {
+        rect_union(&r, &states[i].extent);
+    }
+    return r;
+}
+
+void widget_init(widget_t *w, uint8_t type, const char *id) {
+    memset(w, 0, sizeof(*w));
+    snprintf(w->id, sizeof(w->id), "%s", id);
+    w->type = type;
+    w->color = COLOR_BLACK;
+    w->background = type == WIDGET_BOX ? WIDGET_TRANSPARENT : COLOR_WHITE;
+    w->font = FONT_ID_6X12;
+    w->scale = 1;
+    w->thickness = 1;
+    w->max = 100;
+    if (type == WIDGET_ICON) {
+        w->align = TEXT_ALIGN_CENTER;
+        w->valign = TEXT_VALIGN_MIDDLE;
+    }
+}
+
+bool widget_id_valid(const char *id) {
+    size_t len = strlen(id);
+    if (len == 0 || len >= WIDGET_ID_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = id[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '-' || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int find(const char *id) {
+    for (uint8_t i = 0; i < widget_count; i++) {
+        if (strcmp(widgets[i].id, id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t widgets_set(const widget_t *w) {
+    if (!widget_id_valid(w->id) || w->type > WIDGET_BOX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int i = find(w->id);
+    if (i >= 0) {
+        // Old and new area are both repainted, so a widget may move or shrink
+        if (memcmp(&widgets[i], w, sizeof(*w)) != 0) {
+            widgets[i] = *w;
+            states[i].invalid = true;
+        }
+        return ESP_OK;
+    }
+    if (widget_count >= WIDGET_MAX) {
+        ESP_LOGW(TAG, "No room for widget '%s'", w->id);
+        return ESP_ERR_NO_MEM;
+    }
+    widgets[widget_count] = *w;
+    states[widget_count] = (widget_state_t){ .invalid = true };
+    widget_count++;
+    return ESP_OK;
+}
+
+esp_err_t widgets_get(const char *id, widget_t *w) {
+    int i = find(id);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *w = widgets[i];
+    return ESP_OK;
+}
+
+// Remember the area of widget i for the next render
+static void erase_area(uint8_t i) {
+    rect_t r = widget_area(i);
+    if (!states[i].drawn) {
+        return;
+    }
+    if (erased_count < ERASE_MAX) {
+        erased[erased_count++] = r;
+    } else {
+        rect_union(&erased[ERASE_MAX - 1], &r);
+    }
+}
+
+esp_err_t widgets_remove(const char *id) {
+    int i = find(id);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    erase_area(i);
+    widget_count--;
+    memmove(&widgets[i], &widgets[i + 1], (widget_count - i) * sizeof(widgets[0]));
+    memmove(&states[i], &states[i + 1], (widget_count - i) * sizeof(states[0]));
+    return ESP_OK;
+}
+
+void widgets_remove_all(void) {
+    for (uint8_t i = 0; i < widget_count; i++) {
+        erase_area(i);
+    }
+    widget_count = 0;
+}
+
+const widget_t *widgets_at(uint8_t index) {
+    return index < widget_count ? &widgets[index] : NULL;
+}
+
+void widgets_invalidate_all(void) {
+    for (uint8_t i = 0; i < widget_count; i++) {
+        states[i].invalid = true;
+    }
+}
+
+bool widgets_pending(void) {
+    if (erased_count > 0) {
+        return true;
+    }
+    for (uint8_t i = 0; i < widget_count; i++) {
+        if (states[i].invalid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Text of a label, value or icon, laid out in its bounds
+typedef struct {
+    const font_t *font;
+    char text[WIDGET_TEXT_LEN + 8];
+    text_layout_t layout;
+} widget_text_t;
+
+// Lay out the text of w and grow extent by the lines, false when there is nothing to draw
+static bool layout_text(const widget_t *w, widget_text_t *t, rect_t *extent) {
+    t->font = font_get(w->font);
+    if (t->font == NULL) {
+        t->font = &font_6x12;
+    }
+    snprintf(t->text, sizeof(t->text), "%s%s", w->text, w->type == WIDGET_VALUE ? w->unit : "");
+
+    text_box_t box = {
+        .x = w->x < 0 ? 0 : w->x, .y = w->y < 0 ? 0 : w->y, .w = w->w, .h = w->h,
+        .align = w->align, .valign = w->valign,
+        .scale = w->scale, .fit = w->scale == 0,
+        .line_gap = TEXT_LAYOUT_LINE_GAP,
+        .wrap = w->type == WIDGET_LABEL,
+    };
+    if (!text_layout(t->text, t->font, &box, &t->layout) || t->layout.line_count == 0) {
+        return false;
+    }
+    for (uint8_t i = 0; i < t->layout.line_count; i++) {
+        const text_line_t *line = &t->layout.lines[i];
+        rect_t r = rect_of(line->x, t->layout.lines[0].y, line->width, t->layout.height);
+        rect_union(extent, &r);
+    }
+    return true;
+}
+
+static void draw_bar(const widget_t *w) {
+    uint8_t t = w->thickness;
+    if (t > 0) {
+        epaper_round_rect(w->x, w->y, w->w, w->h, 0, t, w->color);
+    }
+    int32_t inner_w = (int32_t)w->w - 2 * t, inner_h = (int32_t)w->h - 2 * t;
+    if (inner_w <= 0 || inner_h <= 0 || w->max <= w->min) {
+        return;
+    }
+    int32_t v = w->value < w->min ? w->min : (w->value > w->max ? w->max : w->value);
+    int64_t span = (int64_t)w->max - w->min;
+    if (w->h > w->w) {
+        int32_t fill = (int32_t)((int64_t)inner_h * (v - w->min) / span);
+        if (fill > 0) {
+            epaper_rect(w->x + t, w->y + t + inner_h - fill, inner_w, fill, w->color);
+        }
+    } else {
+        int32_t fill = (int32_t)((int64_t)inner_w * (v - w->min) / span);
+        if (fill > 0) {
+            epaper_rect(w->x + t, w->y + t, fill, inner_h, w->color);
+        }
+    }
+}
+
+static void set_clip(const rect_t *r) {
+    epaper_set_clip(r->x0, r->y0, r->x1 - r->x0 + 1, r->y1 - r->y0 + 1);
+}
+
+// Draw the part of widget i inside area (repaint() has clipped to it)
+static void draw_widget(uint8_t i) {
+    const widget_t *w = &widgets[i];
+    rect_t extent = rect_of(w->x, w->y, w->w, w->h);
+    widget_text_t text;
+    bool has_text = (w->type == WIDGET_LABEL || w->type == WIDGET_VALUE || w->type == WIDGET_ICON) &&
+                    layout_text(w, &text, &extent);
+    states[i].extent = extent;
+    states[i].drawn = true;
+
+    if (w->background != WIDGET_TRANSPARENT && w->w > 0 && w->h > 0) {
+        epaper_round_rect(w->x, w->y, w->w, w->h, w->type == WIDGET_BOX ? w->radius : 0, 0, w->background);
+    }
+    if (has_text) {
+        text_layout_draw(text.text, text.font, &text.layout, w->color);
+    } else if (w->type == WIDGET_BAR) {
+        draw_bar(w);
+    } else if (w->type == WIDGET_BOX) {
+        epaper_round_rect(w->x, w->y, w->w, w->h, w->radius, w->thickness, w->color);
+    }
+}
+
+// Paint one damaged area white and draw every widget reaching into it, in
+// list order, so the widgets around it stay untouched
+static void repaint(const rect_t *area) {
+    set_clip(area);
+    epaper_rect(area->x0 < 0 ? 0 : area->x0, area->y0 < 0 ? 0 : area->y0,
+                area->x1 - (area->x0 < 0 ? 0 : area->x0) + 1, area->y1 - (area->y0 < 0 ? 0 : area->y0) + 1,
+                COLOR_WHITE);
+    for (uint8_t i = 0; i < widget_count; i++) {
+        rect_t r = widget_area(i);
+        if (rect_overlaps(&r, area)) {
+            draw_widget(i);
+        }
+    }
+    epaper_reset_clip();
+}
+
+uint8_t widgets_render(void) {
+    // Damaged areas: invalid widgets (old and new place) and removed ones.
+    // Overlapping areas are merged so nothing is drawn twice.
+    rect_t areas[WIDGET_MAX + ERASE_MAX];
+    uint8_t count = 0, drawn = 0;
+    for (uint8_t i = 0; i < erased_count; i++) {
+        areas[count++] = erased[i];
+    }
+    for (uint8_t i = 0; i < widget_count; i++) {
+        if (states[i].invalid) {
+            areas[count++] = widget_area(i);
+            states[i].invalid = false;
+            drawn++;
+        }
+    }
+    erased_count = 0;
+    for (uint8_t a = 0; a < count; a++) {
+        for (uint8_t b = a + 1; b < count; b++) {
+            if (rect_overlaps(&areas[a], &areas[b])) {
+                rect_union(&areas[a], &areas[b]);
+                areas[b--] = areas[--count];
+                b = a;  // The grown area may reach ones already passed
+            }
+        }
+    }
+    for (uint8_t a = 0; a < count; a++) {
+        repaint(&areas[a]);
+    }
+    if (count > 0) {
+        ESP_LOGI(TAG, "Redrew %d widgets in %d areas", drawn, count);
+    }
+    return drawn;
+}
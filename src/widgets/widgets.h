@@ -0,0 +1,79 @@
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Retained widgets: the device keeps what is on screen as a list of widgets,
+// each with a stable id, bounds and style. Changing one only marks it invalid;
+// widgets_render() then redraws the invalid widgets (and whatever overlaps
+// them), so the update transfers just their bounds. Positions are logical
+// pixels in the current orientation, list order is drawing order.
+// Not thread safe: callers hold display_lock().
+
+#define WIDGET_MAX      32
+#define WIDGET_ID_LEN   16  // Including the terminator
+#define WIDGET_TEXT_LEN 32  // Including the terminator
+
+typedef enum {
+    WIDGET_LABEL,  // Static text
+    WIDGET_VALUE,  // Text followed by unit, usually the one that changes
+    WIDGET_ICON,   // Glyphs of an icon font, centered
+    WIDGET_BAR,    // Outline filled from min to value (bottom up when taller than wide)
+    WIDGET_BOX,    // Rectangle, rounded with radius, filled when thickness is 0
+} widget_type_t;
+
+typedef struct {
+    char id[WIDGET_ID_LEN];  // Letters, digits, '-' and '_'
+    uint8_t type;            // widget_type_t
+    int16_t x, y;
+    uint16_t w, h;
+
+    // Style
+    uint8_t color;           // Text, bar fill and box
+    uint8_t background;      // Fill of the bounds before drawing, WIDGET_TRANSPARENT = none
+    uint8_t font;            // FONT_ID_* or a font pack id
+    uint8_t scale;           // 0 = largest that fits the bounds
+    uint8_t align;           // text_align_t
+    uint8_t valign;          // text_valign_t
+    uint8_t thickness;       // Box and bar outline
+    uint8_t radius;          // Box corners
+
+    // Content
+    char text[WIDGET_TEXT_LEN];  // Labels, values and icons
+    char unit[8];                // Values only, drawn after the text
+    int32_t value, min, max;     // Bars only
+} widget_t;
+
+#define WIDGET_TRANSPARENT 0xFF
+
+// Defaults of a new widget of type (white background, black, 6x12, left/top)
+void widget_init(widget_t *w, uint8_t type, const char *id);
+
+bool widget_id_valid(const char *id);
+
+// Add a widget, or replace the one with the same id (keeps its place in the
+// order). Only marks it invalid when it changed. ESP_ERR_NO_MEM when full.
+esp_err_t widgets_set(const widget_t *w);
+
+// Copy of a widget, ESP_ERR_NOT_FOUND when there is none with that id
+esp_err_t widgets_get(const char *id, widget_t *w);
+
+esp_err_t widgets_remove(const char *id);
+void widgets_remove_all(void);
+
+// The widget at index (list order) or NULL past the end
+const widget_t *widgets_at(uint8_t index);
+
+// Redraw every widget the next time widgets_render() runs (e.g. after the
+// screen was cleared)
+void widgets_invalidate_all(void);
+
+// True when widgets_render() has something to draw
+bool widgets_pending(void);
+
+// Draw invalid widgets into the framebuffer, returns how many were drawn
+uint8_t widgets_render(void);
+
+#endif // WIDGETS_H